@@ -0,0 +1,524 @@
+// Micro-benchmarks for the core list operations
+//
+// A small harness in the style of Google Benchmark: every case runs its
+// timed loop until a minimum time has passed, setup work is excluded with
+// pauseTiming()/resumeTiming(), and results carry items/second and
+// bytes/second counters. Output is a console table, JSON or CSV, so runs
+// from different commits can be compared directly.
+//
+// Build: g++ -std=c++11 -O2 -pthread -o tdms_benchmark benchmark.cpp
+// Usage: ./tdms_benchmark [--filter TEXT] [--max-size N] [--min-time S]
+//                         [--repetitions N] [--format console|json|csv] [--out FILE]
+
+#define TDMS_NO_MAIN
+#include "project3.cpp"
+
+#include <ctime>
+
+typedef chrono::steady_clock BenchmarkClock;
+
+class BenchmarkState {
+private:
+    double minTime;
+    uint64_t iterations;
+    bool started;
+    bool paused;
+    BenchmarkClock::time_point start, pauseStart;
+    clock_t cpuStart, cpuPauseStart;
+    double pausedSeconds, pausedCpuSeconds;
+    double realSeconds, cpuSeconds;
+
+public:
+    const size_t range;
+    uint64_t itemsProcessed;
+    uint64_t bytesProcessed;
+
+    BenchmarkState(size_t n, double minSeconds)
+        : minTime(minSeconds), iterations(0), started(false), paused(false),
+          cpuStart(0), cpuPauseStart(0), pausedSeconds(0), pausedCpuSeconds(0),
+          realSeconds(0), cpuSeconds(0), range(n), itemsProcessed(0), bytesProcessed(0) {}
+
+    // Loop condition for the timed body: while (state.keepRunning()) { ... }
+    bool keepRunning() {
+        BenchmarkClock::time_point now = BenchmarkClock::now();
+        if (!started) {
+            started = true;
+            start = now;
+            cpuStart = clock();
+            return true;
+        }
+        iterations++;
+        double elapsed = chrono::duration<double>(now - start).count() - pausedSeconds;
+        if (elapsed >= minTime || iterations >= 1000000000ULL) {
+            realSeconds = elapsed;
+            cpuSeconds = (double)(clock() - cpuStart) / CLOCKS_PER_SEC - pausedCpuSeconds;
+            return false;
+        }
+        return true;
+    }
+
+    void pauseTiming() {
+        paused = true;
+        pauseStart = BenchmarkClock::now();
+        cpuPauseStart = clock();
+    }
+
+    void resumeTiming() {
+        if (paused) {
+            pausedSeconds += chrono::duration<double>(BenchmarkClock::now() - pauseStart).count();
+            pausedCpuSeconds += (double)(clock() - cpuPauseStart) / CLOCKS_PER_SEC;
+            paused = false;
+        }
+    }
+
+    uint64_t getIterations() const { return iterations; }
+    double getRealSeconds() const { return realSeconds; }
+    double getCpuSeconds() const { return max(cpuSeconds, 0.0); }
+};
+
+struct BenchmarkCase {
+    string name;
+    function<void(BenchmarkState&)> body;
+};
+
+struct BenchmarkRun {
+    string name;
+    uint64_t iterations;
+    double realNs;          // per iteration
+    double cpuNs;
+    double itemsPerSecond;
+    double bytesPerSecond;
+    string aggregate;       // empty for a single repetition, else "median"
+};
+
+// Deterministic records with realistic field values, so string compares
+// in sort and search behave as they do on real data.
+template <typename Record>
+vector<Record*> makeRecords(size_t n, uint64_t seed = 42) {
+    static const char* locations[8] = {"Tokyo", "Toronto", "London", "Sydney", "Berlin", "Dubai", "New York", "Singapore"};
+    static const char* types[4] = {"withdrawal", "deposit", "transfer", "payment"};
+    static const char* merchants[8] = {"utilities", "online", "retail", "grocery", "travel", "restaurant",
+                                       "entertainment", "other"};
+    static const char* devices[4] = {"mobile", "atm", "pos", "web"};
+    uint64_t state = seed;
+    auto next = [&state]() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+
+    vector<Record*> records(n);
+    for (size_t i = 0; i < n; ++i) {
+        Record* t = new Record();
+        uint64_t r = next();
+        bool fraud = r % 100 < 4;
+        t->transaction_id = "T" + to_string(i);
+        t->timestamp = "2023-" + to_string(10 + r % 3) + "-1" + to_string(r % 10) + " 12:00:00";
+        t->sender_account = "ACC" + to_string(100000 + (r >> 8) % 900000);
+        t->receiver_account = "ACC" + to_string(100000 + (r >> 28) % 900000);
+        t->amount = (double)((r >> 40) % 500000) / 100.0;
+        t->transaction_type = types[(r >> 3) % 4];
+        t->merchant_category = merchants[(r >> 5) % 8];
+        t->location = locations[(r >> 11) % 8];
+        t->device_used = devices[(r >> 14) % 4];
+        t->is_fraud = fraud ? "True" : "False";
+        t->fraud_type = fraud ? "card_not_present" : "";
+        t->time_since_last_transaction = (double)((r >> 17) % 100000) / 10.0;
+        t->spending_deviation_score = (double)((r >> 21) % 300) / 100.0;
+        t->velocity_score = (int)((r >> 24) % 20);
+        t->geo_anomaly_score = (double)((r >> 30) % 100) / 100.0;
+        t->payment_channel = "card";
+        t->ip_address = "192.168." + to_string((r >> 33) % 256) + "." + to_string((r >> 41) % 256);
+        t->device_hash = "D" + to_string(1000000 + (r >> 49) % 9000000);
+        records[i] = t;
+    }
+    return records;
+}
+
+template <typename List>
+void fillList(List& list, size_t n) {
+    vector<typename List::Record*> records = makeRecords<typename List::Record>(n);
+    for (typename List::Record* t : records) {
+        list.addTransaction(t);
+    }
+}
+
+template <typename List>
+void benchmarkAddTransaction(BenchmarkState& state) {
+    typedef typename List::Record Record;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        unique_ptr<List> list(new List());
+        vector<Record*> records = makeRecords<Record>(state.range);
+        state.resumeTiming();
+
+        for (Record* t : records) {
+            list->addTransaction(t);
+        }
+
+        state.pauseTiming();
+        list.reset();
+        epochManager().reclaim();
+        state.resumeTiming();
+    }
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+// sortByLocation is the public entry point to merge()/mergeSort(); each
+// iteration sorts a freshly built, unsorted list.
+template <typename List>
+void benchmarkMergeSort(BenchmarkState& state) {
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        unique_ptr<List> list(new List());
+        fillList(*list, state.range);
+        SilenceOutput quiet;
+        state.resumeTiming();
+
+        list->sortByLocation();
+
+        state.pauseTiming();
+        list.reset();
+        epochManager().reclaim();
+        state.resumeTiming();
+    }
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+template <typename List>
+void benchmarkLinearSearch(BenchmarkState& state) {
+    List list;
+    fillList(list, state.range);
+    int matches = 0;
+    while (state.keepRunning()) {
+        matches += list.countMatches("Sydney", "location");
+    }
+    if (matches < 0) cout << matches;   // keeps the scan from being optimized away
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+template <typename List>
+void benchmarkBinarySearch(BenchmarkState& state) {
+    List list;
+    fillList(list, state.range);
+    SilenceOutput quiet;
+    while (state.keepRunning()) {
+        list.binarySearch("Sydney", "location");
+    }
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+template <typename List>
+void benchmarkTopK(BenchmarkState& state) {
+    List list;
+    fillList(list, state.range);
+    List* lists[4] = {&list, &list, &list, &list};
+    const bool selected[4] = {true, false, false, false};
+    TopKQuery query = {Q_AMOUNT, false, 100, vector<QueryPredicate>()};
+    size_t found = 0;
+    while (state.keepRunning()) {
+        EpochGuard guard;
+        found += topK(lists, selected, query).size();
+    }
+    if (found == 1) cout << found;   // keeps the scan from being optimized away
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+template <typename List>
+void benchmarkExportToJSON(BenchmarkState& state) {
+    const string filename = makeTemporaryFile("tdms_benchmark_export_");
+    List list;
+    fillList(list, state.range);
+    uint64_t bytes = 0;
+    SilenceOutput quiet;
+    while (state.keepRunning()) {
+        list.exportToJSON(filename);
+        state.pauseTiming();
+        bytes += (uint64_t)(fileSizeMB(filename) * 1024.0 * 1024.0 + 0.5);
+        state.resumeTiming();
+    }
+    remove(filename.c_str());
+    state.itemsProcessed = state.getIterations() * state.range;
+    state.bytesProcessed = bytes;
+}
+
+// Live-feed feature computation: each iteration fills velocity_score and
+// time_since_last_transaction for n records into a fresh table.
+void benchmarkAccountFeatures(BenchmarkState& state) {
+    vector<ArrayTransaction*> records = makeRecords<ArrayTransaction>(state.range);
+    while (state.keepRunning()) {
+        AccountFeatures features;
+        for (ArrayTransaction* t : records) {
+            features.fill(*t);
+        }
+    }
+    for (ArrayTransaction* t : records) {
+        delete t;
+    }
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+// The same records as CSV rows, in the column order of the data files
+vector<string> makeCSVLines(const vector<ArrayTransaction*>& records) {
+    vector<string> lines;
+    lines.reserve(records.size());
+    for (const ArrayTransaction* t : records) {
+        ostringstream row;
+        row << t->transaction_id << ',' << t->timestamp << ',' << t->sender_account << ',' << t->receiver_account
+            << ',' << t->amount << ',' << t->transaction_type << ',' << t->merchant_category << ',' << t->location
+            << ',' << t->device_used << ',' << t->is_fraud << ',' << t->fraud_type << ','
+            << t->time_since_last_transaction << ',' << t->spending_deviation_score << ',' << t->velocity_score
+            << ',' << t->geo_anomaly_score << ',' << t->payment_channel << ',' << t->ip_address << ','
+            << t->device_hash;
+        lines.push_back(row.str());
+    }
+    return lines;
+}
+
+// Row parsing as importCSV does it, the baseline for the fraud rule cost
+void benchmarkParseCSV(BenchmarkState& state) {
+    vector<ArrayTransaction*> records = makeRecords<ArrayTransaction>(state.range);
+    vector<string> lines = makeCSVLines(records);
+    for (ArrayTransaction* t : records) {
+        delete t;
+    }
+    ArrayTransaction row;
+    while (state.keepRunning()) {
+        for (const string& line : lines) {
+            parseTransactionCSV(line, row);
+        }
+    }
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+// Evaluating, tagging and counting five fraud rules per row, as an import
+// does after parsing each one
+void benchmarkFraudRules(BenchmarkState& state) {
+    static const char* ruleLines[5] = {
+        "remote_mobile: amount>1000 and geo_anomaly_score>0.8 and device_used=mobile",
+        "high_velocity: velocity_score>=18 and amount>2000",
+        "tokyo_online: location=Tokyo and merchant_category=online and amount>=4000",
+        "night_transfer: transaction_type=transfer and timestamp>=2023-10-10 and timestamp<2023-10-11",
+        "deviation: spending_deviation_score>2.5 and time_since_last_transaction<60"};
+    vector<FraudRule> rules(5);
+    string error;
+    for (int r = 0; r < 5; ++r) {
+        parseFraudRule(ruleLines[r], rules[r], error);
+    }
+    FraudRuleProgram program;
+    program.compile(rules, error);
+
+    vector<ArrayTransaction*> records = makeRecords<ArrayTransaction>(state.range);
+    while (state.keepRunning()) {
+        for (ArrayTransaction* t : records) {
+            program.apply(*t);
+        }
+    }
+    for (ArrayTransaction* t : records) {
+        delete t;
+    }
+    state.itemsProcessed = state.getIterations() * state.range;
+}
+
+template <typename List>
+void registerListCases(const string& listName, const vector<size_t>& sizes, vector<BenchmarkCase>& cases) {
+    for (size_t n : sizes) {
+        string suffix = "<" + listName + ">/" + to_string(n);
+        cases.push_back({"BM_AddTransaction" + suffix, benchmarkAddTransaction<List>});
+        cases.push_back({"BM_MergeSort" + suffix, benchmarkMergeSort<List>});
+        cases.push_back({"BM_LinearSearch" + suffix, benchmarkLinearSearch<List>});
+        cases.push_back({"BM_BinarySearch" + suffix, benchmarkBinarySearch<List>});
+        cases.push_back({"BM_TopK" + suffix, benchmarkTopK<List>});
+        cases.push_back({"BM_ExportToJSON" + suffix, benchmarkExportToJSON<List>});
+    }
+}
+
+size_t caseSize(const string& name) {
+    return (size_t)strtoull(name.substr(name.rfind('/') + 1).c_str(), nullptr, 10);
+}
+
+BenchmarkRun runCase(const BenchmarkCase& benchmarkCase, double minTime) {
+    BenchmarkState state(caseSize(benchmarkCase.name), minTime);
+    benchmarkCase.body(state);
+    BenchmarkRun run;
+    run.name = benchmarkCase.name;
+    run.iterations = max<uint64_t>(state.getIterations(), 1);
+    run.realNs = state.getRealSeconds() * 1e9 / run.iterations;
+    run.cpuNs = state.getCpuSeconds() * 1e9 / run.iterations;
+    double seconds = max(state.getRealSeconds(), 1e-12);
+    run.itemsPerSecond = state.itemsProcessed / seconds;
+    run.bytesPerSecond = state.bytesProcessed / seconds;
+    return run;
+}
+
+BenchmarkRun medianOf(vector<BenchmarkRun> runs) {
+    sort(runs.begin(), runs.end(), [](const BenchmarkRun& a, const BenchmarkRun& b) {
+        return a.realNs < b.realNs;
+    });
+    BenchmarkRun median = runs[runs.size() / 2];
+    median.name += "_median";
+    median.aggregate = "median";
+    return median;
+}
+
+string humanRate(double perSecond) {
+    const char* units[] = {"", "k", "M", "G", "T"};
+    int unit = 0;
+    while (perSecond >= 1000.0 && unit < 4) {
+        perSecond /= 1000.0;
+        unit++;
+    }
+    ostringstream out;
+    out << fixed << setprecision(perSecond < 10 ? 2 : 1) << perSecond << units[unit] << "/s";
+    return out.str();
+}
+
+void printConsole(ostream& out, const vector<BenchmarkRun>& runs) {
+    out << left << setw(44) << "Benchmark" << right << setw(16) << "Time (ns)" << setw(16) << "CPU (ns)"
+        << setw(12) << "Iterations" << setw(14) << "items/s" << setw(14) << "bytes/s" << endl;
+    out << string(116, '-') << endl;
+    for (const BenchmarkRun& r : runs) {
+        out << left << setw(44) << r.name << right << fixed << setprecision(0)
+            << setw(16) << r.realNs << setw(16) << r.cpuNs << setw(12) << r.iterations
+            << setw(14) << humanRate(r.itemsPerSecond)
+            << setw(14) << (r.bytesPerSecond > 0 ? humanRate(r.bytesPerSecond) : string("")) << endl;
+    }
+}
+
+void printJSON(ostream& out, const vector<BenchmarkRun>& runs, double minTime) {
+    nlohmann::json root;
+    time_t now = time(nullptr);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    root["context"] = {
+        {"date", date},
+        {"num_cpus", thread::hardware_concurrency()},
+        {"min_time", minTime},
+#ifdef NDEBUG
+        {"library_build_type", "release"},
+#else
+        {"library_build_type", "debug"},
+#endif
+    };
+    root["benchmarks"] = nlohmann::json::array();
+    for (const BenchmarkRun& r : runs) {
+        nlohmann::json entry = {
+            {"name", r.name},
+            {"run_type", r.aggregate.empty() ? "iteration" : "aggregate"},
+            {"iterations", r.iterations},
+            {"real_time", r.realNs},
+            {"cpu_time", r.cpuNs},
+            {"time_unit", "ns"},
+            {"items_per_second", r.itemsPerSecond},
+        };
+        if (!r.aggregate.empty()) entry["aggregate_name"] = r.aggregate;
+        if (r.bytesPerSecond > 0) entry["bytes_per_second"] = r.bytesPerSecond;
+        root["benchmarks"].push_back(entry);
+    }
+    out << root.dump(2) << endl;
+}
+
+void printCSV(ostream& out, const vector<BenchmarkRun>& runs) {
+    out << "name,iterations,real_time,cpu_time,time_unit,bytes_per_second,items_per_second,aggregate" << endl;
+    out << setprecision(10);
+    for (const BenchmarkRun& r : runs) {
+        out << '"' << r.name << "\"," << r.iterations << ',' << r.realNs << ',' << r.cpuNs << ",ns,"
+            << r.bytesPerSecond << ',' << r.itemsPerSecond << ',' << r.aggregate << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string filter, format = "console", outFile;
+    size_t maxSize = 1000000;
+    double minTime = 0.5;
+    int repetitions = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--filter") {
+            filter = value;
+        } else if (arg == "--max-size") {
+            maxSize = (size_t)strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--min-time") {
+            minTime = atof(value.c_str());
+        } else if (arg == "--repetitions") {
+            repetitions = max(1, atoi(value.c_str()));
+        } else if (arg == "--format") {
+            format = value;
+        } else if (arg == "--out") {
+            outFile = value;
+        } else {
+            cout << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+    if (format != "console" && format != "json" && format != "csv") {
+        cout << "Unknown format: " << format << " (use console, json or csv)" << endl;
+        return 1;
+    }
+
+    vector<size_t> sizes;
+    for (size_t n = 1000; n <= maxSize && n <= 10000000; n *= 10) {
+        sizes.push_back(n);
+    }
+    vector<BenchmarkCase> cases;
+    registerListCases<TransactionList>("LinkedList", sizes, cases);
+    registerListCases<ArrayTransactionList>("Array", sizes, cases);
+    for (size_t n : sizes) {
+        cases.push_back({"BM_AccountFeatures/" + to_string(n), benchmarkAccountFeatures});
+        cases.push_back({"BM_ParseCSV/" + to_string(n), benchmarkParseCSV});
+        cases.push_back({"BM_FraudRules/" + to_string(n), benchmarkFraudRules});
+    }
+
+    vector<BenchmarkRun> runs;
+    for (const BenchmarkCase& benchmarkCase : cases) {
+        if (!filter.empty() && benchmarkCase.name.find(filter) == string::npos) {
+            continue;
+        }
+        vector<BenchmarkRun> repeats;
+        for (int r = 0; r < repetitions; ++r) {
+            repeats.push_back(runCase(benchmarkCase, minTime));
+            runs.push_back(repeats.back());
+        }
+        if (format != "console" || !outFile.empty()) {
+            cerr << "Finished " << benchmarkCase.name << endl;
+        }
+        if (repetitions > 1) {
+            runs.push_back(medianOf(repeats));
+        }
+        if (format == "console" && outFile.empty()) {
+            const BenchmarkRun& r = runs.back();
+            cout << left << setw(44) << r.name << right << fixed << setprecision(0)
+                 << setw(16) << r.realNs << " ns" << setw(14) << humanRate(r.itemsPerSecond) << endl;
+            cout.unsetf(ios::fixed);
+        }
+    }
+
+    ofstream file;
+    if (!outFile.empty()) {
+        file.open(outFile);
+        if (!file.is_open()) {
+            cout << "Failed to open file for writing: " << outFile << endl;
+            return 1;
+        }
+    }
+    ostream& out = outFile.empty() ? cout : file;
+    if (format == "json") {
+        printJSON(out, runs, minTime);
+    } else if (format == "csv") {
+        printCSV(out, runs);
+    } else {
+        if (outFile.empty()) cout << endl;
+        printConsole(out, runs);
+    }
+    if (!outFile.empty()) {
+        cout << "Successfully wrote " << runs.size() << " results to " << outFile << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,413 @@
+// Synthetic transaction data generator
+//
+// Writes CSV files in the exact 18-column layout read by importCSV and
+// importCSVArray. Output is deterministic for a given seed and set of
+// options, whatever the thread count: rows are generated in fixed-size
+// chunks, each chunk has its own random stream derived from the seed and
+// the chunk number, and chunks are written in order.
+//
+// Build: g++ -std=c++11 -O2 -pthread -o generate_transactions generate_transactions.cpp
+// Usage: ./generate_transactions --rows 1000000 --output transactions.csv [options]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+
+static const int CHUNK_ROWS = 65536;
+
+struct GeneratorOptions {
+    uint64_t rows;
+    string output;
+    uint64_t seed;
+    int threads;
+    double channelMix[4];      // ACH, card, UPI, wire_transfer weights
+    int locations;
+    int types;
+    int merchants;
+    int accounts;
+    double fraudRate;
+    double zipf;               // 0 means uniform
+    string startDate;
+    int days;
+
+    GeneratorOptions() : rows(1000000), output("transactions.csv"), seed(42),
+                         threads((int)max(1u, thread::hardware_concurrency())),
+                         locations(8), types(4), merchants(8), accounts(100000),
+                         fraudRate(0.035), zipf(0.0), startDate("2023-01-01"), days(365) {
+        channelMix[0] = channelMix[1] = channelMix[2] = channelMix[3] = 0.25;
+    }
+};
+
+// SplitMix64: small, fast and good enough for test data; also used to
+// derive independent per-chunk seeds.
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    uint64_t below(uint64_t n) {
+        return n ? next() % n : 0;
+    }
+
+    double gaussian() {
+        double u1 = max(uniform(), 1e-300), u2 = uniform();
+        return sqrt(-2.0 * log(u1)) * cos(6.283185307179586 * u2);
+    }
+};
+
+// Draws ranks 0..n-1 with probability proportional to 1 / (rank + 1)^s,
+// by binary search over a precomputed CDF. s = 0 gives a uniform draw.
+class ZipfSampler {
+private:
+    vector<double> cdf;
+
+public:
+    ZipfSampler(int n, double s) : cdf(max(n, 1)) {
+        double sum = 0;
+        for (size_t i = 0; i < cdf.size(); ++i) {
+            sum += 1.0 / pow((double)(i + 1), s);
+            cdf[i] = sum;
+        }
+        for (double& c : cdf) {
+            c /= sum;
+        }
+    }
+
+    int sample(Random& rng) const {
+        double u = rng.uniform();
+        size_t i = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        return (int)min(i, cdf.size() - 1);
+    }
+};
+
+// Category values: the names seen in the real dataset first, then
+// numbered synthetic ones when a higher cardinality is requested.
+vector<string> makeCategory(const vector<string>& base, const string& prefix, int cardinality) {
+    vector<string> values;
+    for (int i = 0; i < cardinality; ++i) {
+        values.push_back(i < (int)base.size() ? base[i] : prefix + to_string(i));
+    }
+    return values;
+}
+
+// Days since 1970-01-01 for a civil date (proleptic Gregorian).
+int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+void civilFromDays(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400 + (m <= 2));
+}
+
+// Appending formatters; much faster than ostream or snprintf per field.
+inline void appendUnsigned(string& out, uint64_t v) {
+    char buf[20];
+    int n = 0;
+    do {
+        buf[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) out += buf[--n];
+}
+
+inline void appendTwoDigits(string& out, unsigned v) {
+    out += (char)('0' + v / 10);
+    out += (char)('0' + v % 10);
+}
+
+// Fixed-point value with the given number of decimals, e.g. 1234 -> "12.34"
+inline void appendFixed(string& out, uint64_t scaled, int decimals) {
+    uint64_t unit = 1;
+    for (int i = 0; i < decimals; ++i) unit *= 10;
+    appendUnsigned(out, scaled / unit);
+    if (decimals > 0) {
+        out += '.';
+        uint64_t frac = scaled % unit;
+        for (uint64_t div = unit / 10; div > 0; div /= 10) {
+            out += (char)('0' + (frac / div) % 10);
+        }
+    }
+}
+
+inline void appendHex32(string& out, uint32_t v) {
+    static const char digits[] = "0123456789abcdef";
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        out += digits[(v >> shift) & 0xF];
+    }
+}
+
+class TransactionGenerator {
+private:
+    const GeneratorOptions& options;
+    vector<string> locations, types, merchants;
+    ZipfSampler locationSampler, typeSampler, merchantSampler, accountSampler;
+    double channelCdf[4];
+    int64_t startSeconds;
+
+public:
+    static const char* CHANNELS[4];
+
+    explicit TransactionGenerator(const GeneratorOptions& opts)
+        : options(opts),
+          locations(makeCategory({"Tokyo", "Toronto", "London", "Sydney", "Berlin", "Dubai", "New York", "Singapore"},
+                                 "City_", opts.locations)),
+          types(makeCategory({"withdrawal", "deposit", "transfer", "payment"}, "type_", opts.types)),
+          merchants(makeCategory({"utilities", "online", "retail", "grocery", "travel", "restaurant",
+                                  "entertainment", "other"}, "merchant_", opts.merchants)),
+          locationSampler(opts.locations, opts.zipf),
+          typeSampler(opts.types, opts.zipf),
+          merchantSampler(opts.merchants, opts.zipf),
+          accountSampler(opts.accounts, opts.zipf) {
+        double sum = 0;
+        for (int c = 0; c < 4; ++c) {
+            sum += options.channelMix[c];
+            channelCdf[c] = sum;
+        }
+        for (int c = 0; c < 4; ++c) {
+            channelCdf[c] /= sum;
+        }
+        int y = 2023;
+        unsigned m = 1, d = 1;
+        sscanf(options.startDate.c_str(), "%d-%u-%u", &y, &m, &d);
+        startSeconds = daysFromCivil(y, m, d) * 86400;
+    }
+
+    // Appends rows [first, first + count) to out. Chunk seeds depend only on
+    // the global seed and the chunk number.
+    void generateChunk(uint64_t chunk, uint64_t first, uint64_t count, string& out) const {
+        static const char* devices[4] = {"mobile", "atm", "pos", "web"};
+        static const char* fraudTypes[4] = {"card_not_present", "account_takeover", "phishing", "money_laundering"};
+        Random seeder(options.seed ^ (chunk * 0xD1B54A32D192ED03ULL));
+        Random rng(seeder.next());
+
+        out.clear();
+        out.reserve(count * 160);
+        for (uint64_t i = first; i < first + count; ++i) {
+            bool fraud = rng.uniform() < options.fraudRate;
+            double u = rng.uniform();
+            int channel = 0;
+            while (channel < 3 && u > channelCdf[channel]) channel++;
+
+            out += 'T';
+            appendUnsigned(out, i);
+            out += ',';
+
+            int64_t seconds = startSeconds + (int64_t)rng.below((uint64_t)options.days * 86400);
+            int year;
+            unsigned month, day;
+            civilFromDays(seconds / 86400, year, month, day);
+            unsigned secOfDay = (unsigned)(seconds % 86400);
+            appendUnsigned(out, (uint64_t)year);
+            out += '-'; appendTwoDigits(out, month);
+            out += '-'; appendTwoDigits(out, day);
+            out += ' '; appendTwoDigits(out, secOfDay / 3600);
+            out += ':'; appendTwoDigits(out, secOfDay / 60 % 60);
+            out += ':'; appendTwoDigits(out, secOfDay % 60);
+            out += ',';
+
+            out += "ACC"; appendUnsigned(out, 100000 + (uint64_t)accountSampler.sample(rng)); out += ',';
+            out += "ACC"; appendUnsigned(out, 100000 + (uint64_t)accountSampler.sample(rng)); out += ',';
+
+            // Log-normal amounts, heavier for fraud, in cents
+            double amount = exp(4.5 + 1.2 * rng.gaussian()) * (fraud ? 3.0 : 1.0);
+            appendFixed(out, (uint64_t)(min(amount, 1e7) * 100 + 0.5), 2);
+            out += ',';
+
+            out += types[typeSampler.sample(rng)]; out += ',';
+            out += merchants[merchantSampler.sample(rng)]; out += ',';
+            out += locations[locationSampler.sample(rng)]; out += ',';
+            out += devices[rng.below(4)]; out += ',';
+            out += fraud ? "True," : "False,";
+            if (fraud) out += fraudTypes[rng.below(4)];
+            out += ',';
+
+            appendFixed(out, rng.below(10000000), 1);   // time since last, 0-999999.9 s
+            out += ',';
+            appendFixed(out, (uint64_t)(fabs(rng.gaussian()) * 100 + (fraud ? 150 : 0)), 2);
+            out += ',';
+            appendUnsigned(out, 1 + rng.below(fraud ? 20 : 10));
+            out += ',';
+            appendFixed(out, rng.below(101), 2);
+            out += ',';
+
+            out += CHANNELS[channel]; out += ',';
+            out += "192.168.";
+            appendUnsigned(out, rng.below(256)); out += '.';
+            appendUnsigned(out, rng.below(256)); out += ',';
+            out += 'D';
+            appendHex32(out, (uint32_t)rng.next());
+            out += '\n';
+        }
+    }
+};
+
+const char* TransactionGenerator::CHANNELS[4] = {"ACH", "card", "UPI", "wire_transfer"};
+
+// Each round generates up to `threads` chunks in parallel while the
+// previous round's chunks are written, so disk and CPU overlap.
+bool generate(const GeneratorOptions& options) {
+    ofstream out(options.output, ios::binary | ios::trunc);
+    if (!out.is_open()) {
+        cout << "Failed to open file for writing: " << options.output << endl;
+        return false;
+    }
+    out << "transaction_id,timestamp,sender_account,receiver_account,amount,transaction_type,"
+           "merchant_category,location,device_used,is_fraud,fraud_type,time_since_last_transaction,"
+           "spending_deviation_score,velocity_score,geo_anomaly_score,payment_channel,ip_address,device_hash\n";
+
+    auto start = chrono::high_resolution_clock::now();
+    TransactionGenerator generator(options);
+    uint64_t chunks = (options.rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    int threads = max(1, options.threads);
+    vector<string> ready(threads), pending(threads);
+    uint64_t readyCount = 0, bytes = 0;
+
+    for (uint64_t base = 0; base < chunks || readyCount > 0; base += threads) {
+        vector<thread> workers;
+        uint64_t pendingCount = 0;
+        for (int t = 0; t < threads && base + t < chunks; ++t) {
+            uint64_t chunk = base + t;
+            uint64_t first = chunk * CHUNK_ROWS;
+            uint64_t count = min<uint64_t>(CHUNK_ROWS, options.rows - first);
+            workers.push_back(thread([&generator, &pending, t, chunk, first, count]() {
+                generator.generateChunk(chunk, first, count, pending[t]);
+            }));
+            pendingCount++;
+        }
+        for (uint64_t t = 0; t < readyCount; ++t) {
+            out.write(ready[t].data(), ready[t].size());
+            bytes += ready[t].size();
+        }
+        for (thread& w : workers) w.join();
+        swap(ready, pending);
+        readyCount = pendingCount;
+        if (!out) {
+            cout << "Write failed: " << options.output << endl;
+            return false;
+        }
+    }
+    out.close();
+
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+    cout << "Successfully generated " << options.rows << " transactions in " << options.output << endl;
+    cout << "Time taken: " << elapsed.count() << " seconds ("
+         << (uint64_t)(options.rows / max(elapsed.count(), 1e-9)) << " rows/sec, "
+         << bytes / (1024.0 * 1024.0) / max(elapsed.count(), 1e-9) << " MB/sec)" << endl;
+    return true;
+}
+
+void printUsage() {
+    cout << "Usage: generate_transactions --rows N --output FILE [options]\n"
+         << "  --seed N            random seed (default 42)\n"
+         << "  --threads N         generator threads (default: hardware threads)\n"
+         << "  --channel-mix a,c,u,w  weights for ACH, card, UPI, wire_transfer (default 1,1,1,1)\n"
+         << "  --locations N       distinct locations (default 8)\n"
+         << "  --types N           distinct transaction types (default 4)\n"
+         << "  --merchants N       distinct merchant categories (default 8)\n"
+         << "  --accounts N        distinct sender/receiver accounts (default 100000)\n"
+         << "  --fraud-rate R      fraction of fraudulent rows (default 0.035)\n"
+         << "  --zipf S            Zipf exponent for categories and accounts; 0 = uniform (default 0)\n"
+         << "  --start-date D      first day, YYYY-MM-DD (default 2023-01-01)\n"
+         << "  --days N            timestamp range in days (default 365)\n";
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--rows") {
+            options.rows = strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--seed") {
+            options.seed = strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--threads") {
+            options.threads = atoi(value.c_str());
+        } else if (arg == "--channel-mix") {
+            stringstream ss(value);
+            string weight;
+            for (int c = 0; c < 4; ++c) {
+                options.channelMix[c] = getline(ss, weight, ',') ? atof(weight.c_str()) : 0.0;
+            }
+        } else if (arg == "--locations") {
+            options.locations = atoi(value.c_str());
+        } else if (arg == "--types") {
+            options.types = atoi(value.c_str());
+        } else if (arg == "--merchants") {
+            options.merchants = atoi(value.c_str());
+        } else if (arg == "--accounts") {
+            options.accounts = atoi(value.c_str());
+        } else if (arg == "--fraud-rate") {
+            options.fraudRate = atof(value.c_str());
+        } else if (arg == "--zipf") {
+            options.zipf = atof(value.c_str());
+        } else if (arg == "--start-date") {
+            options.startDate = value;
+        } else if (arg == "--days") {
+            options.days = atoi(value.c_str());
+        } else {
+            cout << "Unknown option: " << arg << endl;
+            printUsage();
+            return 1;
+        }
+    }
+
+    double mix = options.channelMix[0] + options.channelMix[1] + options.channelMix[2] + options.channelMix[3];
+    if (options.rows == 0 || options.locations <= 0 || options.types <= 0 || options.merchants <= 0 ||
+        options.accounts <= 0 || options.days <= 0 || options.zipf < 0 || mix <= 0 ||
+        options.fraudRate < 0 || options.fraudRate > 1) {
+        cout << "Invalid generator options." << endl;
+        printUsage();
+        return 1;
+    }
+
+    return generate(options) ? 0 : 1;
+}
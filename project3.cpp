@@ -1,1114 +1,11274 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <limits>
-#include <algorithm>
-#include <iomanip>
-#include <chrono>
-
-using namespace std;
-
-// Linked List Implementation
-struct Transaction {
-    string transaction_id, timestamp, sender_account, receiver_account;
-    double amount;
-    string transaction_type, merchant_category, location, device_used, is_fraud, fraud_type;
-    double time_since_last_transaction, spending_deviation_score, geo_anomaly_score;
-    int velocity_score;
-    string payment_channel, ip_address, device_hash;
-    Transaction* next;
-
-    Transaction() : next(nullptr) {}
-};
-
-class TransactionList {
-private:
-    Transaction* head;
-    int count;
-
-    Transaction* split(Transaction* head) {
-        Transaction* fast = head;
-        Transaction* slow = head;
-        Transaction* prev = nullptr;
-        
-        while (fast && fast->next) {
-            prev = slow;
-            slow = slow->next;
-            fast = fast->next->next;
-        }
-        
-        if (prev) {
-            prev->next = nullptr;
-        }
-        
-        return slow;
-    }
-
-    Transaction* merge(Transaction* left, Transaction* right) {
-        Transaction dummy;
-        Transaction* tail = &dummy;
-        dummy.next = nullptr;
-
-        while (left && right) {
-            if (left->location < right->location) {
-                tail->next = left;
-                left = left->next;
-            } else {
-                tail->next = right;
-                right = right->next;
-            }
-            tail = tail->next;
-        }
-
-        tail->next = (left) ? left : right;
-        return dummy.next;
-    }
-
-    Transaction* mergeSort(Transaction* head) {
-        if (!head || !head->next) {
-            return head;
-        }
-        
-        Transaction* middle = split(head);
-        Transaction* left = mergeSort(head);
-        Transaction* right = mergeSort(middle);
-        
-        return merge(left, right);
-    }
-
-public:
-    TransactionList() : head(nullptr), count(0) {}
-
-    ~TransactionList() {
-        while (head) {
-            Transaction* temp = head;
-            head = head->next;
-            delete temp;
-        }
-    }
-
-    void addTransaction(Transaction* newTrans) {
-        newTrans->next = head;
-        head = newTrans;
-        count++;
-    }
-
-    void displayTransactions(int limit) {
-        if (head == nullptr) {
-            cout << "No transactions to display." << endl;
-            return;
-        }
-
-        Transaction* current = head;
-        int displayed = 0;
-        while (current && (limit == -1 || displayed < limit)) {
-            cout << "===== Transaction " << (displayed + 1) << " =====" << endl;
-            cout << "ID: " << current->transaction_id << endl;
-            cout << "Timestamp: " << current->timestamp << endl;
-            cout << "Sender: " << current->sender_account << endl;
-            cout << "Receiver: " << current->receiver_account << endl;
-            cout << "Amount: " << current->amount << endl;
-            cout << "Type: " << current->transaction_type << endl;
-            cout << "Merchant: " << current->merchant_category << endl;
-            cout << "Location: " << current->location << endl;
-            cout << "Device: " << current->device_used << endl;
-            cout << "Is Fraud: " << current->is_fraud << endl;
-            cout << "Fraud Type: " << current->fraud_type << endl;
-            cout << "Time Since Last: " << current->time_since_last_transaction << endl;
-            cout << "Spending Deviation: " << current->spending_deviation_score << endl;
-            cout << "Velocity: " << current->velocity_score << endl;
-            cout << "Geo Anomaly: " << current->geo_anomaly_score << endl;
-            cout << "Payment Channel: " << current->payment_channel << endl;
-            cout << "IP: " << current->ip_address << endl;
-            cout << "Device Hash: " << current->device_hash << endl << endl;
-
-            current = current->next;
-            displayed++;
-        }
-
-        if (limit != -1 && displayed < count) {
-            cout << "Displaying " << displayed << " of " << count << " transactions." << endl;
-        }
-    }
-
-    void sortByLocation() {
-        if (head == nullptr || head->next == nullptr) {
-            cout << "No transactions to sort or already sorted." << endl;
-            return;
-        }
-
-        cout << "Sorting transactions by location (merge sort)..." << endl;
-        auto start = chrono::high_resolution_clock::now();
-
-        head = mergeSort(head);
-
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> elapsed = end - start;
-        cout << "Successfully sorted " << count << " transactions by location in " 
-             << elapsed.count() << " seconds." << endl;
-    }
-
-    void searchByTransactionType(const string& type) {
-        if (head == nullptr) {
-            cout << "No transactions to search." << endl;
-            return;
-        }
-
-        Transaction* current = head;
-        int found = 0;
-        while (current) {
-            if (current->transaction_type == type) {
-                cout << "===== Match " << (found + 1) << " =====" << endl;
-                cout << "ID: " << current->transaction_id << endl;
-                cout << "Date: " << current->timestamp << endl;
-                cout << "Amount: " << current->amount << endl;
-                cout << "Location: " << current->location << endl;
-                cout << "Payment Channel: " << current->payment_channel << endl;
-                found++;
-            }
-            current = current->next;
-        }
-
-        if (found == 0) {
-            cout << "No transactions found with type: " << type << endl;
-        } else {
-            cout << "Found " << found << " matching transactions." << endl;
-        }
-    }
-
-    void linearSearch(const string& query, const string& field) {
-        if (head == nullptr) {
-            cout << "No transactions to search." << endl;
-            return;
-        }
-
-        auto start = chrono::high_resolution_clock::now();
-        Transaction* current = head;
-        int found = 0;
-
-        while (current) {
-            if (field == "type" && current->transaction_type == query) {
-                found++;
-            } else if (field == "location" && current->location == query) {
-                found++;
-            } else if (field == "fraud" && current->is_fraud == query) {
-                found++;
-            }
-            current = current->next;
-        }
-
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> elapsed = end - start;
-
-        cout << "\nLinear Search Results for " << field << " = " << query << ":" << endl;
-        cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
-    }
-
-    bool binarySearch(const string& query, const string& field) {
-        if (count == 0) {
-            cout << "No transactions to search." << endl;
-            return false;
-        }
-
-        // Convert linked list to array for binary search
-        Transaction** arr = new Transaction*[count];
-        Transaction* current = head;
-        for (int i = 0; i < count; i++) {
-            arr[i] = current;
-            current = current->next;
-        }
-
-        // Sort the array based on the search field
-        if (field == "type") {
-            sort(arr, arr + count, [](Transaction* a, Transaction* b) {
-                return a->transaction_type < b->transaction_type;
-            });
-        } else if (field == "location") {
-            sort(arr, arr + count, [](Transaction* a, Transaction* b) {
-                return a->location < b->location;
-            });
-        }
-
-        auto start = chrono::high_resolution_clock::now();
-
-        // Perform binary search
-        int left = 0, right = count - 1;
-        int found = 0;
-
-        while (left <= right) {
-            int mid = left + (right - left) / 2;
-
-            if (field == "type" && arr[mid]->transaction_type == query) {
-                // Count all matching occurrences (since there may be duplicates)
-                found = 1;
-                // Check left side
-                int left_ptr = mid - 1;
-                while (left_ptr >= 0 && arr[left_ptr]->transaction_type == query) {
-                    found++;
-                    left_ptr--;
-                }
-                // Check right side
-                int right_ptr = mid + 1;
-                while (right_ptr < count && arr[right_ptr]->transaction_type == query) {
-                    found++;
-                    right_ptr++;
-                }
-                break;
-            } else if (field == "location" && arr[mid]->location == query) {
-                found = 1;
-                int left_ptr = mid - 1;
-                while (left_ptr >= 0 && arr[left_ptr]->location == query) {
-                    found++;
-                    left_ptr--;
-                }
-                int right_ptr = mid + 1;
-                while (right_ptr < count && arr[right_ptr]->location == query) {
-                    found++;
-                    right_ptr++;
-                }
-                break;
-            }
-            
-            string fieldValue;
-            if (field == "type") {
-                fieldValue = arr[mid]->transaction_type;
-            } else if (field == "location") {
-                fieldValue = arr[mid]->location;
-            }
-            
-            if (fieldValue < query) {
-                left = mid + 1;
-            } else {
-                right = mid - 1;
-            }
-        }
-
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> elapsed = end - start;
-
-        cout << "\nBinary Search Results for " << field << " = " << query << ":" << endl;
-        if (found > 0) {
-            cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
-        } else {
-            cout << "No matches found in " << elapsed.count() << " seconds" << endl;
-        }
-
-        delete[] arr;
-        return found > 0;
-    }
-
-    void exportToJSON(const string& filename) {
-        ofstream outFile(filename);
-        if (!outFile.is_open()) {
-            cout << "Failed to open file for writing: " << filename << endl;
-            return;
-        }
-
-        outFile << "[\n";
-        Transaction* current = head;
-        bool first = true;
-
-        while (current) {
-            if (!first) {
-                outFile << ",\n";
-            }
-            first = false;
-
-            outFile << "  {\n";
-            outFile << "    \"transaction_id\": \"" << current->transaction_id << "\",\n";
-            outFile << "    \"timestamp\": \"" << current->timestamp << "\",\n";
-            outFile << "    \"sender_account\": \"" << current->sender_account << "\",\n";
-            outFile << "    \"receiver_account\": \"" << current->receiver_account << "\",\n";
-            outFile << "    \"amount\": " << current->amount << ",\n";
-            outFile << "    \"transaction_type\": \"" << current->transaction_type << "\",\n";
-            outFile << "    \"merchant_category\": \"" << current->merchant_category << "\",\n";
-            outFile << "    \"location\": \"" << current->location << "\",\n";
-            outFile << "    \"device_used\": \"" << current->device_used << "\",\n";
-            outFile << "    \"is_fraud\": \"" << current->is_fraud << "\",\n";
-            outFile << "    \"fraud_type\": \"" << current->fraud_type << "\",\n";
-            outFile << "    \"time_since_last_transaction\": " << current->time_since_last_transaction << ",\n";
-            outFile << "    \"spending_deviation_score\": " << current->spending_deviation_score << ",\n";
-            outFile << "    \"velocity_score\": " << current->velocity_score << ",\n";
-            outFile << "    \"geo_anomaly_score\": " << current->geo_anomaly_score << ",\n";
-            outFile << "    \"payment_channel\": \"" << current->payment_channel << "\",\n";
-            outFile << "    \"ip_address\": \"" << current->ip_address << "\",\n";
-            outFile << "    \"device_hash\": \"" << current->device_hash << "\"\n";
-            outFile << "  }";
-
-            current = current->next;
-        }
-
-        outFile << "\n]";
-        outFile.close();
-        cout << "Successfully exported " << count << " transactions to " << filename << endl;
-    }
-
-    int getCount() const { return count; }
-};
-
-// Array Implementation
-struct ArrayTransaction {
-    string transaction_id;
-    string timestamp;
-    string sender_account;
-    string receiver_account;
-    double amount;
-    string transaction_type;
-    string merchant_category;
-    string location;
-    string device_used;
-    string is_fraud;
-    string fraud_type;
-    double time_since_last_transaction;
-    double spending_deviation_score;
-    int velocity_score;
-    double geo_anomaly_score;
-    string payment_channel;
-    string ip_address;
-    string device_hash;
-};
-
-class ArrayTransactionList {
-private:
-    ArrayTransaction** transactions;
-    int count;
-    int capacity;
-
-    void resize() {
-        capacity *= 2;
-        ArrayTransaction** newTransactions = new ArrayTransaction*[capacity];
-        for (int i = 0; i < count; ++i) {
-            newTransactions[i] = transactions[i];
-        }
-        delete[] transactions;
-        transactions = newTransactions;
-    }
-
-    void merge(ArrayTransaction** arr, int left, int mid, int right) {
-        int n1 = mid - left + 1;
-        int n2 = right - mid;
-
-        ArrayTransaction** L = new ArrayTransaction*[n1];
-        ArrayTransaction** R = new ArrayTransaction*[n2];
-
-        for (int i = 0; i < n1; i++) L[i] = arr[left + i];
-        for (int j = 0; j < n2; j++) R[j] = arr[mid + 1 + j];
-
-        int i = 0, j = 0, k = left;
-        while (i < n1 && j < n2) {
-            if (L[i]->location <= R[j]->location) {
-                arr[k++] = L[i++];
-            } else {
-                arr[k++] = R[j++];
-            }
-        }
-
-        while (i < n1) arr[k++] = L[i++];
-        while (j < n2) arr[k++] = R[j++];
-
-        delete[] L;
-        delete[] R;
-    }
-
-    void mergeSort(ArrayTransaction** arr, int left, int right) {
-        if (left < right) {
-            int mid = left + (right - left) / 2;
-            mergeSort(arr, left, mid);
-            mergeSort(arr, mid + 1, right);
-            merge(arr, left, mid, right);
-        }
-    }
-
-public:
-    ArrayTransactionList(int initialCapacity = 10) : count(0), capacity(initialCapacity) {
-        transactions = new ArrayTransaction*[capacity];
-    }
-
-    ~ArrayTransactionList() {
-        for (int i = 0; i < count; ++i) {
-            delete transactions[i];
-        }
-        delete[] transactions;
-    }
-
-    void addTransaction(ArrayTransaction* t) {
-        if (count == capacity) {
-            resize();
-        }
-        transactions[count++] = t;
-    }
-
-    void displayTransactions(int limit) {
-        if (count == 0) {
-            cout << "No transactions to display." << endl;
-            return;
-        }
-
-        int displayCount = (limit == -1) ? count : min(limit, count);
-        cout << "\nDisplaying " << displayCount << " of " << count << " transactions..." << endl;
-        cout << "=====================================" << endl;
-        for (int i = 0; i < displayCount; ++i) {
-            ArrayTransaction* t = transactions[i];
-            cout << "Transaction ID: " << t->transaction_id << endl;
-            cout << "Timestamp: " << t->timestamp << endl;
-            cout << "Sender: " << t->sender_account << endl;
-            cout << "Receiver: " << t->receiver_account << endl;
-            cout << "Amount: $" << fixed << setprecision(2) << t->amount << endl;
-            cout << "Type: " << t->transaction_type << endl;
-            cout << "Merchant: " << t->merchant_category << endl;
-            cout << "Location: " << t->location << endl;
-            cout << "Is Fraud: " << t->is_fraud << endl;
-            cout << "Fraud Type: " << t->fraud_type << endl;
-            cout << "Payment Channel: " << t->payment_channel << endl;
-            cout << "-------------------------------------" << endl;
-        }
-        cout << "=====================================" << endl;
-    }
-
-    void sortByLocation() {
-        if (count < 2) {
-            cout << "Not enough transactions to sort." << endl;
-            return;
-        }
-        cout << "Sorting transactions by location using merge sort..." << endl;
-        mergeSort(transactions, 0, count - 1);
-        cout << "Successfully sorted " << count << " transactions by location." << endl;
-    }
-
-    void searchByTransactionType(const string& type) {
-        if (count == 0) {
-            cout << "No transactions to search." << endl;
-            return;
-        }
-
-        int found = 0;
-        cout << "\nSearching for transaction type '" << type << "'..." << endl;
-        cout << "=====================================" << endl;
-        for (int i = 0; i < count; ++i) {
-            if (transactions[i]->transaction_type == type) {
-                ArrayTransaction* t = transactions[i];
-                cout << "Match #" << ++found << endl;
-                cout << "ID: " << t->transaction_id << endl;
-                cout << "Amount: $" << fixed << setprecision(2) << t->amount << endl;
-                cout << "Location: " << t->location << endl;
-                cout << "Payment Channel: " << t->payment_channel << endl;
-                cout << "-------------------------------------" << endl;
-            }
-        }
-        cout << "=====================================" << endl;
-        if (found == 0) {
-            cout << "No transactions found with type: " << type << endl;
-        } else {
-            cout << "Found " << found << " matching transactions." << endl;
-        }
-    }
-
-    void linearSearch(const string& query, const string& field) {
-        if (count == 0) {
-            cout << "No transactions to search." << endl;
-            return;
-        }
-
-        auto start = chrono::high_resolution_clock::now();
-        int found = 0;
-
-        for (int i = 0; i < count; ++i) {
-            if (field == "type" && transactions[i]->transaction_type == query) {
-                found++;
-            } else if (field == "location" && transactions[i]->location == query) {
-                found++;
-            } else if (field == "fraud" && transactions[i]->is_fraud == query) {
-                found++;
-            }
-        }
-
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> elapsed = end - start;
-
-        cout << "\nLinear Search Results for " << field << " = " << query << ":" << endl;
-        cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
-    }
-
-    bool binarySearch(const string& query, const string& field) {
-        if (count == 0) {
-            cout << "No transactions to search." << endl;
-            return false;
-        }
-
-        // Sort the array if needed
-        if (field == "type") {
-            sort(transactions, transactions + count, [](ArrayTransaction* a, ArrayTransaction* b) {
-                return a->transaction_type < b->transaction_type;
-            });
-        } else if (field == "location") {
-            sort(transactions, transactions + count, [](ArrayTransaction* a, ArrayTransaction* b) {
-                return a->location < b->location;
-            });
-        }
-
-        auto start = chrono::high_resolution_clock::now();
-
-        // Perform binary search
-        int left = 0, right = count - 1;
-        int found = 0;
-
-        while (left <= right) {
-            int mid = left + (right - left) / 2;
-
-            if (field == "type" && transactions[mid]->transaction_type == query) {
-                found = 1;
-                // Check duplicates
-                int left_ptr = mid - 1;
-                while (left_ptr >= 0 && transactions[left_ptr]->transaction_type == query) {
-                    found++;
-                    left_ptr--;
-                }
-                int right_ptr = mid + 1;
-                while (right_ptr < count && transactions[right_ptr]->transaction_type == query) {
-                    found++;
-                    right_ptr++;
-                }
-                break;
-            } else if (field == "location" && transactions[mid]->location == query) {
-                found = 1;
-                int left_ptr = mid - 1;
-                while (left_ptr >= 0 && transactions[left_ptr]->location == query) {
-                    found++;
-                    left_ptr--;
-                }
-                int right_ptr = mid + 1;
-                while (right_ptr < count && transactions[right_ptr]->location == query) {
-                    found++;
-                    right_ptr++;
-                }
-                break;
-            }
-            
-            string fieldValue;
-            if (field == "type") {
-                fieldValue = transactions[mid]->transaction_type;
-            } else if (field == "location") {
-                fieldValue = transactions[mid]->location;
-            }
-            
-            if (fieldValue < query) {
-                left = mid + 1;
-            } else {
-                right = mid - 1;
-            }
-        }
-
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> elapsed = end - start;
-
-        cout << "\nBinary Search Results for " << field << " = " << query << ":" << endl;
-        if (found > 0) {
-            cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
-        } else {
-            cout << "No matches found in " << elapsed.count() << " seconds" << endl;
-        }
-
-        return found > 0;
-    }
-
-    void exportToJSON(const string& filename) {
-        ofstream outFile(filename);
-        if (!outFile.is_open()) {
-            cout << "Failed to open file for writing: " << filename << endl;
-            return;
-        }
-
-        outFile << "[\n";
-        bool first = true;
-
-        for (int i = 0; i < count; ++i) {
-            ArrayTransaction* t = transactions[i];
-            if (!first) {
-                outFile << ",\n";
-            }
-            first = false;
-
-            outFile << "  {\n";
-            outFile << "    \"transaction_id\": \"" << t->transaction_id << "\",\n";
-            outFile << "    \"timestamp\": \"" << t->timestamp << "\",\n";
-            outFile << "    \"sender_account\": \"" << t->sender_account << "\",\n";
-            outFile << "    \"receiver_account\": \"" << t->receiver_account << "\",\n";
-            outFile << "    \"amount\": " << t->amount << ",\n";
-            outFile << "    \"transaction_type\": \"" << t->transaction_type << "\",\n";
-            outFile << "    \"merchant_category\": \"" << t->merchant_category << "\",\n";
-            outFile << "    \"location\": \"" << t->location << "\",\n";
-            outFile << "    \"device_used\": \"" << t->device_used << "\",\n";
-            outFile << "    \"is_fraud\": \"" << t->is_fraud << "\",\n";
-            outFile << "    \"fraud_type\": \"" << t->fraud_type << "\",\n";
-            outFile << "    \"time_since_last_transaction\": " << t->time_since_last_transaction << ",\n";
-            outFile << "    \"spending_deviation_score\": " << t->spending_deviation_score << ",\n";
-            outFile << "    \"velocity_score\": " << t->velocity_score << ",\n";
-            outFile << "    \"geo_anomaly_score\": " << t->geo_anomaly_score << ",\n";
-            outFile << "    \"payment_channel\": \"" << t->payment_channel << "\",\n";
-            outFile << "    \"ip_address\": \"" << t->ip_address << "\",\n";
-            outFile << "    \"device_hash\": \"" << t->device_hash << "\"\n";
-            outFile << "  }";
-        }
-
-        outFile << "\n]";
-        outFile.close();
-        cout << "Successfully exported " << count << " transactions to " << filename << endl;
-    }
-
-    int getCount() const { return count; }
-};
-
-// Helper functions
-void clearInputBuffer() {
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-}
-
-bool importCSV(const string& filename, TransactionList& achList,
-               TransactionList& cardList, TransactionList& upiList,
-               TransactionList& wireList) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "Failed to open file: " << filename << endl;
-        return false;
-    }
-
-    size_t estimatedMemoryUsage = 0;
-    int processed = 0;
-    string line;
-    getline(file, line); // Skip header
-
-    auto start = chrono::high_resolution_clock::now(); // Start timer
-
-    while (getline(file, line)) {
-        estimatedMemoryUsage += line.size() * sizeof(char);
-        stringstream ss(line);
-        string field;
-        Transaction* t = new Transaction();
-
-        try {
-            getline(ss, t->transaction_id, ',');
-            getline(ss, t->timestamp, ',');
-            getline(ss, t->sender_account, ',');
-            getline(ss, t->receiver_account, ',');
-
-            getline(ss, field, ',');
-            t->amount = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, t->transaction_type, ',');
-            getline(ss, t->merchant_category, ',');
-            getline(ss, t->location, ',');
-            getline(ss, t->device_used, ',');
-            getline(ss, t->is_fraud, ',');
-            getline(ss, t->fraud_type, ',');
-
-            getline(ss, field, ',');
-            t->time_since_last_transaction = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, field, ',');
-            t->spending_deviation_score = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, field, ',');
-            t->velocity_score = field.empty() ? 0 : stoi(field);
-
-            getline(ss, field, ',');
-            t->geo_anomaly_score = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, t->payment_channel, ',');
-            getline(ss, t->ip_address, ',');
-            getline(ss, t->device_hash, ',');
-
-            if (t->payment_channel == "ACH") {
-                achList.addTransaction(t);
-            } else if (t->payment_channel == "card") {
-                cardList.addTransaction(t);
-            } else if (t->payment_channel == "UPI") {
-                upiList.addTransaction(t);
-            } else if (t->payment_channel == "wire_transfer") {
-                wireList.addTransaction(t);
-            } else {
-                delete t;
-                continue;
-            }
-
-            processed++;
-        } catch (const exception& e) {
-            cout << "Error parsing line: " << line << endl;
-            cout << "Error: " << e.what() << endl;
-            delete t;
-            continue;
-        }
-    }
-
-    file.close();
-    auto end = chrono::high_resolution_clock::now(); // End timer
-    chrono::duration<double> elapsed = end - start; // Calculate elapsed time
-
-    cout << "Successfully processed " << processed << " transactions." << endl;
-    cout << "Linked List Implementation:" << endl;
-    cout << "Time taken to load CSV: " << elapsed.count() << " seconds." << endl;
-    cout << "Estimated memory usage: ~" << estimatedMemoryUsage / (1024 * 1024) << " MB" << endl;
-    cout << "Transaction counts by channel:" << endl;
-    cout << "- ACH: " << achList.getCount() << endl;
-    cout << "- Card: " << cardList.getCount() << endl;
-    cout << "- UPI: " << upiList.getCount() << endl;
-    cout << "- Wire Transfer: " << wireList.getCount() << endl;
-
-    return true;
-}
-
-bool importCSVArray(const string& filename, ArrayTransactionList& achList,
-                    ArrayTransactionList& cardList, ArrayTransactionList& upiList,
-                    ArrayTransactionList& wireList) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "Failed to open file: " << filename << endl;
-        return false;
-    }
-
-    size_t estimatedMemoryUsage = 0;
-    int processed = 0;
-    string line;
-    getline(file, line); // Skip header
-
-    auto start = chrono::high_resolution_clock::now(); // Start timer
-
-    while (getline(file, line)) {
-        estimatedMemoryUsage += line.size() * sizeof(char);
-        stringstream ss(line);
-        string field;
-        ArrayTransaction* t = new ArrayTransaction();
-
-        try {
-            getline(ss, t->transaction_id, ',');
-            getline(ss, t->timestamp, ',');
-            getline(ss, t->sender_account, ',');
-            getline(ss, t->receiver_account, ',');
-
-            getline(ss, field, ',');
-            t->amount = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, t->transaction_type, ',');
-            getline(ss, t->merchant_category, ',');
-            getline(ss, t->location, ',');
-            getline(ss, t->device_used, ',');
-            getline(ss, t->is_fraud, ',');
-            getline(ss, t->fraud_type, ',');
-
-            getline(ss, field, ',');
-            t->time_since_last_transaction = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, field, ',');
-            t->spending_deviation_score = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, field, ',');
-            t->velocity_score = field.empty() ? 0 : stoi(field);
-
-            getline(ss, field, ',');
-            t->geo_anomaly_score = field.empty() ? 0.0 : stod(field);
-
-            getline(ss, t->payment_channel, ',');
-            getline(ss, t->ip_address, ',');
-            getline(ss, t->device_hash, ',');
-
-            if (t->payment_channel == "ACH") {
-                achList.addTransaction(t);
-            } else if (t->payment_channel == "card") {
-                cardList.addTransaction(t);
-            } else if (t->payment_channel == "UPI") {
-                upiList.addTransaction(t);
-            } else if (t->payment_channel == "wire_transfer") {
-                wireList.addTransaction(t);
-            } else {
-                delete t;
-                continue;
-            }
-
-            processed++;
-        } catch (const exception& e) {
-            cout << "Error parsing line: " << line << endl;
-            cout << "Error: " << e.what() << endl;
-            delete t;
-            continue;
-        }
-    }
-
-    file.close();
-    auto end = chrono::high_resolution_clock::now(); // End timer
-    chrono::duration<double> elapsed = end - start; // Calculate elapsed time
-
-    cout << "Successfully processed " << processed << " transactions." << endl;
-    cout << "Array Implementation:" << endl;
-    cout << "Time taken to load CSV: " << elapsed.count() << " seconds." << endl;
-    cout << "Estimated memory usage: ~" << estimatedMemoryUsage / (1024 * 1024) << " MB" << endl;
-    cout << "Transaction counts by channel:" << endl;
-    cout << "- ACH: " << achList.getCount() << endl;
-    cout << "- Card: " << cardList.getCount() << endl;
-    cout << "- UPI: " << upiList.getCount() << endl;
-    cout << "- Wire Transfer: " << wireList.getCount() << endl;
-
-    return true;
-}
-
-void compareEfficiency() {
-    cout << "\nPerformance Comparison Summary:\n";
-    cout << "1. Linked List Pros:\n";
-    cout << "   - Dynamically grows without reallocation\n";
-    cout << "   - Efficient for frequent insertions/deletions\n";
-    cout << "   - No memory wastage for unused elements\n";
-    cout << "2. Array Pros:\n";
-    cout << "   - Better memory locality (faster iteration)\n";
-    cout << "   - Constant time random access\n";
-    cout << "   - More efficient for binary search\n";
-    cout << "3. Recommendation:\n";
-    cout << "   - Use arrays when frequent searching is needed\n";
-    cout << "   - Use linked lists when frequent modifications are needed\n";
-}
-
-void linkedListChannelMenu(TransactionList& list, const string& name) {
-    int subChoice;
-    do {
-        cout << "\n=== " << name << " Transactions (Linked List) (" << list.getCount() << ") ===" << endl;
-        cout << "1. Display First 10 Transactions" << endl;
-        cout << "2. Display All Transactions" << endl;
-        cout << "3. Search by Transaction Type (Linear)" << endl;
-        cout << "4. Search by Location (Linear)" << endl;
-        cout << "5. Search by Fraud Status (Linear)" << endl;
-        cout << "6. Search by Transaction Type (Binary)" << endl;
-        cout << "7. Search by Location (Binary)" << endl;
-        cout << "8. Sort by Location" << endl;
-        cout << "9. Export to JSON" << endl;
-        cout << "10. Back to Main Menu" << endl;
-        cout << "Enter choice: ";
-        cin >> subChoice;
-        clearInputBuffer();
-
-        switch (subChoice) {
-            case 1:
-                list.displayTransactions(10);
-                break;
-            case 2:
-                list.displayTransactions(-1);
-                break;
-            case 3: {
-                string searchType;
-                cout << "Enter transaction type to search (Linear): ";
-                getline(cin, searchType);
-                list.linearSearch(searchType, "type");
-                break;
-            }
-            case 4: {
-                string searchLocation;
-                cout << "Enter location to search (Linear): ";
-                getline(cin, searchLocation);
-                list.linearSearch(searchLocation, "location");
-                break;
-            }
-            case 5: {
-                string searchFraud;
-                cout << "Enter fraud status to search (Linear): ";
-                getline(cin, searchFraud);
-                list.linearSearch(searchFraud, "fraud");
-                break;
-            }
-            case 6: {
-                string searchType;
-                cout << "Enter transaction type to search (Binary): ";
-                getline(cin, searchType);
-                list.binarySearch(searchType, "type");
-                break;
-            }
-            case 7: {
-                string searchLocation;
-                cout << "Enter location to search (Binary): ";
-                getline(cin, searchLocation);
-                list.binarySearch(searchLocation, "location");
-                break;
-            }
-            case 8:
-                list.sortByLocation();
-                break;
-            case 9: {
-                string filename;
-                cout << "Enter filename to export (e.g., ach_transactions.json): ";
-                getline(cin, filename);
-                list.exportToJSON(filename);
-                break;
-            }
-            case 10:
-                break;
-            default:
-                cout << "Invalid choice." << endl;
-                break;
-        }
-    } while (subChoice != 10);
-}
-
-void arrayChannelMenu(ArrayTransactionList& list, const string& name) {
-    int subChoice;
-    do {
-        cout << "\n=== " << name << " Transactions (Array) (" << list.getCount() << ") ===" << endl;
-        cout << "1. Display First 10 Transactions" << endl;
-        cout << "2. Display All Transactions" << endl;
-        cout << "3. Search by Transaction Type (Linear)" << endl;
-        cout << "4. Search by Location (Linear)" << endl;
-        cout << "5. Search by Fraud Status (Linear)" << endl;
-        cout << "6. Search by Transaction Type (Binary)" << endl;
-        cout << "7. Search by Location (Binary)" << endl;
-        cout << "8. Sort by Location" << endl;
-        cout << "9. Export to JSON" << endl;
-        cout << "10. Back to Main Menu" << endl;
-        cout << "Enter choice: ";
-        cin >> subChoice;
-        clearInputBuffer();
-
-        switch (subChoice) {
-            case 1:
-                list.displayTransactions(10);
-                break;
-            case 2:
-                list.displayTransactions(-1);
-                break;
-            case 3: {
-                string searchType;
-                cout << "Enter transaction type to search (Linear): ";
-                getline(cin, searchType);
-                list.linearSearch(searchType, "type");
-                break;
-            }
-            case 4: {
-                string searchLocation;
-                cout << "Enter location to search (Linear): ";
-                getline(cin, searchLocation);
-                list.linearSearch(searchLocation, "location");
-                break;
-            }
-            case 5: {
-                string searchFraud;
-                cout << "Enter fraud status to search (Linear): ";
-                getline(cin, searchFraud);
-                list.linearSearch(searchFraud, "fraud");
-                break;
-            }
-            case 6: {
-                string searchType;
-                cout << "Enter transaction type to search (Binary): ";
-                getline(cin, searchType);
-                list.binarySearch(searchType, "type");
-                break;
-            }
-            case 7: {
-                string searchLocation;
-                cout << "Enter location to search (Binary): ";
-                getline(cin, searchLocation);
-                list.binarySearch(searchLocation, "location");
-                break;
-            }
-            case 8:
-                list.sortByLocation();
-                break;
-            case 9: {
-                string filename;
-                cout << "Enter filename to export (e.g., ach_transactions.json): ";
-                getline(cin, filename);
-                list.exportToJSON(filename);
-                break;
-            }
-            case 10:
-                break;
-            default:
-                cout << "Invalid choice." << endl;
-                break;
-        }
-    } while (subChoice != 10);
-}
-
-int main() {
-    TransactionList ll_achList, ll_cardList, ll_upiList, ll_wireList;
-    ArrayTransactionList arr_achList, arr_cardList, arr_upiList, arr_wireList;
-    
-    int implementationChoice;
-    string filename;
-    
-    cout << "Choose implementation:" << endl;
-    cout << "1. Linked List" << endl;
-    cout << "2. Array" << endl;
-    cout << "Enter choice: ";
-    cin >> implementationChoice;
-    clearInputBuffer();
-    
-    if (implementationChoice != 1 && implementationChoice != 2) {
-        cout << "Invalid choice. Exiting program." << endl;
-        return 1;
-    }
-    
-    cout << "Enter CSV filename: ";
-    getline(cin, filename);
-    
-    bool importSuccess = false;
-    if (implementationChoice == 1) {
-        importSuccess = importCSV(filename, ll_achList, ll_cardList, ll_upiList, ll_wireList);
-    } else {
-        importSuccess = importCSVArray(filename, arr_achList, arr_cardList, arr_upiList, arr_wireList);
-    }
-    
-    if (!importSuccess) {
-        return 1;
-    }
-    
-    int choice;
-    do {
-        cout << "\n=== MAIN MENU ===" << endl;
-        cout << "1. ACH Transactions" << endl;
-        cout << "2. Card Transactions" << endl;
-        cout << "3. UPI Transactions" << endl;
-        cout << "4. Wire Transfer Transactions" << endl;
-        cout << "5. Performance Comparison" << endl;
-        cout << "6. Exit" << endl;
-        cout << "Enter choice: ";
-        cin >> choice;
-        clearInputBuffer();
-
-        switch (choice) {
-            case 1:
-                if (implementationChoice == 1) {
-                    linkedListChannelMenu(ll_achList, "ACH");
-                } else {
-                    arrayChannelMenu(arr_achList, "ACH");
-                }
-                break;
-            case 2:
-                if (implementationChoice == 1) {
-                    linkedListChannelMenu(ll_cardList, "Card");
-                } else {
-                    arrayChannelMenu(arr_cardList, "Card");
-                }
-                break;
-            case 3:
-                if (implementationChoice == 1) {
-                    linkedListChannelMenu(ll_upiList, "UPI");
-                } else {
-                    arrayChannelMenu(arr_upiList, "UPI");
-                }
-                break;
-            case 4:
-                if (implementationChoice == 1) {
-                    linkedListChannelMenu(ll_wireList, "Wire Transfer");
-                } else {
-                    arrayChannelMenu(arr_wireList, "Wire Transfer");
-                }
-                break;
-            case 5:
-                compareEfficiency();
-                break;
-            case 6:
-                cout << "Exiting program." << endl;
-                break;
-            default:
-                cout << "Invalid choice." << endl;
-                break;
-        }
-    } while (choice != 6);
-
-    return 0;
-}
\ No newline at end of file
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <new>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+
+#include "nlohmann/json.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TDMS_HAVE_MMAP 1
+#endif
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <csignal>
+#define TDMS_HAVE_PERF 1
+#define TDMS_HAVE_EPOLL 1
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#define TDMS_HAVE_USABLE_SIZE 1
+#endif
+
+using namespace std;
+
+// Memory Accounting
+//
+// Every operator new/delete in the program goes through the counting hooks
+// below, so heapLiveBytes is the real number of heap bytes in use, including
+// allocator rounding. On glibc the usable size of each block comes from
+// malloc itself; elsewhere a small header records the requested size.
+static atomic<size_t> heapLiveBytes(0);
+static atomic<size_t> heapPeakBytes(0);
+static atomic<size_t> heapAllocations(0);
+
+#ifndef TDMS_HAVE_USABLE_SIZE
+static const size_t HEAP_HEADER = 16;   // keeps max_align_t alignment
+#endif
+
+inline void countAllocation(size_t bytes) {
+    size_t live = heapLiveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+    size_t peak = heapPeakBytes.load(memory_order_relaxed);
+    while (live > peak && !heapPeakBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+    }
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+}
+
+// Kept out of line so GCC does not pair an inlined free() with a new
+// expression and warn about a mismatch.
+#ifdef __GNUC__
+#define TDMS_NOINLINE __attribute__((noinline))
+#else
+#define TDMS_NOINLINE
+#endif
+
+TDMS_NOINLINE void* operator new(size_t size) {
+#ifdef TDMS_HAVE_USABLE_SIZE
+    void* p = malloc(size ? size : 1);
+    if (!p) throw bad_alloc();
+    countAllocation(malloc_usable_size(p));
+    return p;
+#else
+    char* p = (char*)malloc(size + HEAP_HEADER);
+    if (!p) throw bad_alloc();
+    *(size_t*)p = size;
+    countAllocation(size);
+    return p + HEAP_HEADER;
+#endif
+}
+
+TDMS_NOINLINE void operator delete(void* p) noexcept {
+    if (!p) return;
+#ifdef TDMS_HAVE_USABLE_SIZE
+    heapLiveBytes.fetch_sub(malloc_usable_size(p), memory_order_relaxed);
+    free(p);
+#else
+    char* block = (char*)p - HEAP_HEADER;
+    heapLiveBytes.fetch_sub(*(size_t*)block, memory_order_relaxed);
+    free(block);
+#endif
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+
+// Heap bytes held by a block returned from operator new, including the
+// allocator's per-block header.
+inline size_t heapBlockBytes(const void* p) {
+#ifdef TDMS_HAVE_USABLE_SIZE
+    return malloc_usable_size(const_cast<void*>(p)) + sizeof(size_t);
+#else
+    return *(const size_t*)((const char*)p - HEAP_HEADER) + HEAP_HEADER;
+#endif
+}
+
+// Heap bytes behind a string; short strings live inside the object itself.
+inline size_t stringHeapBytes(const string& s) {
+    const char* data = s.data();
+    const char* object = (const char*)&s;
+    if (data >= object && data < object + sizeof(string)) {
+        return 0;
+    }
+    return heapBlockBytes(data);
+}
+
+// Resident and peak resident set size of the process, in bytes.
+bool readProcessMemory(size_t& rss, size_t& peakRss) {
+    rss = peakRss = 0;
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    if (!status.is_open()) {
+        return false;
+    }
+    string line;
+    while (getline(status, line)) {
+        size_t kb;
+        if (sscanf(line.c_str(), "VmRSS: %zu kB", &kb) == 1) {
+            rss = kb * 1024;
+        } else if (sscanf(line.c_str(), "VmHWM: %zu kB", &kb) == 1) {
+            peakRss = kb * 1024;
+        }
+    }
+    return rss > 0;
+#else
+    return false;
+#endif
+}
+
+struct MemoryBreakdown {
+    size_t records;   // record objects / nodes, or fixed-width columns
+    size_t strings;   // out-of-line string bytes
+    size_t indexes;   // pointer arrays and sort indexes
+
+    MemoryBreakdown() : records(0), strings(0), indexes(0) {}
+    size_t total() const { return records + strings + indexes; }
+};
+
+template <typename Record>
+void accountRecord(const Record* t, MemoryBreakdown& m) {
+    m.records += heapBlockBytes(t);
+    m.strings += stringHeapBytes(t->transaction_id) + stringHeapBytes(t->timestamp)
+               + stringHeapBytes(t->sender_account) + stringHeapBytes(t->receiver_account)
+               + stringHeapBytes(t->transaction_type) + stringHeapBytes(t->merchant_category)
+               + stringHeapBytes(t->location) + stringHeapBytes(t->device_used)
+               + stringHeapBytes(t->is_fraud) + stringHeapBytes(t->fraud_type)
+               + stringHeapBytes(t->payment_channel) + stringHeapBytes(t->ip_address)
+               + stringHeapBytes(t->device_hash);
+}
+
+inline double toMB(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+// Printed after every import: measured heap growth and process RSS.
+void printImportMemory(size_t heapBefore, int processed) {
+    size_t heapNow = heapLiveBytes.load(memory_order_relaxed);
+    size_t grown = heapNow > heapBefore ? heapNow - heapBefore : 0;
+    cout << fixed << setprecision(1);
+    cout << "Heap allocated by import: " << toMB(grown) << " MB";
+    if (processed > 0) {
+        cout << " (" << setprecision(0) << (double)grown / processed << " bytes/transaction)";
+    }
+    cout << endl;
+    size_t rss, peakRss;
+    if (readProcessMemory(rss, peakRss)) {
+        cout << setprecision(1) << "Process RSS: " << toMB(rss) << " MB (peak " << toMB(peakRss) << " MB)" << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Hardware Performance Counters
+//
+// Optional instrumentation built on Linux perf_event_open. It is off by
+// default and is switched on with TDMS_PERF=1 in the environment or the
+// --perf flag. Counters are opened once per thread, count user-space
+// work only (so perf_event_paranoid <= 2 is enough), and are never reset:
+// a measurement is the difference between two reads, which lets scopes
+// nest. Values are scaled for multiplexing when the PMU is oversubscribed.
+enum PerfEvent {
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_EVENT_COUNT
+};
+
+static const char* const PERF_EVENT_NAMES[PERF_EVENT_COUNT] = {
+    "cycles", "instructions", "L1D misses", "LLC misses", "branch misses"
+};
+
+struct PerfSample {
+    bool available[PERF_EVENT_COUNT];
+    double values[PERF_EVENT_COUNT];
+
+    PerfSample() {
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            available[e] = false;
+            values[e] = 0;
+        }
+    }
+
+    bool any() const {
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (available[e]) return true;
+        }
+        return false;
+    }
+
+    PerfSample operator-(const PerfSample& earlier) const {
+        PerfSample d;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            d.available[e] = available[e] && earlier.available[e];
+            d.values[e] = d.available[e] ? values[e] - earlier.values[e] : 0;
+        }
+        return d;
+    }
+
+    PerfSample& operator+=(const PerfSample& other) {
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            available[e] = other.available[e];
+            values[e] += other.values[e];
+        }
+        return *this;
+    }
+};
+
+static atomic<int> perfSetting(-1);   // -1 = not decided yet, else 0/1
+
+inline void setPerfEnabled(bool enabled) {
+    perfSetting = enabled ? 1 : 0;
+}
+
+inline bool perfEnabled() {
+    int setting = perfSetting.load(memory_order_relaxed);
+    if (setting < 0) {
+        const char* env = getenv("TDMS_PERF");
+        setting = (env && *env && strcmp(env, "0") != 0) ? 1 : 0;
+        perfSetting = setting;
+    }
+    return setting == 1;
+}
+
+class PerfCounters {
+private:
+    int fds[PERF_EVENT_COUNT];
+
+    PerfCounters() {
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            fds[e] = -1;
+        }
+#ifdef TDMS_HAVE_PERF
+        const uint32_t types[PERF_EVENT_COUNT] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+        };
+        const uint64_t configs[PERF_EVENT_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+        int firstError = 0;
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds[e] < 0 && firstError == 0) {
+                firstError = errno;
+            }
+        }
+        if (firstError != 0) {
+            static atomic<bool> warned(false);
+            if (!warned.exchange(true)) {
+                cout << "Some hardware counters are unavailable (" << strerror(firstError)
+                     << "): the CPU or hypervisor may not expose them, or "
+                     << "/proc/sys/kernel/perf_event_paranoid is above 2." << endl;
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator=(const PerfCounters&);
+
+public:
+    ~PerfCounters() {
+#ifdef TDMS_HAVE_PERF
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (fds[e] >= 0) ::close(fds[e]);
+        }
+#endif
+    }
+
+    // Counters for the calling thread, opened on first use
+    static PerfCounters& forThisThread() {
+        static thread_local PerfCounters counters;
+        return counters;
+    }
+
+    PerfSample read() const {
+        PerfSample sample;
+#ifdef TDMS_HAVE_PERF
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            uint64_t data[3];   // value, time enabled, time running
+            if (fds[e] >= 0 && ::read(fds[e], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] > 0) {
+                sample.available[e] = true;
+                sample.values[e] = (double)data[0] * ((double)data[1] / (double)data[2]);
+            }
+        }
+#endif
+        return sample;
+    }
+};
+
+// Reads the counters when perf instrumentation is enabled; otherwise
+// returns an empty sample.
+inline PerfSample readPerfCounters() {
+    return perfEnabled() ? PerfCounters::forThisThread().read() : PerfSample();
+}
+
+inline string formatCount(double value) {
+    const char* units[] = {"", "K", "M", "G", "T"};
+    int unit = 0;
+    while (fabs(value) >= 1000.0 && unit < 4) {
+        value /= 1000.0;
+        unit++;
+    }
+    ostringstream out;
+    out << fixed << setprecision(unit == 0 ? 0 : 2) << value << units[unit];
+    return out.str();
+}
+
+void printPerfSample(const string& label, const PerfSample& sample, long rows) {
+    if (!sample.any()) {
+        return;
+    }
+    cout << "Hardware counters (" << label << "):";
+    for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+        if (sample.available[e]) {
+            cout << (e == 0 ? " " : ", ") << formatCount(sample.values[e]) << " " << PERF_EVENT_NAMES[e];
+        }
+    }
+    cout << endl;
+    if (sample.available[PERF_CYCLES] && sample.available[PERF_INSTRUCTIONS] && sample.values[PERF_CYCLES] > 0) {
+        cout << "  IPC " << fixed << setprecision(2)
+             << sample.values[PERF_INSTRUCTIONS] / sample.values[PERF_CYCLES];
+        if (rows > 0) {
+            cout << "; per row:";
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                if (sample.available[e]) {
+                    cout << " " << sample.values[e] / rows << " " << PERF_EVENT_NAMES[e]
+                         << (e + 1 < PERF_EVENT_COUNT ? "," : "");
+                }
+            }
+        }
+        cout << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+}
+
+// Measures everything between construction and destruction and prints it
+// when instrumentation is enabled. Call setRows() to also get per-row figures.
+class PerfScope {
+private:
+    string label;
+    long rows;
+    PerfSample begin;
+
+public:
+    explicit PerfScope(const string& name, long rowCount = 0)
+        : label(name), rows(rowCount), begin(readPerfCounters()) {}
+
+    ~PerfScope() {
+        if (begin.any()) {
+            printPerfSample(label, readPerfCounters() - begin, rows);
+        }
+    }
+
+    void setRows(long rowCount) { rows = rowCount; }
+};
+
+// Query Latency Histograms
+//
+// Every interactive query records its end-to-end latency, in nanoseconds,
+// into a per (backend, operation) histogram in the style of HdrHistogram:
+// values below 256 ns get exact buckets, and above that every power of two
+// is split into 128 linear sub-buckets, so any recorded value is off by
+// less than 1% while the whole 64-bit range fits in about 7,400 counters.
+// Recording is a few relaxed atomic increments and never blocks.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 7;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;                // per power of two
+    static const int BUCKETS = (64 - SUB_BUCKET_BITS) * SUB_BUCKETS + SUB_BUCKETS;
+
+private:
+    atomic<uint64_t> counts[BUCKETS];
+    atomic<uint64_t> total;
+    atomic<uint64_t> maxValue;
+
+    static int bucketFor(uint64_t value) {
+        if (value < 2 * (uint64_t)SUB_BUCKETS) {
+            return (int)value;
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BUCKET_BITS;
+        return shift * SUB_BUCKETS + (int)(value >> shift);
+    }
+
+    // Largest value that maps to the bucket
+    static uint64_t highestInBucket(int bucket) {
+        if (bucket < 2 * SUB_BUCKETS) {
+            return (uint64_t)bucket;
+        }
+        int shift = bucket / SUB_BUCKETS - 1;
+        uint64_t sub = (uint64_t)(bucket - shift * SUB_BUCKETS);
+        return ((sub + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() : total(0), maxValue(0) {
+        for (int b = 0; b < BUCKETS; ++b) {
+            counts[b] = 0;
+        }
+    }
+
+    void record(uint64_t nanoseconds) {
+        counts[bucketFor(nanoseconds)].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+        uint64_t seen = maxValue.load(memory_order_relaxed);
+        while (nanoseconds > seen && !maxValue.compare_exchange_weak(seen, nanoseconds, memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t getCount() const { return total.load(memory_order_relaxed); }
+    uint64_t getMax() const { return maxValue.load(memory_order_relaxed); }
+
+    // Smallest recorded bucket value that at least p percent of samples
+    // are at or below, reported as the bucket's highest value (capped at
+    // the exact maximum).
+    uint64_t valueAtPercentile(double p) const {
+        uint64_t n = getCount();
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t target = (uint64_t)ceil(p / 100.0 * n);
+        target = max<uint64_t>(1, min(target, n));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b].load(memory_order_relaxed);
+            if (seen >= target) {
+                return min(highestInBucket(b), getMax());
+            }
+        }
+        return getMax();
+    }
+
+    void reset() {
+        for (int b = 0; b < BUCKETS; ++b) {
+            counts[b].store(0, memory_order_relaxed);
+        }
+        total = 0;
+        maxValue = 0;
+    }
+};
+
+class LatencyRegistry {
+private:
+    mutable mutex lock;
+    map<pair<string, string>, unique_ptr<LatencyHistogram> > histograms;
+
+public:
+    LatencyHistogram& get(const string& backend, const string& operation) {
+        lock_guard<mutex> guard(lock);
+        unique_ptr<LatencyHistogram>& slot = histograms[make_pair(backend, operation)];
+        if (!slot) {
+            slot.reset(new LatencyHistogram());
+        }
+        return *slot;
+    }
+
+    void print() const {
+        lock_guard<mutex> guard(lock);
+        if (histograms.empty()) {
+            cout << "No query latencies recorded yet." << endl;
+            return;
+        }
+        cout << "\nQuery Latency (milliseconds):" << endl;
+        cout << left << setw(13) << "Backend" << setw(18) << "Operation" << right << setw(9) << "Count"
+             << setw(11) << "p50" << setw(11) << "p90" << setw(11) << "p99" << setw(11) << "p99.9"
+             << setw(11) << "max" << endl;
+        cout << fixed << setprecision(3);
+        for (const auto& entry : histograms) {
+            const LatencyHistogram& h = *entry.second;
+            if (h.getCount() == 0) {
+                continue;   // registered but never used, e.g. a server request type
+            }
+            cout << left << setw(13) << entry.first.first << setw(18) << entry.first.second << right
+                 << setw(9) << h.getCount()
+                 << setw(11) << h.valueAtPercentile(50) / 1e6 << setw(11) << h.valueAtPercentile(90) / 1e6
+                 << setw(11) << h.valueAtPercentile(99) / 1e6 << setw(11) << h.valueAtPercentile(99.9) / 1e6
+                 << setw(11) << h.getMax() / 1e6 << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+
+    void reset() {
+        lock_guard<mutex> guard(lock);
+        for (auto& entry : histograms) {
+            entry.second->reset();
+        }
+    }
+};
+
+LatencyRegistry& latencyRegistry() {
+    static LatencyRegistry registry;
+    return registry;
+}
+
+// Records the time from construction to destruction, so early returns
+// are measured too.
+class LatencyTimer {
+private:
+    LatencyHistogram& histogram;
+    chrono::steady_clock::time_point start;
+
+public:
+    LatencyTimer(const string& backend, const string& operation)
+        : histogram(latencyRegistry().get(backend, operation)), start(chrono::steady_clock::now()) {}
+
+    ~LatencyTimer() {
+        auto elapsed = chrono::steady_clock::now() - start;
+        histogram.record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+// Epoch-Based Reclamation
+//
+// Readers (searches, displays, exports) never lock the store. They pin the
+// current epoch for the duration of an operation with an EpochGuard and
+// work on whatever version of the list they loaded. Writers (ingest, sort)
+// publish new versions with release stores and hand superseded memory to
+// retire(); it is freed only once every reader that could still see it has
+// left, i.e. after the global epoch has advanced twice past it.
+class EpochManager {
+public:
+    static const int MAX_READERS = 128;
+
+private:
+    struct ReaderSlot {
+        alignas(64) atomic<uint64_t> epoch;   // 0 while the thread is not reading
+        atomic<bool> claimed;
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        function<void()> release;
+    };
+
+    ReaderSlot slots[MAX_READERS];
+    atomic<uint64_t> globalEpoch;
+    mutex retireMutex;
+    deque<Retired> retired;
+
+    // Advances the epoch if no active reader lags behind it, then frees what
+    // is at least two epochs old. Caller holds retireMutex.
+    void collect() {
+        uint64_t current = globalEpoch.load(memory_order_seq_cst);
+        bool lagging = false;
+        for (int i = 0; i < MAX_READERS; ++i) {
+            uint64_t e = slots[i].epoch.load(memory_order_seq_cst);
+            if (e != 0 && e != current) {
+                lagging = true;
+                break;
+            }
+        }
+        if (!lagging) {
+            globalEpoch.compare_exchange_strong(current, current + 1);
+            current++;
+        }
+        while (!retired.empty() && retired.front().epoch + 2 <= current) {
+            retired.front().release();
+            retired.pop_front();
+        }
+    }
+
+public:
+    EpochManager() : globalEpoch(1) {
+        for (int i = 0; i < MAX_READERS; ++i) {
+            slots[i].epoch.store(0);
+            slots[i].claimed.store(false);
+        }
+    }
+
+    ~EpochManager() {
+        for (Retired& r : retired) {
+            r.release();
+        }
+    }
+
+    int claimSlot() {
+        while (true) {
+            for (int i = 0; i < MAX_READERS; ++i) {
+                bool expected = false;
+                if (!slots[i].claimed.load() && slots[i].claimed.compare_exchange_strong(expected, true)) {
+                    return i;
+                }
+            }
+            this_thread::yield();   // more concurrent reader threads than slots
+        }
+    }
+
+    void releaseSlot(int slot) {
+        slots[slot].epoch.store(0);
+        slots[slot].claimed.store(false);
+    }
+
+    void enter(int slot) {
+        slots[slot].epoch.store(globalEpoch.load(memory_order_seq_cst), memory_order_seq_cst);
+    }
+
+    void exit(int slot) {
+        slots[slot].epoch.store(0, memory_order_release);
+    }
+
+    void retire(function<void()> release) {
+        lock_guard<mutex> guard(retireMutex);
+        retired.push_back(Retired{globalEpoch.load(), release});
+        collect();
+    }
+
+    // Frees whatever has become safe; writers call this between batches.
+    size_t reclaim() {
+        lock_guard<mutex> guard(retireMutex);
+        collect();
+        return retired.size();
+    }
+};
+
+inline EpochManager& epochManager() {
+    static EpochManager manager;
+    return manager;
+}
+
+// Pins the current epoch for the calling thread. Guards nest; only the
+// outermost one enters and leaves the epoch.
+class EpochGuard {
+private:
+    struct ThreadSlot {
+        int slot;
+        int depth;
+        ThreadSlot() : slot(-1), depth(0) {}
+        ~ThreadSlot() {
+            if (slot >= 0) epochManager().releaseSlot(slot);
+        }
+    };
+
+    static ThreadSlot& threadSlot() {
+        static thread_local ThreadSlot local;
+        return local;
+    }
+
+public:
+    EpochGuard() {
+        ThreadSlot& local = threadSlot();
+        if (local.depth++ == 0) {
+            if (local.slot < 0) local.slot = epochManager().claimSlot();
+            epochManager().enter(local.slot);
+        }
+    }
+
+    ~EpochGuard() {
+        ThreadSlot& local = threadSlot();
+        if (--local.depth == 0) {
+            epochManager().exit(local.slot);
+        }
+    }
+};
+
+// Timestamps
+
+// Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's algorithm)
+inline int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+inline void civilFromDays(int64_t z, int& y, int& m, int& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    y = (int)(yoe + era * 400 + (m <= 2));
+}
+
+// Parses "YYYY-MM-DD HH:MM:SS" into epoch seconds. Only timestamps that
+// format back to exactly the same text are accepted.
+inline bool parseTimestamp(const char* text, size_t length, int64_t& seconds) {
+    if (length != 19 || text[4] != '-' || text[7] != '-' || text[10] != ' ' ||
+        text[13] != ':' || text[16] != ':') {
+        return false;
+    }
+    static const int digits[] = {0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18};
+    for (int i : digits) {
+        if (text[i] < '0' || text[i] > '9') return false;
+    }
+    auto number = [text](int at, int width) {
+        int value = 0;
+        for (int i = at; i < at + width; ++i) value = value * 10 + (text[i] - '0');
+        return value;
+    };
+    int year = number(0, 4), month = number(5, 2), day = number(8, 2);
+    int hour = number(11, 2), minute = number(14, 2), second = number(17, 2);
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+    static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (day > monthDays[month - 1] + (month == 2 && leap)) {
+        return false;
+    }
+    seconds = daysFromCivil(year, (unsigned)month, (unsigned)day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+inline bool parseTimestamp(const string& text, int64_t& seconds) {
+    return parseTimestamp(text.data(), text.size(), seconds);
+}
+
+inline string formatTimestamp(int64_t seconds) {
+    int64_t days = seconds / 86400;
+    int64_t rest = seconds % 86400;
+    if (rest < 0) {
+        rest += 86400;
+        days--;
+    }
+    int y, m, d;
+    civilFromDays(days, y, m, d);
+    char text[32];
+    snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d:%02d", y, m, d,
+             (int)(rest / 3600), (int)(rest % 3600 / 60), (int)(rest % 60));
+    return text;
+}
+
+// Time Windows
+//
+// Window statistics for one channel, updated as rows are added instead of
+// being recomputed. Tumbling windows are per-hour buckets for
+// the whole history and per-minute buckets in a ring covering the last
+// HISTORY seconds before the newest row. Each sender account keeps its rows
+// of the last HISTORY seconds, from which sliding windows ending at or after
+// its latest row are summed. An add is a timestamp parse, two bucket updates
+// and an amortized O(1) append/expire; only a row that arrives earlier than
+// its account's latest pays for an ordered insert.
+struct WindowBucket {
+    long count;
+    long fraud;
+    double amount;
+
+    WindowBucket() : count(0), fraud(0), amount(0) {}
+
+    void add(double value, bool isFraud) {
+        count++;
+        fraud += isFraud;
+        amount += value;
+    }
+
+    void merge(const WindowBucket& other) {
+        count += other.count;
+        fraud += other.fraud;
+        amount += other.amount;
+    }
+};
+
+class TimeWindows {
+public:
+    static const int64_t MINUTE = 60;
+    static const int64_t HOUR = 3600;
+    static const int64_t HISTORY = 86400;   // longest sliding window that can be asked for
+
+private:
+    static const int MINUTE_SLOTS = (int)(HISTORY / MINUTE);
+
+    struct AccountEvent {
+        int64_t time;
+        double amount;
+        bool fraud;
+    };
+
+    // Events in time order from first on; the expired prefix is dropped
+    // once it is as long as the live part.
+    struct AccountWindow {
+        vector<AccountEvent> events;
+        size_t first;
+        int64_t latest;
+
+        AccountWindow() : first(0), latest(numeric_limits<int64_t>::min()) {}
+    };
+
+    mutable mutex lock;
+    vector<WindowBucket> minutes;   // ring, MINUTE_SLOTS buckets ending at newestMinute
+    int64_t newestMinute;
+    unordered_map<int64_t, WindowBucket> hours;
+    unordered_map<string, AccountWindow> accounts;
+    int64_t earliest, latest;
+    long rows, unparsed;
+
+    static size_t minuteSlot(int64_t minuteStart) {
+        int64_t slot = minuteStart / MINUTE % MINUTE_SLOTS;
+        return (size_t)(slot < 0 ? slot + MINUTE_SLOTS : slot);
+    }
+
+    bool inMinuteRing(int64_t minuteStart) const {
+        return rows > 0 && minuteStart <= newestMinute && minuteStart > newestMinute - HISTORY;
+    }
+
+    void addMinute(int64_t time, double amount, bool fraud) {
+        int64_t minute = bucketStart(time, MINUTE);
+        if (rows == 0) {
+            newestMinute = minute;
+        } else if (minute > newestMinute) {
+            // Clear the slots the ring moves over; a long jump clears it all.
+            int64_t steps = min((minute - newestMinute) / MINUTE, (int64_t)MINUTE_SLOTS);
+            for (int64_t i = 1; i <= steps; ++i) {
+                minutes[minuteSlot(newestMinute + i * MINUTE)] = WindowBucket();
+            }
+            newestMinute = minute;
+        } else if (minute <= newestMinute - HISTORY) {
+            return;
+        }
+        minutes[minuteSlot(minute)].add(amount, fraud);
+    }
+
+    void addEvent(const string& account, int64_t time, double amount, bool fraud) {
+        AccountWindow& w = accounts[account];
+        if (!w.events.empty() && time <= w.latest - HISTORY) {
+            return;   // already outside every window this account can answer
+        }
+        AccountEvent event = {time, amount, fraud};
+        if (time >= w.latest) {
+            w.events.push_back(event);
+            w.latest = time;
+        } else {
+            auto later = upper_bound(w.events.begin() + w.first, w.events.end(), time,
+                                     [](int64_t t, const AccountEvent& e) { return t < e.time; });
+            w.events.insert(later, event);
+        }
+        while (w.events[w.first].time <= w.latest - HISTORY) {
+            w.first++;
+        }
+        if (w.first * 2 >= w.events.size()) {
+            w.events.erase(w.events.begin(), w.events.begin() + w.first);
+            w.first = 0;
+        }
+    }
+
+    template <typename Record>
+    void addLocked(const Record& t) {
+        static const string fraudValue = "True";
+        int64_t time;
+        if (!parseTimestamp(t.timestamp.data(), t.timestamp.size(), time)) {
+            unparsed++;
+            return;
+        }
+        bool fraud = t.is_fraud == fraudValue;
+        addMinute(time, t.amount, fraud);
+        hours[bucketStart(time, HOUR)].add(t.amount, fraud);
+        addEvent(t.sender_account, time, t.amount, fraud);
+        earliest = min(earliest, time);
+        latest = max(latest, time);
+        rows++;
+    }
+
+public:
+    static int64_t bucketStart(int64_t time, int64_t width) {
+        int64_t start = time - time % width;
+        return time % width < 0 ? start - width : start;
+    }
+
+    TimeWindows()
+        : minutes(MINUTE_SLOTS), newestMinute(0), earliest(numeric_limits<int64_t>::max()),
+          latest(numeric_limits<int64_t>::min()), rows(0), unparsed(0) {}
+
+    template <typename Record>
+    void add(const Record& t) {
+        lock_guard<mutex> hold(lock);
+        addLocked(t);
+    }
+
+    template <typename Record>
+    void addBatch(const vector<Record*>& batch) {
+        lock_guard<mutex> hold(lock);
+        for (const Record* t : batch) {
+            addLocked(*t);
+        }
+    }
+
+    // Rows with a timestamp, and the time range they cover (false if none)
+    bool range(int64_t& from, int64_t& to, long& windowed, long& skipped) const {
+        lock_guard<mutex> hold(lock);
+        from = earliest;
+        to = latest;
+        windowed = rows;
+        skipped = unparsed;
+        return rows > 0;
+    }
+
+    // count consecutive tumbling windows of width MINUTE or HOUR, the first
+    // one containing start. Minutes older than the ring come back empty.
+    vector<WindowBucket> tumbling(int64_t width, int64_t start, int count) const {
+        vector<WindowBucket> result(max(count, 0));
+        start = bucketStart(start, width);
+        lock_guard<mutex> hold(lock);
+        for (int i = 0; i < count; ++i) {
+            int64_t bucket = start + i * width;
+            if (width == MINUTE) {
+                if (inMinuteRing(bucket)) result[i] = minutes[minuteSlot(bucket)];
+            } else {
+                auto found = hours.find(bucket);
+                if (found != hours.end()) result[i] = found->second;
+            }
+        }
+        return result;
+    }
+
+    // Rows in (end - seconds, end], to minute resolution: every minute
+    // bucket that starts inside the window counts.
+    WindowBucket sliding(int64_t end, int64_t seconds) const {
+        WindowBucket total;
+        lock_guard<mutex> hold(lock);
+        for (int64_t start = bucketStart(end, MINUTE); start > end - seconds; start -= MINUTE) {
+            if (inMinuteRing(start)) {
+                total.merge(minutes[minuteSlot(start)]);
+            }
+        }
+        return total;
+    }
+
+    // Latest row time of an account (false if it has no rows here)
+    bool accountLatest(const string& account, int64_t& time) const {
+        lock_guard<mutex> hold(lock);
+        auto found = accounts.find(account);
+        if (found == accounts.end()) {
+            return false;
+        }
+        time = found->second.latest;
+        return true;
+    }
+
+    // An account's rows in (end - seconds, end], exactly. end must not be
+    // earlier than the account's latest row and seconds at most HISTORY.
+    WindowBucket accountWindow(const string& account, int64_t end, int64_t seconds) const {
+        WindowBucket total;
+        lock_guard<mutex> hold(lock);
+        auto found = accounts.find(account);
+        if (found == accounts.end()) {
+            return total;
+        }
+        const AccountWindow& w = found->second;
+        for (size_t i = w.events.size(); i > w.first && w.events[i - 1].time > end - seconds; --i) {
+            if (w.events[i - 1].time <= end) {
+                total.add(w.events[i - 1].amount, w.events[i - 1].fraud);
+            }
+        }
+        return total;
+    }
+
+    // The n accounts with the most rows in the window of the given length
+    // that ends at each account's own latest row
+    vector<pair<string, WindowBucket> > busiestAccounts(int64_t seconds, size_t n) const {
+        vector<pair<string, WindowBucket> > result;
+        lock_guard<mutex> hold(lock);
+        for (const auto& entry : accounts) {
+            const AccountWindow& w = entry.second;
+            WindowBucket total;
+            for (size_t i = w.events.size(); i > w.first && w.events[i - 1].time > w.latest - seconds; --i) {
+                total.add(w.events[i - 1].amount, w.events[i - 1].fraud);
+            }
+            if (total.count > 0) {
+                result.push_back(make_pair(entry.first, total));
+            }
+        }
+        auto busier = [](const pair<string, WindowBucket>& a, const pair<string, WindowBucket>& b) {
+            return a.second.count != b.second.count ? a.second.count > b.second.count : a.first < b.first;
+        };
+        if (result.size() > n) {
+            partial_sort(result.begin(), result.begin() + n, result.end(), busier);
+            result.resize(n);
+        } else {
+            sort(result.begin(), result.end(), busier);
+        }
+        return result;
+    }
+
+    // Hash nodes and bucket arrays are estimated from their element counts
+    void accountMemory(MemoryBreakdown& m) const {
+        lock_guard<mutex> hold(lock);
+        const size_t node = 2 * sizeof(void*);
+        m.indexes += heapBlockBytes(minutes.data());
+        m.indexes += hours.size() * (sizeof(pair<int64_t, WindowBucket>) + node) + hours.bucket_count() * sizeof(void*);
+        m.indexes += accounts.size() * (sizeof(pair<string, AccountWindow>) + node) +
+                     accounts.bucket_count() * sizeof(void*);
+        for (const auto& entry : accounts) {
+            m.indexes += stringHeapBytes(entry.first);
+            if (entry.second.events.capacity() > 0) {
+                m.indexes += heapBlockBytes(entry.second.events.data());
+            }
+        }
+    }
+};
+
+// Quantile Sketches
+//
+// A merging t-digest (Dunning & Ertl): values collect in a buffer that is
+// sorted into the centroid list whenever it fills, with each centroid's
+// weight bounded by the arcsine scale function so that centroids near the
+// tails stay small and tail quantiles stay accurate. Two digests merge by
+// pooling their centroids and compressing again, so digests built over
+// separate channels or separate chunks of rows combine into one.
+class TDigest {
+public:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+private:
+    double compression;
+    vector<Centroid> centroids;   // sorted by mean
+    vector<Centroid> buffer;      // not yet merged
+    double total;                 // weight of centroids and buffer
+    double minimum, maximum;
+
+    double scale(double q) const { return compression / (2 * M_PI) * asin(2 * q - 1); }
+
+    double scaleInverse(double k) const {
+        if (k >= compression / 4) return 1.0;
+        return (sin(k * 2 * M_PI / compression) + 1) / 2;
+    }
+
+public:
+    explicit TDigest(double delta = 100)
+        : compression(delta), total(0), minimum(numeric_limits<double>::infinity()),
+          maximum(-numeric_limits<double>::infinity()) {}
+
+    void add(double value, double weight = 1) {
+        if (std::isnan(value)) {
+            return;
+        }
+        buffer.push_back(Centroid{value, weight});
+        total += weight;
+        minimum = min(minimum, value);
+        maximum = max(maximum, value);
+        if (buffer.size() >= (size_t)(10 * compression)) {
+            compress();
+        }
+    }
+
+    void merge(const TDigest& other) {
+        if (other.total == 0) {
+            return;
+        }
+        buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+        buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+        total += other.total;
+        minimum = min(minimum, other.minimum);
+        maximum = max(maximum, other.maximum);
+        compress();
+    }
+
+    void compress() {
+        if (buffer.empty()) {
+            return;
+        }
+        auto byMean = [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; };
+        sort(buffer.begin(), buffer.end(), byMean);
+        size_t added = buffer.size();
+        buffer.insert(buffer.end(), centroids.begin(), centroids.end());   // already sorted
+        inplace_merge(buffer.begin(), buffer.begin() + added, buffer.end(), byMean);
+        centroids.clear();
+        Centroid current = buffer.front();
+        double before = 0;   // weight left of current
+        double limit = total * scaleInverse(scale(0) + 1);
+        for (size_t i = 1; i < buffer.size(); ++i) {
+            const Centroid& next = buffer[i];
+            if (before + current.weight + next.weight <= limit) {
+                current.weight += next.weight;
+                current.mean += (next.mean - current.mean) * next.weight / current.weight;
+            } else {
+                before += current.weight;
+                centroids.push_back(current);
+                current = next;
+                limit = total * scaleInverse(scale(before / total) + 1);
+            }
+        }
+        centroids.push_back(current);
+        buffer.clear();
+    }
+
+    double count() const { return total; }
+    double smallest() const { return minimum; }
+    double largest() const { return maximum; }
+
+    // Interpolates between centroid centers; the outermost half-centroids
+    // interpolate towards the exact minimum and maximum.
+    double quantile(double q) {
+        compress();
+        if (centroids.empty()) {
+            return numeric_limits<double>::quiet_NaN();
+        }
+        if (centroids.size() == 1) {
+            return centroids[0].mean;
+        }
+        double target = min(max(q, 0.0), 1.0) * total;
+        const Centroid& first = centroids.front();
+        if (target < first.weight / 2) {
+            return minimum + (first.mean - minimum) * target / (first.weight / 2);
+        }
+        const Centroid& last = centroids.back();
+        if (target > total - last.weight / 2) {
+            return last.mean + (maximum - last.mean) * (target - (total - last.weight / 2)) / (last.weight / 2);
+        }
+        double center = first.weight / 2;   // cumulative weight at the current centroid's center
+        for (size_t i = 0; i + 1 < centroids.size(); ++i) {
+            double gap = (centroids[i].weight + centroids[i + 1].weight) / 2;
+            if (target <= center + gap) {
+                return centroids[i].mean + (centroids[i + 1].mean - centroids[i].mean) * (target - center) / gap;
+            }
+            center += gap;
+        }
+        return last.mean;
+    }
+
+    size_t memoryBytes() const {
+        return (centroids.capacity() ? heapBlockBytes(centroids.data()) : 0) +
+               (buffer.capacity() ? heapBlockBytes(buffer.data()) : 0);
+    }
+};
+
+enum SketchMetric {
+    SKETCH_AMOUNT = 0,
+    SKETCH_SPENDING_DEVIATION = 1,
+    SKETCH_GEO_ANOMALY = 2,
+    SKETCH_COUNT = 3
+};
+
+static const char* const sketchMetricNames[SKETCH_COUNT] = {"amount", "spending_deviation", "geo_anomaly"};
+
+// One t-digest per metric and location for a channel
+class QuantileSketches {
+public:
+    struct LocationDigests {
+        TDigest metrics[SKETCH_COUNT];
+    };
+
+private:
+    mutable mutex lock;
+    unordered_map<string, LocationDigests> locations;
+
+    template <typename Record>
+    void addLocked(const Record& t) {
+        LocationDigests& d = locations[t.location];
+        d.metrics[SKETCH_AMOUNT].add(t.amount);
+        d.metrics[SKETCH_SPENDING_DEVIATION].add(t.spending_deviation_score);
+        d.metrics[SKETCH_GEO_ANOMALY].add(t.geo_anomaly_score);
+    }
+
+public:
+    template <typename Record>
+    void add(const Record& t) {
+        lock_guard<mutex> hold(lock);
+        addLocked(t);
+    }
+
+    template <typename Record>
+    void addBatch(const vector<Record*>& batch) {
+        lock_guard<mutex> hold(lock);
+        for (const Record* t : batch) {
+            addLocked(*t);
+        }
+    }
+
+    // Folds another channel's or chunk's digests into these
+    void merge(const QuantileSketches& other) {
+        if (&other == this) {
+            return;
+        }
+        unordered_map<string, LocationDigests> copy;
+        {
+            lock_guard<mutex> hold(other.lock);
+            copy = other.locations;
+        }
+        lock_guard<mutex> hold(lock);
+        for (const auto& entry : copy) {
+            LocationDigests& d = locations[entry.first];
+            for (int m = 0; m < SKETCH_COUNT; ++m) {
+                d.metrics[m].merge(entry.second.metrics[m]);
+            }
+        }
+    }
+
+    // A copy of the digests keyed by location; the caller merges what it needs
+    map<string, LocationDigests> snapshot() const {
+        lock_guard<mutex> hold(lock);
+        return map<string, LocationDigests>(locations.begin(), locations.end());
+    }
+
+    void accountMemory(MemoryBreakdown& m) const {
+        lock_guard<mutex> hold(lock);
+        m.indexes += locations.size() * (sizeof(pair<string, LocationDigests>) + 2 * sizeof(void*)) +
+                     locations.bucket_count() * sizeof(void*);
+        for (const auto& entry : locations) {
+            m.indexes += stringHeapBytes(entry.first);
+            for (int metric = 0; metric < SKETCH_COUNT; ++metric) {
+                m.indexes += entry.second.metrics[metric].memoryBytes();
+            }
+        }
+    }
+};
+
+// Distinct Counts
+//
+// 64-bit FNV-1a finished with the MurmurHash3 mixer, which FNV needs before
+// its top bits are usable as a HyperLogLog register index.
+inline uint64_t hashBytes(const char* data, size_t length) {
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < length; ++i) {
+        h = (h ^ (unsigned char)data[i]) * 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// HyperLogLog (Flajolet et al.) over 64-bit hashes: 2^precision one-byte
+// registers and a standard error of 1.04 / sqrt(2^precision). Estimates use
+// Ertl's improved estimator ("New cardinality estimation algorithms for
+// HyperLogLog sketches", 2017), which is unbiased from small counts up
+// without bias tables; the classic switch between linear counting and the
+// raw estimate at 2.5m is off by several percent up to about 5m. A sketch
+// starts sparse, storing only touched registers as index << 8 | rank, and
+// switches to the dense array once that would no longer be smaller, so the
+// many small per-group sketches stay a few hundred bytes.
+class HyperLogLog {
+private:
+    int precision;
+    vector<uint8_t> registers;   // dense form; empty while sparse
+    vector<uint32_t> sparse;     // may hold duplicates until compacted
+
+    size_t size() const { return (size_t)1 << precision; }
+
+    void compact() {
+        sort(sparse.begin(), sparse.end());
+        size_t out = 0;
+        for (size_t i = 0; i < sparse.size(); ++i) {
+            // Sorted by index then rank, so the last entry of an index wins
+            if (out > 0 && (sparse[out - 1] >> 8) == (sparse[i] >> 8)) {
+                sparse[out - 1] = sparse[i];
+            } else {
+                sparse[out++] = sparse[i];
+            }
+        }
+        sparse.resize(out);
+        if (out * sizeof(uint32_t) * 2 > size()) {
+            toDense();
+        }
+    }
+
+    void toDense() {
+        registers.assign(size(), 0);
+        for (uint32_t entry : sparse) {
+            registers[entry >> 8] = max(registers[entry >> 8], (uint8_t)(entry & 0xff));
+        }
+        vector<uint32_t>().swap(sparse);
+    }
+
+public:
+    explicit HyperLogLog(int p = 12) : precision(p) {}
+
+    void add(uint64_t hash) {
+        uint32_t index = (uint32_t)(hash >> (64 - precision));
+        uint8_t rank = (uint8_t)(__builtin_clzll((hash << precision) | (1ULL << (precision - 1))) + 1);
+        if (!registers.empty()) {
+            registers[index] = max(registers[index], rank);
+            return;
+        }
+        sparse.push_back(index << 8 | rank);
+        if (sparse.size() * sizeof(uint32_t) >= size()) {
+            compact();
+        }
+    }
+
+    // Both sketches must have the same precision
+    void merge(const HyperLogLog& other) {
+        if (!other.registers.empty()) {
+            if (registers.empty()) toDense();
+            for (size_t i = 0; i < registers.size(); ++i) {
+                registers[i] = max(registers[i], other.registers[i]);
+            }
+        } else if (!registers.empty()) {
+            for (uint32_t entry : other.sparse) {
+                registers[entry >> 8] = max(registers[entry >> 8], (uint8_t)(entry & 0xff));
+            }
+        } else {
+            sparse.insert(sparse.end(), other.sparse.begin(), other.sparse.end());
+            compact();
+        }
+    }
+
+    // The sum over registers of 2^-rank, rewritten in terms of how many
+    // registers hold each rank: sigma corrects for the empty registers and
+    // tau for the saturated ones (rank q + 1)
+    static double sigma(double x) {
+        if (x == 1) {
+            return numeric_limits<double>::infinity();
+        }
+        double y = 1, z = x, previous;
+        do {
+            x *= x;
+            previous = z;
+            z += x * y;
+            y += y;
+        } while (z != previous);
+        return z;
+    }
+
+    static double tau(double x) {
+        if (x == 0 || x == 1) {
+            return 0;
+        }
+        double y = 1, z = 1 - x, previous;
+        do {
+            x = sqrt(x);
+            previous = z;
+            y *= 0.5;
+            z -= (1 - x) * (1 - x) * y;
+        } while (z != previous);
+        return z / 3;
+    }
+
+    double estimate() const {
+        const int q = 64 - precision;   // ranks run from 0 to q + 1
+        const double m = (double)size();
+        vector<double> ranks(q + 2, 0);
+        if (!registers.empty()) {
+            for (uint8_t r : registers) ranks[r]++;
+        } else {
+            HyperLogLog dense(*this);
+            dense.toDense();
+            for (uint8_t r : dense.registers) ranks[r]++;
+        }
+        if (ranks[0] == m) {
+            return 0;
+        }
+        double z = m * tau(1 - ranks[q + 1] / m);
+        for (int k = q; k >= 1; --k) {
+            z = 0.5 * (z + ranks[k]);
+        }
+        z += m * sigma(ranks[0] / m);
+        return m * m / (2 * log(2.0) * z);
+    }
+
+    size_t memoryBytes() const {
+        return (registers.capacity() ? heapBlockBytes(registers.data()) : 0) +
+               (sparse.capacity() ? heapBlockBytes(sparse.data()) : 0);
+    }
+};
+
+enum DistinctField {
+    DISTINCT_SENDER = 0,
+    DISTINCT_IP = 1,
+    DISTINCT_DEVICE = 2,
+    DISTINCT_COUNT = 3
+};
+
+// HyperLogLog sketches of sender_account, ip_address and device_hash for
+// one channel, overall and per location and per day
+class DistinctSketches {
+public:
+    static const int TOTAL_PRECISION = 14;   // 0.8% standard error
+    static const int GROUP_PRECISION = 12;   // 1.6%
+
+    struct FieldSketches {
+        HyperLogLog fields[DISTINCT_COUNT];
+
+        explicit FieldSketches(int precision = GROUP_PRECISION) {
+            for (int f = 0; f < DISTINCT_COUNT; ++f) fields[f] = HyperLogLog(precision);
+        }
+
+        void merge(const FieldSketches& other) {
+            for (int f = 0; f < DISTINCT_COUNT; ++f) fields[f].merge(other.fields[f]);
+        }
+
+        size_t memoryBytes() const {
+            size_t bytes = 0;
+            for (int f = 0; f < DISTINCT_COUNT; ++f) bytes += fields[f].memoryBytes();
+            return bytes;
+        }
+    };
+
+private:
+    mutable mutex lock;
+    FieldSketches total;
+    unordered_map<string, FieldSketches> locations;
+    unordered_map<string, FieldSketches> days;   // keyed by "YYYY-MM-DD"
+
+    template <typename Record>
+    void addLocked(const Record& t) {
+        uint64_t hashes[DISTINCT_COUNT] = {hashBytes(t.sender_account.data(), t.sender_account.size()),
+                                           hashBytes(t.ip_address.data(), t.ip_address.size()),
+                                           hashBytes(t.device_hash.data(), t.device_hash.size())};
+        FieldSketches& location = locations[t.location];
+        FieldSketches& day = days[string(t.timestamp.data(), min(t.timestamp.size(), (size_t)10))];
+        for (int f = 0; f < DISTINCT_COUNT; ++f) {
+            total.fields[f].add(hashes[f]);
+            location.fields[f].add(hashes[f]);
+            day.fields[f].add(hashes[f]);
+        }
+    }
+
+public:
+    DistinctSketches() : total(TOTAL_PRECISION) {}
+
+    template <typename Record>
+    void add(const Record& t) {
+        lock_guard<mutex> hold(lock);
+        addLocked(t);
+    }
+
+    template <typename Record>
+    void addBatch(const vector<Record*>& batch) {
+        lock_guard<mutex> hold(lock);
+        for (const Record* t : batch) {
+            addLocked(*t);
+        }
+    }
+
+    // Folds another channel's or chunk's sketches into these
+    void merge(const DistinctSketches& other) {
+        if (&other == this) {
+            return;
+        }
+        FieldSketches otherTotal;
+        unordered_map<string, FieldSketches> otherLocations, otherDays;
+        {
+            lock_guard<mutex> hold(other.lock);
+            otherTotal = other.total;
+            otherLocations = other.locations;
+            otherDays = other.days;
+        }
+        lock_guard<mutex> hold(lock);
+        total.merge(otherTotal);
+        for (const auto& entry : otherLocations) locations[entry.first].merge(entry.second);
+        for (const auto& entry : otherDays) days[entry.first].merge(entry.second);
+    }
+
+    FieldSketches channelTotal() const {
+        lock_guard<mutex> hold(lock);
+        return total;
+    }
+
+    // Copies of the per-location or per-day sketches, in key order
+    map<string, FieldSketches> groups(bool byDay) const {
+        lock_guard<mutex> hold(lock);
+        const unordered_map<string, FieldSketches>& source = byDay ? days : locations;
+        return map<string, FieldSketches>(source.begin(), source.end());
+    }
+
+    void accountMemory(MemoryBreakdown& m) const {
+        lock_guard<mutex> hold(lock);
+        m.indexes += total.memoryBytes();
+        for (const unordered_map<string, FieldSketches>* groups : {&locations, &days}) {
+            m.indexes += groups->size() * (sizeof(pair<string, FieldSketches>) + 2 * sizeof(void*)) +
+                         groups->bucket_count() * sizeof(void*);
+            for (const auto& entry : *groups) {
+                m.indexes += stringHeapBytes(entry.first) + entry.second.memoryBytes();
+            }
+        }
+    }
+};
+
+// Statistics for the appendable lists, built on first use instead of on
+// every add, so an import that never asks for them pays nothing. Once
+// built they are kept current: each request first folds in the rows added
+// since the previous one. The list hands those over with
+// rowsSince(mark, rows), where mark records how far the last call got.
+// Sketches merge, so a large catch-up (the first one after an import) is
+// split into chunks across threads, like the snapshot's buildInChunks.
+template <typename Record, typename Mark>
+class ListStats {
+private:
+    template <typename Stats>
+    struct Slot {
+        unique_ptr<Stats> built;
+        Mark seen;
+
+        Slot() : seen() {}
+    };
+
+    mutable mutex lock;
+    mutable Slot<TimeWindows> windows;
+    mutable Slot<QuantileSketches> sketches;
+    mutable Slot<DistinctSketches> distinct;
+
+    static void add(TimeWindows& built, const vector<const Record*>& rows) {
+        built.addBatch(rows);
+    }
+
+    template <typename Sketches>
+    static void add(Sketches& built, const vector<const Record*>& rows) {
+        const size_t minChunk = 65536;
+        size_t chunks = max((size_t)1, min((size_t)thread::hardware_concurrency(), rows.size() / minChunk));
+        if (chunks == 1) {
+            built.addBatch(rows);
+            return;
+        }
+        unique_ptr<Sketches[]> parts(new Sketches[chunks]);
+        vector<thread> threads;
+        for (size_t k = 0; k < chunks; ++k) {
+            threads.emplace_back([&rows, &parts, k, chunks]() {
+                size_t end = rows.size() * (k + 1) / chunks;
+                for (size_t i = rows.size() * k / chunks; i < end; ++i) {
+                    parts[k].add(*rows[i]);
+                }
+            });
+        }
+        for (size_t k = 0; k < chunks; ++k) {
+            threads[k].join();
+            built.merge(parts[k]);
+        }
+    }
+
+    template <typename List, typename Stats>
+    static void refresh(const List& list, Slot<Stats>& slot) {
+        if (!slot.built) {
+            slot.built.reset(new Stats());
+        }
+        vector<const Record*> rows;
+        slot.seen = list.rowsSince(slot.seen, rows);
+        add(*slot.built, rows);
+    }
+
+public:
+    template <typename List>
+    const TimeWindows& timeWindows(const List& list) const {
+        lock_guard<mutex> hold(lock);
+        refresh(list, windows);
+        return *windows.built;
+    }
+
+    template <typename List>
+    const QuantileSketches& quantileSketches(const List& list) const {
+        lock_guard<mutex> hold(lock);
+        refresh(list, sketches);
+        return *sketches.built;
+    }
+
+    template <typename List>
+    const DistinctSketches& distinctSketches(const List& list) const {
+        lock_guard<mutex> hold(lock);
+        refresh(list, distinct);
+        return *distinct.built;
+    }
+
+    // Drops everything built so far, for a list whose rows were reordered.
+    // Like the reordering itself, this never runs alongside a reader.
+    void reset() {
+        lock_guard<mutex> hold(lock);
+        windows = Slot<TimeWindows>();
+        sketches = Slot<QuantileSketches>();
+        distinct = Slot<DistinctSketches>();
+    }
+
+    void accountMemory(MemoryBreakdown& m) const {
+        lock_guard<mutex> hold(lock);
+        if (windows.built) {
+            windows.built->accountMemory(m);
+        }
+        if (sketches.built) {
+            sketches.built->accountMemory(m);
+        }
+        if (distinct.built) {
+            distinct.built->accountMemory(m);
+        }
+    }
+};
+
+// Linked List Implementation
+struct Transaction {
+    string transaction_id, timestamp, sender_account, receiver_account;
+    double amount;
+    string transaction_type, merchant_category, location, device_used, is_fraud, fraud_type;
+    double time_since_last_transaction, spending_deviation_score, geo_anomaly_score;
+    int velocity_score;
+    uint32_t rule_hits;   // bit r is set when fraud rule r matched on import
+    string payment_channel, ip_address, device_hash;
+    Transaction* next;
+
+    Transaction() : rule_hits(0), next(nullptr) {}
+};
+
+class TransactionList {
+public:
+    typedef Transaction Record;
+
+private:
+    // Published nodes are never modified, so a reader that loads head sees
+    // a consistent list. Writers must hold the store lock.
+    atomic<Transaction*> head;
+    atomic<int> count;
+    atomic<unsigned> generation;   // bumped when nodes are replaced
+    ListStats<Transaction, const Transaction*> stats;
+
+public:
+    TransactionList() : head(nullptr), count(0), generation(0) {}
+
+    ~TransactionList() {
+        Transaction* current = head.load();
+        while (current) {
+            Transaction* temp = current;
+            current = current->next;
+            delete temp;
+        }
+    }
+
+    void addTransaction(Transaction* newTrans) {
+        newTrans->next = head.load(memory_order_relaxed);
+        head.store(newTrans, memory_order_release);
+        count.fetch_add(1, memory_order_release);
+    }
+
+    // Links the batch in the same order repeated addTransaction calls
+    // would, then publishes it with a single store so readers see all of
+    // it or none of it.
+    void addBatch(const vector<Transaction*>& batch) {
+        if (batch.empty()) {
+            return;
+        }
+        batch.front()->next = head.load(memory_order_relaxed);
+        for (size_t i = 1; i < batch.size(); ++i) {
+            batch[i]->next = batch[i - 1];
+        }
+        head.store(batch.back(), memory_order_release);
+        count.fetch_add((int)batch.size(), memory_order_release);
+    }
+
+    // One transaction as displayTransactions shows it, numbered
+    static void displayTransaction(const Transaction& t, int number) {
+        cout << "===== Transaction " << number << " =====" << endl;
+        cout << "ID: " << t.transaction_id << endl;
+        cout << "Timestamp: " << t.timestamp << endl;
+        cout << "Sender: " << t.sender_account << endl;
+        cout << "Receiver: " << t.receiver_account << endl;
+        cout << "Amount: " << t.amount << endl;
+        cout << "Type: " << t.transaction_type << endl;
+        cout << "Merchant: " << t.merchant_category << endl;
+        cout << "Location: " << t.location << endl;
+        cout << "Device: " << t.device_used << endl;
+        cout << "Is Fraud: " << t.is_fraud << endl;
+        cout << "Fraud Type: " << t.fraud_type << endl;
+        cout << "Time Since Last: " << t.time_since_last_transaction << endl;
+        cout << "Spending Deviation: " << t.spending_deviation_score << endl;
+        cout << "Velocity: " << t.velocity_score << endl;
+        cout << "Geo Anomaly: " << t.geo_anomaly_score << endl;
+        cout << "Payment Channel: " << t.payment_channel << endl;
+        cout << "IP: " << t.ip_address << endl;
+        cout << "Device Hash: " << t.device_hash << endl << endl;
+    }
+
+    void displayTransactions(int limit) {
+        EpochGuard guard;
+        Transaction* current = head.load(memory_order_acquire);
+        if (current == nullptr) {
+            cout << "No transactions to display." << endl;
+            return;
+        }
+
+        int displayed = 0;
+        while (current && (limit == -1 || displayed < limit)) {
+            displayTransaction(*current, displayed + 1);
+            current = current->next;
+            displayed++;
+        }
+
+        if (limit != -1 && displayed < getCount()) {
+            cout << "Displaying " << displayed << " of " << getCount() << " transactions." << endl;
+        }
+    }
+
+    // A writer operation: readers may still be walking the current nodes,
+    // so the list is sorted as a copy that replaces it, and the old nodes
+    // are retired once those readers are done.
+    void sortByLocation() {
+        Transaction* oldHead = head.load(memory_order_acquire);
+        if (oldHead == nullptr || oldHead->next == nullptr) {
+            cout << "No transactions to sort or already sorted." << endl;
+            return;
+        }
+
+        cout << "Sorting transactions by location (merge sort)..." << endl;
+        PerfScope perf("sortByLocation", getCount());
+        auto start = chrono::high_resolution_clock::now();
+
+        // The node pointers are merge sorted (stable_sort), then the nodes
+        // are copied in that order into a new list, so readers still walking
+        // the old nodes see them unchanged until they are retired.
+        vector<const Transaction*> nodes;
+        nodes.reserve(getCount());
+        for (const Transaction* current = oldHead; current; current = current->next) {
+            nodes.push_back(current);
+        }
+        stable_sort(nodes.begin(), nodes.end(), [](const Transaction* a, const Transaction* b) {
+            return a->location < b->location;
+        });
+        Transaction copyHead;
+        Transaction* tail = &copyHead;
+        for (const Transaction* node : nodes) {
+            tail->next = new Transaction(*node);
+            tail = tail->next;
+        }
+        tail->next = nullptr;
+
+        head.store(copyHead.next, memory_order_release);
+        generation.fetch_add(1, memory_order_release);
+        epochManager().retire([oldHead]() {
+            Transaction* current = oldHead;
+            while (current) {
+                Transaction* temp = current;
+                current = current->next;
+                delete temp;
+            }
+        });
+        stats.reset();   // rowsSince finds new rows by their place in the list
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+        cout << "Successfully sorted " << getCount() << " transactions by location in " 
+             << elapsed.count() << " seconds." << endl;
+    }
+
+    void searchByTransactionType(const string& type) {
+        LatencyTimer latency("Linked List", "type search");
+        EpochGuard guard;
+        Transaction* current = head.load(memory_order_acquire);
+        if (current == nullptr) {
+            cout << "No transactions to search." << endl;
+            return;
+        }
+
+        int found = 0;
+        while (current) {
+            if (current->transaction_type == type) {
+                cout << "===== Match " << (found + 1) << " =====" << endl;
+                cout << "ID: " << current->transaction_id << endl;
+                cout << "Date: " << current->timestamp << endl;
+                cout << "Amount: " << current->amount << endl;
+                cout << "Location: " << current->location << endl;
+                cout << "Payment Channel: " << current->payment_channel << endl;
+                found++;
+            }
+            current = current->next;
+        }
+
+        if (found == 0) {
+            cout << "No transactions found with type: " << type << endl;
+        } else {
+            cout << "Found " << found << " matching transactions." << endl;
+        }
+    }
+
+    int countMatches(const string& query, const string& field) const {
+        EpochGuard guard;
+        Transaction* current = head.load(memory_order_acquire);
+        int found = 0;
+
+        while (current) {
+            if (field == "type" && current->transaction_type == query) {
+                found++;
+            } else if (field == "location" && current->location == query) {
+                found++;
+            } else if (field == "fraud" && current->is_fraud == query) {
+                found++;
+            }
+            current = current->next;
+        }
+        return found;
+    }
+
+    void linearSearch(const string& query, const string& field) {
+        LatencyTimer latency("Linked List", "linear search");
+        if (head.load(memory_order_acquire) == nullptr) {
+            cout << "No transactions to search." << endl;
+            return;
+        }
+
+        PerfScope perf("linearSearch", getCount());
+        auto start = chrono::high_resolution_clock::now();
+        int found = countMatches(query, field);
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+
+        cout << "\nLinear Search Results for " << field << " = " << query << ":" << endl;
+        cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+    }
+
+    bool binarySearch(const string& query, const string& field) {
+        LatencyTimer latency("Linked List", "binary search");
+        EpochGuard guard;
+        Transaction* first = head.load(memory_order_acquire);
+        if (first == nullptr) {
+            cout << "No transactions to search." << endl;
+            return false;
+        }
+
+        // Convert linked list to array for binary search
+        vector<Transaction*> nodes;
+        for (Transaction* current = first; current; current = current->next) {
+            nodes.push_back(current);
+        }
+        int total = (int)nodes.size();
+        Transaction** arr = nodes.data();
+
+        // Sort the array based on the search field
+        if (field == "type") {
+            sort(arr, arr + total, [](Transaction* a, Transaction* b) {
+                return a->transaction_type < b->transaction_type;
+            });
+        } else if (field == "location") {
+            sort(arr, arr + total, [](Transaction* a, Transaction* b) {
+                return a->location < b->location;
+            });
+        }
+
+        PerfScope perf("binarySearch");
+        auto start = chrono::high_resolution_clock::now();
+
+        // Perform binary search
+        int left = 0, right = total - 1;
+        int found = 0;
+
+        while (left <= right) {
+            int mid = left + (right - left) / 2;
+
+            if (field == "type" && arr[mid]->transaction_type == query) {
+                // Count all matching occurrences (since there may be duplicates)
+                found = 1;
+                // Check left side
+                int left_ptr = mid - 1;
+                while (left_ptr >= 0 && arr[left_ptr]->transaction_type == query) {
+                    found++;
+                    left_ptr--;
+                }
+                // Check right side
+                int right_ptr = mid + 1;
+                while (right_ptr < total && arr[right_ptr]->transaction_type == query) {
+                    found++;
+                    right_ptr++;
+                }
+                break;
+            } else if (field == "location" && arr[mid]->location == query) {
+                found = 1;
+                int left_ptr = mid - 1;
+                while (left_ptr >= 0 && arr[left_ptr]->location == query) {
+                    found++;
+                    left_ptr--;
+                }
+                int right_ptr = mid + 1;
+                while (right_ptr < total && arr[right_ptr]->location == query) {
+                    found++;
+                    right_ptr++;
+                }
+                break;
+            }
+            
+            string fieldValue;
+            if (field == "type") {
+                fieldValue = arr[mid]->transaction_type;
+            } else if (field == "location") {
+                fieldValue = arr[mid]->location;
+            }
+            
+            if (fieldValue < query) {
+                left = mid + 1;
+            } else {
+                right = mid - 1;
+            }
+        }
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+
+        cout << "\nBinary Search Results for " << field << " = " << query << ":" << endl;
+        if (found > 0) {
+            cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+        } else {
+            cout << "No matches found in " << elapsed.count() << " seconds" << endl;
+        }
+
+        return found > 0;
+    }
+
+    bool exportToJSON(const string& filename) {
+        ofstream outFile(filename);
+        if (!outFile.is_open()) {
+            cout << "Failed to open file for writing: " << filename << endl;
+            return false;
+        }
+
+        EpochGuard guard;
+        outFile << "[\n";
+        Transaction* current = head.load(memory_order_acquire);
+        bool first = true;
+        int exported = 0;
+
+        while (current) {
+            if (!first) {
+                outFile << ",\n";
+            }
+            first = false;
+
+            outFile << "  {\n";
+            outFile << "    \"transaction_id\": \"" << current->transaction_id << "\",\n";
+            outFile << "    \"timestamp\": \"" << current->timestamp << "\",\n";
+            outFile << "    \"sender_account\": \"" << current->sender_account << "\",\n";
+            outFile << "    \"receiver_account\": \"" << current->receiver_account << "\",\n";
+            outFile << "    \"amount\": " << current->amount << ",\n";
+            outFile << "    \"transaction_type\": \"" << current->transaction_type << "\",\n";
+            outFile << "    \"merchant_category\": \"" << current->merchant_category << "\",\n";
+            outFile << "    \"location\": \"" << current->location << "\",\n";
+            outFile << "    \"device_used\": \"" << current->device_used << "\",\n";
+            outFile << "    \"is_fraud\": \"" << current->is_fraud << "\",\n";
+            outFile << "    \"fraud_type\": \"" << current->fraud_type << "\",\n";
+            outFile << "    \"time_since_last_transaction\": " << current->time_since_last_transaction << ",\n";
+            outFile << "    \"spending_deviation_score\": " << current->spending_deviation_score << ",\n";
+            outFile << "    \"velocity_score\": " << current->velocity_score << ",\n";
+            outFile << "    \"geo_anomaly_score\": " << current->geo_anomaly_score << ",\n";
+            outFile << "    \"payment_channel\": \"" << current->payment_channel << "\",\n";
+            outFile << "    \"ip_address\": \"" << current->ip_address << "\",\n";
+            outFile << "    \"device_hash\": \"" << current->device_hash << "\"\n";
+            outFile << "  }";
+
+            current = current->next;
+            exported++;
+        }
+
+        outFile << "\n]";
+        outFile.close();
+        if (outFile.fail()) {
+            cout << "Failed to write " << filename << endl;
+            return false;
+        }
+        cout << "Successfully exported " << exported << " transactions to " << filename << endl;
+        return true;
+    }
+
+    // A version of the list pinned at the moment it is taken. Use it (inside
+    // an EpochGuard) when several passes must see the same rows.
+    class View {
+    private:
+        Transaction* first;
+
+    public:
+        explicit View(Transaction* head) : first(head) {}
+
+        template <typename Func>
+        void forEach(Func func) const {
+            for (Transaction* current = first; current; current = current->next) {
+                func(*current);
+            }
+        }
+
+        int getCount() const {
+            int n = 0;
+            for (Transaction* current = first; current; current = current->next) n++;
+            return n;
+        }
+    };
+
+    View view() const { return View(head.load(memory_order_acquire)); }
+
+    template <typename Func>
+    void forEach(Func func) const {
+        EpochGuard guard;
+        view().forEach(func);
+    }
+
+    int getCount() const { return count.load(memory_order_acquire); }
+
+    // Row references for indexes built over the list. rowGeneration()
+    // changes when the rows are reordered; until then an index can be
+    // brought up to date with the rows rowsSince() returns.
+    typedef const Transaction* RowRef;
+    typedef const Transaction* AppendMark;
+
+    template <typename Func>
+    void forEachRef(Func func) const {
+        forEach([&](const Transaction& t) { func(&t, t); });
+    }
+
+    const Transaction& at(RowRef ref) const { return *ref; }
+    unsigned rowGeneration() const { return generation.load(memory_order_acquire); }
+
+    // The rows added since seen was the head, oldest first; returns the
+    // head to pass next time. nullptr means from the start.
+    const Transaction* rowsSince(const Transaction* seen, vector<const Transaction*>& rows) const {
+        EpochGuard guard;
+        const Transaction* newest = head.load(memory_order_acquire);
+        for (const Transaction* t = newest; t != seen; t = t->next) {
+            rows.push_back(t);
+        }
+        reverse(rows.begin(), rows.end());
+        return newest;
+    }
+
+    const TimeWindows& timeWindows() const { return stats.timeWindows(*this); }
+    const QuantileSketches& quantileSketches() const { return stats.quantileSketches(*this); }
+    const DistinctSketches& distinctSketches() const { return stats.distinctSketches(*this); }
+
+    // Nodes carry their own next pointer; the only indexes are the time
+    // windows and the sketches, once built
+    void accountMemory(MemoryBreakdown& m) const {
+        EpochGuard guard;
+        for (const Transaction* t = head.load(memory_order_acquire); t; t = t->next) {
+            accountRecord(t, m);
+        }
+        stats.accountMemory(m);
+    }
+};
+
+// Array Implementation
+struct ArrayTransaction {
+    string transaction_id;
+    string timestamp;
+    string sender_account;
+    string receiver_account;
+    double amount;
+    string transaction_type;
+    string merchant_category;
+    string location;
+    string device_used;
+    string is_fraud;
+    string fraud_type;
+    double time_since_last_transaction;
+    double spending_deviation_score;
+    int velocity_score;
+    uint32_t rule_hits;   // bit r is set when fraud rule r matched on import
+    double geo_anomaly_score;
+    string payment_channel;
+    string ip_address;
+    string device_hash;
+
+    ArrayTransaction() : rule_hits(0) {}
+};
+
+class ArrayTransactionList {
+public:
+    typedef ArrayTransaction Record;
+
+private:
+    // Readers load count and then the array; every array published after a
+    // count holds at least that many valid entries. Writers must hold the
+    // store lock.
+    atomic<ArrayTransaction**> transactions;
+    atomic<int> count;
+    int capacity;
+    atomic<unsigned> generation;   // bumped when rows are reordered
+    ListStats<ArrayTransaction, int> stats;
+
+    // Old arrays may still be in use by readers, so they are retired rather
+    // than deleted.
+    void resize(int needed) {
+        int newCapacity = capacity;
+        while (newCapacity < needed) {
+            newCapacity *= 2;
+        }
+        ArrayTransaction** oldTransactions = transactions.load(memory_order_relaxed);
+        ArrayTransaction** newTransactions = new ArrayTransaction*[newCapacity];
+        int n = count.load(memory_order_relaxed);
+        for (int i = 0; i < n; ++i) {
+            newTransactions[i] = oldTransactions[i];
+        }
+        capacity = newCapacity;
+        transactions.store(newTransactions, memory_order_release);
+        epochManager().retire([oldTransactions]() { delete[] oldTransactions; });
+    }
+
+    void merge(ArrayTransaction** arr, int left, int mid, int right) {
+        int n1 = mid - left + 1;
+        int n2 = right - mid;
+
+        ArrayTransaction** L = new ArrayTransaction*[n1];
+        ArrayTransaction** R = new ArrayTransaction*[n2];
+
+        for (int i = 0; i < n1; i++) L[i] = arr[left + i];
+        for (int j = 0; j < n2; j++) R[j] = arr[mid + 1 + j];
+
+        int i = 0, j = 0, k = left;
+        while (i < n1 && j < n2) {
+            if (L[i]->location <= R[j]->location) {
+                arr[k++] = L[i++];
+            } else {
+                arr[k++] = R[j++];
+            }
+        }
+
+        while (i < n1) arr[k++] = L[i++];
+        while (j < n2) arr[k++] = R[j++];
+
+        delete[] L;
+        delete[] R;
+    }
+
+    void mergeSort(ArrayTransaction** arr, int left, int right) {
+        if (left < right) {
+            int mid = left + (right - left) / 2;
+            mergeSort(arr, left, mid);
+            mergeSort(arr, mid + 1, right);
+            merge(arr, left, mid, right);
+        }
+    }
+
+public:
+    ArrayTransactionList(int initialCapacity = 10) : count(0), capacity(max(initialCapacity, 1)), generation(0) {
+        transactions = new ArrayTransaction*[capacity];
+    }
+
+    ~ArrayTransactionList() {
+        ArrayTransaction** items = transactions.load();
+        int total = count.load();
+        for (int i = 0; i < total; ++i) {
+            delete items[i];
+        }
+        delete[] items;
+    }
+
+    void addTransaction(ArrayTransaction* t) {
+        int n = count.load(memory_order_relaxed);
+        if (n == capacity) {
+            resize(n + 1);
+        }
+        transactions.load(memory_order_relaxed)[n] = t;
+        count.store(n + 1, memory_order_release);
+    }
+
+    // Stores the whole batch and publishes it with a single count update,
+    // so readers see all of it or none of it.
+    void addBatch(const vector<ArrayTransaction*>& batch) {
+        int n = count.load(memory_order_relaxed);
+        if (n + (int)batch.size() > capacity) {
+            resize(n + (int)batch.size());
+        }
+        ArrayTransaction** items = transactions.load(memory_order_relaxed);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            items[n + i] = batch[i];
+        }
+        count.store(n + (int)batch.size(), memory_order_release);
+    }
+
+    // One transaction as displayTransactions shows it; the array format
+    // has no numbers
+    static void displayTransaction(const ArrayTransaction& t, int) {
+        cout << "Transaction ID: " << t.transaction_id << endl;
+        cout << "Timestamp: " << t.timestamp << endl;
+        cout << "Sender: " << t.sender_account << endl;
+        cout << "Receiver: " << t.receiver_account << endl;
+        cout << "Amount: $" << fixed << setprecision(2) << t.amount << endl;
+        cout << "Type: " << t.transaction_type << endl;
+        cout << "Merchant: " << t.merchant_category << endl;
+        cout << "Location: " << t.location << endl;
+        cout << "Is Fraud: " << t.is_fraud << endl;
+        cout << "Fraud Type: " << t.fraud_type << endl;
+        cout << "Payment Channel: " << t.payment_channel << endl;
+        cout << "-------------------------------------" << endl;
+    }
+
+    void displayTransactions(int limit) {
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+
+        if (total == 0) {
+            cout << "No transactions to display." << endl;
+            return;
+        }
+
+        int displayCount = (limit == -1) ? total : min(limit, total);
+        cout << "\nDisplaying " << displayCount << " of " << total << " transactions..." << endl;
+        cout << "=====================================" << endl;
+        for (int i = 0; i < displayCount; ++i) {
+            displayTransaction(*items[i], i + 1);
+        }
+        cout << "=====================================" << endl;
+    }
+
+    // A writer operation: the sorted order is built in a new array that
+    // replaces the published one, and the old array is retired.
+    void sortByLocation() {
+        int total = count.load(memory_order_acquire);
+        if (total < 2) {
+            cout << "Not enough transactions to sort." << endl;
+            return;
+        }
+        cout << "Sorting transactions by location using merge sort..." << endl;
+        PerfScope perf("sortByLocation", total);
+        ArrayTransaction** current = transactions.load(memory_order_acquire);
+        ArrayTransaction** sorted = new ArrayTransaction*[capacity];
+        copy(current, current + total, sorted);
+        mergeSort(sorted, 0, total - 1);
+        transactions.store(sorted, memory_order_release);
+        epochManager().retire([current]() { delete[] current; });
+        generation.fetch_add(1, memory_order_release);
+        stats.reset();   // rowsSince finds new rows by their position
+        cout << "Successfully sorted " << total << " transactions by location." << endl;
+    }
+
+    void searchByTransactionType(const string& type) {
+        LatencyTimer latency("Array", "type search");
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+
+        if (total == 0) {
+            cout << "No transactions to search." << endl;
+            return;
+        }
+
+        int found = 0;
+        cout << "\nSearching for transaction type '" << type << "'..." << endl;
+        cout << "=====================================" << endl;
+        for (int i = 0; i < total; ++i) {
+            if (items[i]->transaction_type == type) {
+                ArrayTransaction* t = items[i];
+                cout << "Match #" << ++found << endl;
+                cout << "ID: " << t->transaction_id << endl;
+                cout << "Amount: $" << fixed << setprecision(2) << t->amount << endl;
+                cout << "Location: " << t->location << endl;
+                cout << "Payment Channel: " << t->payment_channel << endl;
+                cout << "-------------------------------------" << endl;
+            }
+        }
+        cout << "=====================================" << endl;
+        if (found == 0) {
+            cout << "No transactions found with type: " << type << endl;
+        } else {
+            cout << "Found " << found << " matching transactions." << endl;
+        }
+    }
+
+    int countMatches(const string& query, const string& field) const {
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+        int found = 0;
+
+        for (int i = 0; i < total; ++i) {
+            if (field == "type" && items[i]->transaction_type == query) {
+                found++;
+            } else if (field == "location" && items[i]->location == query) {
+                found++;
+            } else if (field == "fraud" && items[i]->is_fraud == query) {
+                found++;
+            }
+        }
+        return found;
+    }
+
+    void linearSearch(const string& query, const string& field) {
+        LatencyTimer latency("Array", "linear search");
+        if (getCount() == 0) {
+            cout << "No transactions to search." << endl;
+            return;
+        }
+
+        PerfScope perf("linearSearch", getCount());
+        auto start = chrono::high_resolution_clock::now();
+        int found = countMatches(query, field);
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+
+        cout << "\nLinear Search Results for " << field << " = " << query << ":" << endl;
+        cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+    }
+
+    bool binarySearch(const string& query, const string& field) {
+        LatencyTimer latency("Array", "binary search");
+        // Sort a private copy of the current version; the published array
+        // is left alone so concurrent readers and ingest are unaffected.
+        vector<ArrayTransaction*> sorted;
+        {
+            EpochGuard guard;
+            int published = count.load(memory_order_acquire);
+            ArrayTransaction** current = transactions.load(memory_order_acquire);
+            sorted.assign(current, current + published);
+        }
+        if (sorted.empty()) {
+            cout << "No transactions to search." << endl;
+            return false;
+        }
+        int total = (int)sorted.size();
+        ArrayTransaction** items = sorted.data();
+
+        if (field == "type") {
+            sort(items, items + total, [](ArrayTransaction* a, ArrayTransaction* b) {
+                return a->transaction_type < b->transaction_type;
+            });
+        } else if (field == "location") {
+            sort(items, items + total, [](ArrayTransaction* a, ArrayTransaction* b) {
+                return a->location < b->location;
+            });
+        }
+
+        PerfScope perf("binarySearch");
+        auto start = chrono::high_resolution_clock::now();
+
+        // Perform binary search
+        int left = 0, right = total - 1;
+        int found = 0;
+
+        while (left <= right) {
+            int mid = left + (right - left) / 2;
+
+            if (field == "type" && items[mid]->transaction_type == query) {
+                found = 1;
+                // Check duplicates
+                int left_ptr = mid - 1;
+                while (left_ptr >= 0 && items[left_ptr]->transaction_type == query) {
+                    found++;
+                    left_ptr--;
+                }
+                int right_ptr = mid + 1;
+                while (right_ptr < total && items[right_ptr]->transaction_type == query) {
+                    found++;
+                    right_ptr++;
+                }
+                break;
+            } else if (field == "location" && items[mid]->location == query) {
+                found = 1;
+                int left_ptr = mid - 1;
+                while (left_ptr >= 0 && items[left_ptr]->location == query) {
+                    found++;
+                    left_ptr--;
+                }
+                int right_ptr = mid + 1;
+                while (right_ptr < total && items[right_ptr]->location == query) {
+                    found++;
+                    right_ptr++;
+                }
+                break;
+            }
+            
+            string fieldValue;
+            if (field == "type") {
+                fieldValue = items[mid]->transaction_type;
+            } else if (field == "location") {
+                fieldValue = items[mid]->location;
+            }
+            
+            if (fieldValue < query) {
+                left = mid + 1;
+            } else {
+                right = mid - 1;
+            }
+        }
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+
+        cout << "\nBinary Search Results for " << field << " = " << query << ":" << endl;
+        if (found > 0) {
+            cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+        } else {
+            cout << "No matches found in " << elapsed.count() << " seconds" << endl;
+        }
+
+        return found > 0;
+    }
+
+    bool exportToJSON(const string& filename) {
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+        ofstream outFile(filename);
+        if (!outFile.is_open()) {
+            cout << "Failed to open file for writing: " << filename << endl;
+            return false;
+        }
+
+        outFile << "[\n";
+        bool first = true;
+
+        for (int i = 0; i < total; ++i) {
+            ArrayTransaction* t = items[i];
+            if (!first) {
+                outFile << ",\n";
+            }
+            first = false;
+
+            outFile << "  {\n";
+            outFile << "    \"transaction_id\": \"" << t->transaction_id << "\",\n";
+            outFile << "    \"timestamp\": \"" << t->timestamp << "\",\n";
+            outFile << "    \"sender_account\": \"" << t->sender_account << "\",\n";
+            outFile << "    \"receiver_account\": \"" << t->receiver_account << "\",\n";
+            outFile << "    \"amount\": " << t->amount << ",\n";
+            outFile << "    \"transaction_type\": \"" << t->transaction_type << "\",\n";
+            outFile << "    \"merchant_category\": \"" << t->merchant_category << "\",\n";
+            outFile << "    \"location\": \"" << t->location << "\",\n";
+            outFile << "    \"device_used\": \"" << t->device_used << "\",\n";
+            outFile << "    \"is_fraud\": \"" << t->is_fraud << "\",\n";
+            outFile << "    \"fraud_type\": \"" << t->fraud_type << "\",\n";
+            outFile << "    \"time_since_last_transaction\": " << t->time_since_last_transaction << ",\n";
+            outFile << "    \"spending_deviation_score\": " << t->spending_deviation_score << ",\n";
+            outFile << "    \"velocity_score\": " << t->velocity_score << ",\n";
+            outFile << "    \"geo_anomaly_score\": " << t->geo_anomaly_score << ",\n";
+            outFile << "    \"payment_channel\": \"" << t->payment_channel << "\",\n";
+            outFile << "    \"ip_address\": \"" << t->ip_address << "\",\n";
+            outFile << "    \"device_hash\": \"" << t->device_hash << "\"\n";
+            outFile << "  }";
+        }
+
+        outFile << "\n]";
+        outFile.close();
+        if (outFile.fail()) {
+            cout << "Failed to write " << filename << endl;
+            return false;
+        }
+        cout << "Successfully exported " << total << " transactions to " << filename << endl;
+        return true;
+    }
+
+    // A version of the array pinned at the moment it is taken. Use it
+    // (inside an EpochGuard) when several passes must see the same rows.
+    class View {
+    private:
+        ArrayTransaction** items;
+        int total;
+
+    public:
+        View(ArrayTransaction** array, int n) : items(array), total(n) {}
+
+        template <typename Func>
+        void forEach(Func func) const {
+            for (int i = 0; i < total; ++i) {
+                func(*items[i]);
+            }
+        }
+
+        int getCount() const { return total; }
+    };
+
+    View view() const {
+        int total = count.load(memory_order_acquire);
+        return View(transactions.load(memory_order_acquire), total);
+    }
+
+    template <typename Func>
+    void forEach(Func func) const {
+        EpochGuard guard;
+        view().forEach(func);
+    }
+
+    int getCount() const { return count.load(memory_order_acquire); }
+
+    // Row references for indexes built over the list; records never move,
+    // so sorting (which only reorders pointers) leaves them valid. It does
+    // change rowGeneration(), since rowsSince() finds rows by position.
+    typedef const ArrayTransaction* RowRef;
+    typedef int AppendMark;
+
+    template <typename Func>
+    void forEachRef(Func func) const {
+        forEach([&](const ArrayTransaction& t) { func(&t, t); });
+    }
+
+    // Rows [begin, end) of the current version, for scans split across
+    // threads; end is clamped to the rows published so far
+    template <typename Func>
+    void forEachRefInRange(int begin, int end, Func func) const {
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+        for (int i = begin; i < min(end, total); ++i) {
+            func(items[i], *items[i]);
+        }
+    }
+
+    const ArrayTransaction& at(RowRef ref) const { return *ref; }
+    unsigned rowGeneration() const { return generation.load(memory_order_acquire); }
+
+    // The rows added after the first seen, oldest first; returns the count
+    // to pass next time
+    int rowsSince(int seen, vector<const ArrayTransaction*>& rows) const {
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+        rows.assign(items + min(seen, total), items + total);
+        return total;
+    }
+
+    const TimeWindows& timeWindows() const { return stats.timeWindows(*this); }
+    const QuantileSketches& quantileSketches() const { return stats.quantileSketches(*this); }
+    const DistinctSketches& distinctSketches() const { return stats.distinctSketches(*this); }
+
+    void accountMemory(MemoryBreakdown& m) const {
+        EpochGuard guard;
+        int total = count.load(memory_order_acquire);
+        ArrayTransaction** items = transactions.load(memory_order_acquire);
+        for (int i = 0; i < total; ++i) {
+            accountRecord(items[i], m);
+        }
+        m.indexes += heapBlockBytes(items);
+        stats.accountMemory(m);
+    }
+};
+
+// Snapshot Implementation (versioned binary file, memory-mapped on load)
+//
+// Layout: a fixed header, seven sorted dictionaries for the categorical
+// fields (so code order == string order), then one section per channel with
+// fixed-width numeric columns, uint32 dictionary codes, offset+blob string
+// columns and two prebuilt sort indexes. Every section starts on an 8-byte
+// boundary so the columns can be used in place straight from the mapping.
+const char SNAPSHOT_MAGIC[8] = {'T', 'D', 'M', 'S', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+const int SNAPSHOT_CHANNELS = 4;
+
+enum SnapshotDictionary {
+    DICT_TYPE, DICT_MERCHANT, DICT_LOCATION, DICT_DEVICE,
+    DICT_FRAUD, DICT_FRAUD_TYPE, DICT_CHANNEL, DICT_COUNT
+};
+
+enum SnapshotStringColumn {
+    STR_ID, STR_TIMESTAMP, STR_SENDER, STR_RECEIVER,
+    STR_IP, STR_DEVICE_HASH, STR_COUNT
+};
+
+enum SnapshotNumericColumn {
+    NUM_AMOUNT, NUM_TIME_SINCE_LAST, NUM_SPENDING_DEVIATION,
+    NUM_GEO_ANOMALY, NUM_COUNT
+};
+
+struct SnapshotFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t channelCount;
+    uint64_t fileSize;
+    uint64_t dictionaryOffset[DICT_COUNT];
+    uint64_t channelOffset[SNAPSHOT_CHANNELS];
+};
+
+struct SnapshotChannelHeader {
+    uint64_t count;
+    uint64_t numericOffset[NUM_COUNT];
+    uint64_t velocityOffset;
+    uint64_t codeOffset[DICT_COUNT];
+    uint64_t stringOffset[STR_COUNT];      // uint64 offsets[count + 1]
+    uint64_t stringDataOffset[STR_COUNT];
+    uint64_t locationIndexOffset;          // uint32 row numbers sorted by location
+    uint64_t typeIndexOffset;              // uint32 row numbers sorted by type
+};
+
+// Non-owning view of bytes inside the mapping; behaves enough like a
+// std::string that the templated helpers work on every backend.
+struct StringRef {
+    const char* ptr;
+    size_t len;
+
+    StringRef() : ptr(""), len(0) {}
+    StringRef(const char* p, size_t n) : ptr(p), len(n) {}
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    operator string() const { return string(ptr, len); }
+};
+
+inline bool operator==(const StringRef& a, const string& b) {
+    return a.len == b.size() && memcmp(a.ptr, b.data(), a.len) == 0;
+}
+
+inline ostream& operator<<(ostream& out, const StringRef& s) {
+    return out.write(s.ptr, s.len);
+}
+
+struct SnapshotRow {
+    StringRef transaction_id, timestamp, sender_account, receiver_account;
+    double amount;
+    StringRef transaction_type, merchant_category, location, device_used, is_fraud, fraud_type;
+    double time_since_last_transaction, spending_deviation_score, geo_anomaly_score;
+    int velocity_score;
+    StringRef payment_channel, ip_address, device_hash;
+};
+
+struct SnapshotDictionaryView {
+    uint64_t count;
+    const uint64_t* offsets;
+    const char* data;
+
+    SnapshotDictionaryView() : count(0), offsets(nullptr), data(nullptr) {}
+
+    StringRef get(uint32_t code) const {
+        return StringRef(data + offsets[code], offsets[code + 1] - offsets[code]);
+    }
+
+    // Dictionaries are written sorted, so lookup is a binary search.
+    bool find(const string& value, uint32_t& code) const {
+        uint64_t left = 0, right = count;
+        while (left < right) {
+            uint64_t mid = left + (right - left) / 2;
+            if (string(get((uint32_t)mid)) < value) {
+                left = mid + 1;
+            } else {
+                right = mid;
+            }
+        }
+        if (left < count && get((uint32_t)left) == value) {
+            code = (uint32_t)left;
+            return true;
+        }
+        return false;
+    }
+};
+
+class SnapshotFile {
+private:
+    const char* base;
+    size_t size;
+    bool mapped;
+    vector<char> buffer;
+    SnapshotDictionaryView dictionaries[DICT_COUNT];
+
+    bool inBounds(uint64_t offset, uint64_t bytes) const {
+        return offset <= size && bytes <= size - offset;
+    }
+
+    // Offsets into a string blob must start at 0 and never decrease, so
+    // every value lies inside the blob
+    static bool ascending(const uint64_t* offsets, uint64_t entries) {
+        if (offsets[0] != 0) return false;
+        for (uint64_t i = 0; i < entries; ++i) {
+            if (offsets[i + 1] < offsets[i]) return false;
+        }
+        return true;
+    }
+
+    // Dictionary codes and index entries are used as array subscripts
+    static bool below(const uint32_t* values, uint64_t n, uint64_t limit) {
+        for (uint64_t i = 0; i < n; ++i) {
+            if (values[i] >= limit) return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef TDMS_HAVE_MMAP
+        if (mapped && base) {
+            munmap((void*)base, size);
+        }
+#endif
+        buffer.clear();
+        base = nullptr;
+        size = 0;
+        mapped = false;
+    }
+
+public:
+    SnapshotFile() : base(nullptr), size(0), mapped(false) {}
+    ~SnapshotFile() { close(); }
+
+    bool open(const string& filename) {
+        close();
+#ifdef TDMS_HAVE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cout << "Failed to open snapshot: " << filename << endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotFileHeader)) {
+            cout << "Snapshot is too small to be valid: " << filename << endl;
+            ::close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            cout << "Failed to memory-map snapshot: " << filename << endl;
+            size = 0;
+            return false;
+        }
+        base = (const char*)addr;
+        mapped = true;
+#else
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file.is_open()) {
+            cout << "Failed to open snapshot: " << filename << endl;
+            return false;
+        }
+        size = (size_t)file.tellg();
+        if (size < sizeof(SnapshotFileHeader)) {
+            cout << "Snapshot is too small to be valid: " << filename << endl;
+            size = 0;
+            return false;
+        }
+        buffer.resize(size);
+        file.seekg(0);
+        file.read(buffer.data(), size);
+        base = buffer.data();
+#endif
+
+        const SnapshotFileHeader* header = (const SnapshotFileHeader*)base;
+        if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+            cout << "Not a transaction snapshot: " << filename << endl;
+            close();
+            return false;
+        }
+        if (header->version != SNAPSHOT_VERSION) {
+            cout << "Unsupported snapshot version " << header->version
+                 << " (expected " << SNAPSHOT_VERSION << ")." << endl;
+            close();
+            return false;
+        }
+        if (header->channelCount != SNAPSHOT_CHANNELS || header->fileSize != size) {
+            cout << "Snapshot header is inconsistent (truncated file?)." << endl;
+            close();
+            return false;
+        }
+
+        for (int d = 0; d < DICT_COUNT; ++d) {
+            uint64_t offset = header->dictionaryOffset[d];
+            if (!inBounds(offset, sizeof(uint64_t))) {
+                cout << "Snapshot dictionary out of range." << endl;
+                close();
+                return false;
+            }
+            uint64_t entries = *(const uint64_t*)(base + offset);
+            const uint64_t* offsets = (const uint64_t*)(base + offset + sizeof(uint64_t));
+            if (entries >= size || !inBounds(offset + sizeof(uint64_t), (entries + 1) * sizeof(uint64_t))) {
+                cout << "Snapshot dictionary out of range." << endl;
+                close();
+                return false;
+            }
+            const char* data = (const char*)(offsets + entries + 1);
+            if (!ascending(offsets, entries) || !inBounds(data - base, offsets[entries])) {
+                cout << "Snapshot dictionary out of range." << endl;
+                close();
+                return false;
+            }
+            dictionaries[d].count = entries;
+            dictionaries[d].offsets = offsets;
+            dictionaries[d].data = data;
+        }
+        return true;
+    }
+
+    // The channel's header, or nullptr if any of its columns lies outside
+    // the file or holds an out-of-range offset, code or row number. Every
+    // value later used as a subscript is checked here, once, at load.
+    const SnapshotChannelHeader* channel(int index) const {
+        const SnapshotFileHeader* header = (const SnapshotFileHeader*)base;
+        uint64_t offset = header->channelOffset[index];
+        if (!inBounds(offset, sizeof(SnapshotChannelHeader))) {
+            return nullptr;
+        }
+        const SnapshotChannelHeader* ch = (const SnapshotChannelHeader*)(base + offset);
+        uint64_t n = ch->count;
+        if (n > 0xFFFFFFFFull) {
+            return nullptr;
+        }
+        for (int c = 0; c < NUM_COUNT; ++c) {
+            if (!inBounds(ch->numericOffset[c], n * sizeof(double))) return nullptr;
+        }
+        if (!inBounds(ch->velocityOffset, n * sizeof(int32_t))) return nullptr;
+        for (int d = 0; d < DICT_COUNT; ++d) {
+            if (!inBounds(ch->codeOffset[d], n * sizeof(uint32_t))) return nullptr;
+            if (!below((const uint32_t*)(base + ch->codeOffset[d]), n, dictionaries[d].count)) return nullptr;
+        }
+        for (int c = 0; c < STR_COUNT; ++c) {
+            if (!inBounds(ch->stringOffset[c], (n + 1) * sizeof(uint64_t))) return nullptr;
+            const uint64_t* offsets = (const uint64_t*)(base + ch->stringOffset[c]);
+            if (!ascending(offsets, n) || !inBounds(ch->stringDataOffset[c], offsets[n])) return nullptr;
+        }
+        if (!inBounds(ch->locationIndexOffset, n * sizeof(uint32_t))) return nullptr;
+        if (!inBounds(ch->typeIndexOffset, n * sizeof(uint32_t))) return nullptr;
+        if (!below((const uint32_t*)(base + ch->locationIndexOffset), n, n)) return nullptr;
+        if (!below((const uint32_t*)(base + ch->typeIndexOffset), n, n)) return nullptr;
+        return ch;
+    }
+
+    const char* at(uint64_t offset) const { return base + offset; }
+    const SnapshotDictionaryView* getDictionaries() const { return dictionaries; }
+    size_t getSize() const { return size; }
+    bool isMapped() const { return mapped; }
+};
+
+class SnapshotTransactionList {
+public:
+    typedef SnapshotRow Record;
+
+private:
+    const SnapshotDictionaryView* dictionaries;
+    int count;
+    const double* numeric[NUM_COUNT];
+    const int32_t* velocity;
+    const uint32_t* codes[DICT_COUNT];
+    const uint64_t* stringOffsets[STR_COUNT];
+    const char* stringData[STR_COUNT];
+    const uint32_t* locationIndex;
+    const uint32_t* typeIndex;
+    const uint32_t* order;   // nullptr means file order
+
+    struct StatsCache {
+        mutex lock;
+        unique_ptr<TimeWindows> windows;
+        unique_ptr<QuantileSketches> sketches;
+        unique_ptr<DistinctSketches> distinct;
+        unique_ptr<vector<uint32_t> > codeCounts[DICT_COUNT];
+    };
+    shared_ptr<StatsCache> statsCache;   // shared with copies taken as views
+
+    StringRef str(int column, uint32_t row) const {
+        const uint64_t* offsets = stringOffsets[column];
+        return StringRef(stringData[column] + offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+    uint32_t position(int i) const {
+        return order ? order[i] : (uint32_t)i;
+    }
+
+    // Number of rows in the sorted index whose code equals the given code.
+    int countInIndex(const uint32_t* index, const uint32_t* column, uint32_t code) const {
+        const uint32_t* lower = lower_bound(index, index + count, code,
+            [column](uint32_t row, uint32_t value) { return column[row] < value; });
+        const uint32_t* upper = upper_bound(index, index + count, code,
+            [column](uint32_t value, uint32_t row) { return value < column[row]; });
+        return (int)(upper - lower);
+    }
+
+public:
+    SnapshotTransactionList() : dictionaries(nullptr), count(0), velocity(nullptr),
+                                locationIndex(nullptr), typeIndex(nullptr), order(nullptr),
+                                statsCache(make_shared<StatsCache>()) {}
+
+    bool attach(const SnapshotFile& file, int channel) {
+        const SnapshotChannelHeader* ch = file.channel(channel);
+        if (!ch) {
+            return false;
+        }
+        dictionaries = file.getDictionaries();
+        count = (int)ch->count;
+        for (int c = 0; c < NUM_COUNT; ++c) {
+            numeric[c] = (const double*)file.at(ch->numericOffset[c]);
+        }
+        velocity = (const int32_t*)file.at(ch->velocityOffset);
+        for (int d = 0; d < DICT_COUNT; ++d) {
+            codes[d] = (const uint32_t*)file.at(ch->codeOffset[d]);
+        }
+        for (int c = 0; c < STR_COUNT; ++c) {
+            stringOffsets[c] = (const uint64_t*)file.at(ch->stringOffset[c]);
+            stringData[c] = file.at(ch->stringDataOffset[c]);
+        }
+        locationIndex = (const uint32_t*)file.at(ch->locationIndexOffset);
+        typeIndex = (const uint32_t*)file.at(ch->typeIndexOffset);
+        order = nullptr;
+        statsCache = make_shared<StatsCache>();
+        return true;
+    }
+
+    SnapshotRow row(int i) const { return at(position(i)); }
+
+    // Row references are row numbers in the file, which sorting leaves alone
+    typedef uint32_t RowRef;
+
+    SnapshotRow at(RowRef r) const {
+        SnapshotRow t;
+        t.transaction_id = str(STR_ID, r);
+        t.timestamp = str(STR_TIMESTAMP, r);
+        t.sender_account = str(STR_SENDER, r);
+        t.receiver_account = str(STR_RECEIVER, r);
+        t.amount = numeric[NUM_AMOUNT][r];
+        t.transaction_type = dictionaries[DICT_TYPE].get(codes[DICT_TYPE][r]);
+        t.merchant_category = dictionaries[DICT_MERCHANT].get(codes[DICT_MERCHANT][r]);
+        t.location = dictionaries[DICT_LOCATION].get(codes[DICT_LOCATION][r]);
+        t.device_used = dictionaries[DICT_DEVICE].get(codes[DICT_DEVICE][r]);
+        t.is_fraud = dictionaries[DICT_FRAUD].get(codes[DICT_FRAUD][r]);
+        t.fraud_type = dictionaries[DICT_FRAUD_TYPE].get(codes[DICT_FRAUD_TYPE][r]);
+        t.time_since_last_transaction = numeric[NUM_TIME_SINCE_LAST][r];
+        t.spending_deviation_score = numeric[NUM_SPENDING_DEVIATION][r];
+        t.velocity_score = velocity[r];
+        t.geo_anomaly_score = numeric[NUM_GEO_ANOMALY][r];
+        t.payment_channel = dictionaries[DICT_CHANNEL].get(codes[DICT_CHANNEL][r]);
+        t.ip_address = str(STR_IP, r);
+        t.device_hash = str(STR_DEVICE_HASH, r);
+        return t;
+    }
+
+    // One transaction in the same format as the array backend
+    static void displayTransaction(const SnapshotRow& t, int) {
+        cout << "Transaction ID: " << t.transaction_id << endl;
+        cout << "Timestamp: " << t.timestamp << endl;
+        cout << "Sender: " << t.sender_account << endl;
+        cout << "Receiver: " << t.receiver_account << endl;
+        cout << "Amount: $" << fixed << setprecision(2) << t.amount << endl;
+        cout << "Type: " << t.transaction_type << endl;
+        cout << "Merchant: " << t.merchant_category << endl;
+        cout << "Location: " << t.location << endl;
+        cout << "Is Fraud: " << t.is_fraud << endl;
+        cout << "Fraud Type: " << t.fraud_type << endl;
+        cout << "Payment Channel: " << t.payment_channel << endl;
+        cout << "-------------------------------------" << endl;
+    }
+
+    void displayTransactions(int limit) {
+        if (count == 0) {
+            cout << "No transactions to display." << endl;
+            return;
+        }
+
+        int displayCount = (limit == -1) ? count : min(limit, count);
+        cout << "\nDisplaying " << displayCount << " of " << count << " transactions..." << endl;
+        cout << "=====================================" << endl;
+        for (int i = 0; i < displayCount; ++i) {
+            displayTransaction(row(i), i + 1);
+        }
+        cout << "=====================================" << endl;
+    }
+
+    // The location index was built (stably) when the snapshot was written,
+    // so sorting only switches the iteration order over to it.
+    void sortByLocation() {
+        if (count < 2) {
+            cout << "Not enough transactions to sort." << endl;
+            return;
+        }
+        order = locationIndex;
+        cout << "Successfully sorted " << count << " transactions by location (prebuilt index)." << endl;
+    }
+
+    void searchByTransactionType(const string& type) {
+        LatencyTimer latency("Snapshot", "type search");
+        if (count == 0) {
+            cout << "No transactions to search." << endl;
+            return;
+        }
+
+        int found = 0;
+        uint32_t code;
+        cout << "\nSearching for transaction type '" << type << "'..." << endl;
+        cout << "=====================================" << endl;
+        if (dictionaries[DICT_TYPE].find(type, code)) {
+            for (int i = 0; i < count; ++i) {
+                uint32_t r = position(i);
+                if (codes[DICT_TYPE][r] == code) {
+                    SnapshotRow t = row(i);
+                    cout << "Match #" << ++found << endl;
+                    cout << "ID: " << t.transaction_id << endl;
+                    cout << "Amount: $" << fixed << setprecision(2) << t.amount << endl;
+                    cout << "Location: " << t.location << endl;
+                    cout << "Payment Channel: " << t.payment_channel << endl;
+                    cout << "-------------------------------------" << endl;
+                }
+            }
+        }
+        cout << "=====================================" << endl;
+        if (found == 0) {
+            cout << "No transactions found with type: " << type << endl;
+        } else {
+            cout << "Found " << found << " matching transactions." << endl;
+        }
+    }
+
+    void linearSearch(const string& query, const string& field) {
+        LatencyTimer latency("Snapshot", "linear search");
+        if (count == 0) {
+            cout << "No transactions to search." << endl;
+            return;
+        }
+
+        PerfScope perf("linearSearch", getCount());
+        auto start = chrono::high_resolution_clock::now();
+        int found = 0;
+
+        int dict = -1;
+        if (field == "type") {
+            dict = DICT_TYPE;
+        } else if (field == "location") {
+            dict = DICT_LOCATION;
+        } else if (field == "fraud") {
+            dict = DICT_FRAUD;
+        }
+
+        uint32_t code;
+        if (dict != -1 && dictionaries[dict].find(query, code)) {
+            const uint32_t* column = codes[dict];
+            for (int i = 0; i < count; ++i) {
+                found += (column[i] == code);
+            }
+        }
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+
+        cout << "\nLinear Search Results for " << field << " = " << query << ":" << endl;
+        cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+    }
+
+    bool binarySearch(const string& query, const string& field) {
+        LatencyTimer latency("Snapshot", "binary search");
+        if (count == 0) {
+            cout << "No transactions to search." << endl;
+            return false;
+        }
+
+        // The prebuilt index plays the role of the sort the other backends do
+        const uint32_t* index = nullptr;
+        int dict = -1;
+        if (field == "type") {
+            index = typeIndex;
+            dict = DICT_TYPE;
+        } else if (field == "location") {
+            index = locationIndex;
+            dict = DICT_LOCATION;
+        }
+        if (index) {
+            order = index;
+        }
+
+        PerfScope perf("binarySearch");
+        auto start = chrono::high_resolution_clock::now();
+
+        int found = 0;
+        uint32_t code;
+        if (index && dictionaries[dict].find(query, code)) {
+            found = countInIndex(index, codes[dict], code);
+        }
+
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = end - start;
+
+        cout << "\nBinary Search Results for " << field << " = " << query << ":" << endl;
+        if (found > 0) {
+            cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+        } else {
+            cout << "No matches found in " << elapsed.count() << " seconds" << endl;
+        }
+
+        return found > 0;
+    }
+
+    bool exportToJSON(const string& filename) {
+        ofstream outFile(filename);
+        if (!outFile.is_open()) {
+            cout << "Failed to open file for writing: " << filename << endl;
+            return false;
+        }
+
+        outFile << "[\n";
+        bool first = true;
+
+        for (int i = 0; i < count; ++i) {
+            SnapshotRow t = row(i);
+            if (!first) {
+                outFile << ",\n";
+            }
+            first = false;
+
+            outFile << "  {\n";
+            outFile << "    \"transaction_id\": \"" << t.transaction_id << "\",\n";
+            outFile << "    \"timestamp\": \"" << t.timestamp << "\",\n";
+            outFile << "    \"sender_account\": \"" << t.sender_account << "\",\n";
+            outFile << "    \"receiver_account\": \"" << t.receiver_account << "\",\n";
+            outFile << "    \"amount\": " << t.amount << ",\n";
+            outFile << "    \"transaction_type\": \"" << t.transaction_type << "\",\n";
+            outFile << "    \"merchant_category\": \"" << t.merchant_category << "\",\n";
+            outFile << "    \"location\": \"" << t.location << "\",\n";
+            outFile << "    \"device_used\": \"" << t.device_used << "\",\n";
+            outFile << "    \"is_fraud\": \"" << t.is_fraud << "\",\n";
+            outFile << "    \"fraud_type\": \"" << t.fraud_type << "\",\n";
+            outFile << "    \"time_since_last_transaction\": " << t.time_since_last_transaction << ",\n";
+            outFile << "    \"spending_deviation_score\": " << t.spending_deviation_score << ",\n";
+            outFile << "    \"velocity_score\": " << t.velocity_score << ",\n";
+            outFile << "    \"geo_anomaly_score\": " << t.geo_anomaly_score << ",\n";
+            outFile << "    \"payment_channel\": \"" << t.payment_channel << "\",\n";
+            outFile << "    \"ip_address\": \"" << t.ip_address << "\",\n";
+            outFile << "    \"device_hash\": \"" << t.device_hash << "\"\n";
+            outFile << "  }";
+        }
+
+        outFile << "\n]";
+        outFile.close();
+        if (outFile.fail()) {
+            cout << "Failed to write " << filename << endl;
+            return false;
+        }
+        cout << "Successfully exported " << count << " transactions to " << filename << endl;
+        return true;
+    }
+
+    template <typename Func>
+    void forEach(Func func) const {
+        for (int i = 0; i < count; ++i) {
+            func(row(i));
+        }
+    }
+
+    template <typename Func>
+    void forEachRef(Func func) const {
+        for (int i = 0; i < count; ++i) {
+            uint32_t r = position(i);
+            func(r, at(r));
+        }
+    }
+
+    unsigned rowGeneration() const { return 0; }
+
+    // A snapshot never grows, so only a first call returns rows. Sorting
+    // only changes the view order, so row numbers stay put.
+    typedef int AppendMark;
+
+    int rowsSince(int seen, vector<uint32_t>& rows) const {
+        for (int i = seen; i < count; ++i) {
+            rows.push_back((uint32_t)i);
+        }
+        return count;
+    }
+
+    int getCount() const { return count; }
+
+    // Snapshots are read-only, so the list is its own stable view
+    typedef SnapshotTransactionList View;
+    const SnapshotTransactionList& view() const { return *this; }
+
+    // Raw columns in storage order, for aggregating without building rows.
+    // Dictionaries belong to the file, so codes agree across channels.
+    const uint32_t* codeColumn(int dict) const { return codes[dict]; }
+    const double* numericColumn(int column) const { return numeric[column]; }
+    const int32_t* velocityColumn() const { return velocity; }
+    const SnapshotDictionaryView& dictionary(int dict) const { return dictionaries[dict]; }
+
+    // Rows of this channel holding each code of a dictionary, counted once
+    // on first use
+    const vector<uint32_t>& codeCounts(int dict) const {
+        lock_guard<mutex> hold(statsCache->lock);
+        unique_ptr<vector<uint32_t> >& counts = statsCache->codeCounts[dict];
+        if (!counts) {
+            unique_ptr<vector<uint32_t> > built(new vector<uint32_t>(dictionaries[dict].count, 0));
+            for (int i = 0; i < count; ++i) {
+                (*built)[codes[dict][i]]++;
+            }
+            counts = move(built);
+        }
+        return *counts;
+    }
+
+    // Nothing is ever appended to a snapshot, so its windows are built
+    // once, on first use, with a single pass over the rows.
+    const TimeWindows& timeWindows() const {
+        lock_guard<mutex> hold(statsCache->lock);
+        if (!statsCache->windows) {
+            unique_ptr<TimeWindows> built(new TimeWindows());
+            forEach([&](const SnapshotRow& t) { built->add(t); });
+            statsCache->windows = move(built);
+        }
+        return *statsCache->windows;
+    }
+
+    // Sketches are also built on first use: each thread sketches one chunk
+    // of rows and the chunks are merged.
+    template <typename Sketches>
+    unique_ptr<Sketches> buildInChunks() const {
+        const int minChunk = 65536;
+        int chunks = max(1, min((int)thread::hardware_concurrency(), count / minChunk));
+        unique_ptr<Sketches[]> parts(new Sketches[chunks]);
+        vector<thread> threads;
+        for (int k = 0; k < chunks; ++k) {
+            threads.emplace_back([this, k, chunks, &parts]() {
+                int end = (int)((int64_t)count * (k + 1) / chunks);
+                for (int i = (int)((int64_t)count * k / chunks); i < end; ++i) {
+                    parts[k].add(row(i));
+                }
+            });
+        }
+        unique_ptr<Sketches> built(new Sketches());
+        for (int k = 0; k < chunks; ++k) {
+            threads[k].join();
+            built->merge(parts[k]);
+        }
+        return built;
+    }
+
+    const QuantileSketches& quantileSketches() const {
+        lock_guard<mutex> hold(statsCache->lock);
+        if (!statsCache->sketches) {
+            statsCache->sketches = buildInChunks<QuantileSketches>();
+        }
+        return *statsCache->sketches;
+    }
+
+    const DistinctSketches& distinctSketches() const {
+        lock_guard<mutex> hold(statsCache->lock);
+        if (!statsCache->distinct) {
+            statsCache->distinct = buildInChunks<DistinctSketches>();
+        }
+        return *statsCache->distinct;
+    }
+
+    // Fixed-width columns count as records; the data lives in the mapping,
+    // not on the heap. Time windows and sketches, once built, are heap
+    // indexes.
+    void accountMemory(MemoryBreakdown& m) const {
+        if (count == 0) {
+            return;
+        }
+        m.records += (size_t)count * (NUM_COUNT * sizeof(double) + sizeof(int32_t) + DICT_COUNT * sizeof(uint32_t));
+        for (int c = 0; c < STR_COUNT; ++c) {
+            m.strings += (size_t)(stringOffsets[c][count] - stringOffsets[c][0]) + (count + 1) * sizeof(uint64_t);
+        }
+        m.indexes += 2 * (size_t)count * sizeof(uint32_t);
+        lock_guard<mutex> hold(statsCache->lock);
+        if (statsCache->windows) {
+            statsCache->windows->accountMemory(m);
+        }
+        if (statsCache->sketches) {
+            statsCache->sketches->accountMemory(m);
+        }
+        if (statsCache->distinct) {
+            statsCache->distinct->accountMemory(m);
+        }
+    }
+};
+
+// Query Predicates
+//
+// FIELD=VALUE style conditions, used by batch searches, the query server
+// and the fraud rules. Fields go by short names or by their CSV column names.
+enum QueryField {
+    Q_ID, Q_TIMESTAMP, Q_SENDER, Q_RECEIVER, Q_TYPE, Q_MERCHANT, Q_LOCATION, Q_DEVICE,
+    Q_FRAUD, Q_FRAUD_TYPE, Q_CHANNEL, Q_IP, Q_DEVICE_HASH,
+    Q_AMOUNT, Q_TIME_SINCE_LAST, Q_SPENDING_DEVIATION, Q_GEO_ANOMALY, Q_VELOCITY, Q_FIELD_COUNT
+};
+
+// Q_PREFIX and Q_CONTAINS test a text field against a set of values
+enum QueryOperator { Q_EQ, Q_NE, Q_LT, Q_LE, Q_GT, Q_GE, Q_PREFIX, Q_CONTAINS };
+
+static const char* const queryFieldNames[Q_FIELD_COUNT] = {
+    "id", "timestamp", "sender", "receiver", "type", "merchant", "location", "device",
+    "fraud", "fraud_type", "channel", "ip", "device_hash",
+    "amount", "time_since_last", "spending_deviation", "geo_anomaly", "velocity"};
+
+static const char* const queryColumnNames[Q_FIELD_COUNT] = {
+    "transaction_id", "timestamp", "sender_account", "receiver_account", "transaction_type",
+    "merchant_category", "location", "device_used", "is_fraud", "fraud_type", "payment_channel",
+    "ip_address", "device_hash", "amount", "time_since_last_transaction", "spending_deviation_score",
+    "geo_anomaly_score", "velocity_score"};
+
+inline int queryFieldIndex(const string& name) {
+    for (int f = 0; f < Q_FIELD_COUNT; ++f) {
+        if (name == queryFieldNames[f] || name == queryColumnNames[f]) return f;
+    }
+    return -1;
+}
+
+inline bool isNumericField(int field) {
+    return field >= Q_AMOUNT;
+}
+
+struct QueryPredicate {
+    int field;
+    QueryOperator op;
+    string text;
+    double number;
+    // With Q_PREFIX and Q_CONTAINS, the sorted distinct values that start
+    // with or contain text, once resolveValueSets has matched them
+    shared_ptr<const vector<string> > values;
+};
+
+// Parses FIELD=VALUE, FIELD!=VALUE, FIELD<VALUE, FIELD<=VALUE, FIELD>VALUE
+// or FIELD>=VALUE. Text fields compare as strings, so timestamp ranges work.
+// FIELD^=TEXT and FIELD*=TEXT match location, merchant or type values that
+// start with or contain TEXT.
+bool parseQueryPredicate(const string& token, QueryPredicate& p, string& error) {
+    size_t pos = token.find_first_of("=!<>");
+    bool set = pos != string::npos && pos > 1 && token[pos] == '=' && (token[pos - 1] == '^' || token[pos - 1] == '*');
+    size_t nameEnd = set ? pos - 1 : pos;
+    if (pos == string::npos || nameEnd == 0) {
+        error = "expected FIELD=VALUE, got '" + token + "'";
+        return false;
+    }
+    p.field = queryFieldIndex(token.substr(0, nameEnd));
+    if (p.field < 0) {
+        error = "unknown field '" + token.substr(0, nameEnd) + "'";
+        return false;
+    }
+    char c = token[pos];
+    bool orEqual = pos + 1 < token.size() && token[pos + 1] == '=';
+    if (set) {
+        if (p.field != Q_LOCATION && p.field != Q_MERCHANT && p.field != Q_TYPE) {
+            error = string(token[pos - 1] == '^' ? "^=" : "*=") + " covers location, merchant and type, not " +
+                    queryFieldNames[p.field];
+            return false;
+        }
+        p.op = token[pos - 1] == '^' ? Q_PREFIX : Q_CONTAINS;
+    } else if (c == '=') {
+        p.op = Q_EQ;
+    } else if (c == '!' && orEqual) {
+        p.op = Q_NE;
+    } else if (c == '<') {
+        p.op = orEqual ? Q_LE : Q_LT;
+    } else if (c == '>') {
+        p.op = orEqual ? Q_GE : Q_GT;
+    } else {
+        error = "bad operator in '" + token + "'";
+        return false;
+    }
+    p.text = token.substr(pos + (c != '=' && orEqual ? 2 : 1));
+    p.number = 0;
+    if (isNumericField(p.field)) {
+        char* end = nullptr;
+        p.number = strtod(p.text.c_str(), &end);
+        if (p.text.empty() || *end != '\0') {
+            error = "'" + p.text + "' is not a number";
+            return false;
+        }
+    }
+    return true;
+}
+
+inline int compareText(const string& a, const string& b) {
+    return a.compare(b);
+}
+
+inline int compareText(const StringRef& a, const string& b) {
+    int c = memcmp(a.ptr, b.data(), min(a.len, b.size()));
+    if (c != 0) return c;
+    return a.len < b.size() ? -1 : (a.len > b.size() ? 1 : 0);
+}
+
+inline int compareNumber(double a, double b) {
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+template <typename Record>
+int compareQueryField(const Record& t, const QueryPredicate& p) {
+    switch (p.field) {
+        case Q_ID: return compareText(t.transaction_id, p.text);
+        case Q_TIMESTAMP: return compareText(t.timestamp, p.text);
+        case Q_SENDER: return compareText(t.sender_account, p.text);
+        case Q_RECEIVER: return compareText(t.receiver_account, p.text);
+        case Q_TYPE: return compareText(t.transaction_type, p.text);
+        case Q_MERCHANT: return compareText(t.merchant_category, p.text);
+        case Q_LOCATION: return compareText(t.location, p.text);
+        case Q_DEVICE: return compareText(t.device_used, p.text);
+        case Q_FRAUD: return compareText(t.is_fraud, p.text);
+        case Q_FRAUD_TYPE: return compareText(t.fraud_type, p.text);
+        case Q_CHANNEL: return compareText(t.payment_channel, p.text);
+        case Q_IP: return compareText(t.ip_address, p.text);
+        case Q_AMOUNT: return compareNumber(t.amount, p.number);
+        case Q_TIME_SINCE_LAST: return compareNumber(t.time_since_last_transaction, p.number);
+        case Q_SPENDING_DEVIATION: return compareNumber(t.spending_deviation_score, p.number);
+        case Q_GEO_ANOMALY: return compareNumber(t.geo_anomaly_score, p.number);
+        case Q_VELOCITY: return compareNumber(t.velocity_score, p.number);
+        default: return compareText(t.device_hash, p.text);
+    }
+}
+
+// A value is in the set when it is one of the resolved values. Before
+// resolveValueSets has run, it is tested against the text directly.
+inline bool inValueSet(StringRef value, const QueryPredicate& p) {
+    if (p.values) {
+        auto found = lower_bound(p.values->begin(), p.values->end(), value,
+                                 [](const string& a, StringRef b) { return compareText(b, a) > 0; });
+        return found != p.values->end() && compareText(value, *found) == 0;
+    }
+    if (p.op == Q_PREFIX) {
+        return value.size() >= p.text.size() && memcmp(value.data(), p.text.data(), p.text.size()) == 0;
+    }
+    return p.text.empty() || search(value.data(), value.data() + value.size(), p.text.begin(), p.text.end()) !=
+                                 value.data() + value.size();
+}
+
+template <typename Record>
+bool matchesQuery(const Record& t, const vector<QueryPredicate>& predicates) {
+    for (const QueryPredicate& p : predicates) {
+        if (p.op == Q_PREFIX || p.op == Q_CONTAINS) {
+            if (!inValueSet(queryFieldRef(t, p.field), p)) return false;
+            continue;
+        }
+        int c = compareQueryField(t, p);
+        bool ok;
+        switch (p.op) {
+            case Q_EQ: ok = c == 0; break;
+            case Q_NE: ok = c != 0; break;
+            case Q_LT: ok = c < 0; break;
+            case Q_LE: ok = c <= 0; break;
+            case Q_GT: ok = c > 0; break;
+            default: ok = c >= 0; break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline StringRef textRef(const string& s) {
+    return StringRef(s.data(), s.size());
+}
+
+inline StringRef textRef(const StringRef& s) {
+    return s;
+}
+
+// A text field of a record without copying it
+template <typename Record>
+StringRef queryFieldRef(const Record& t, int field) {
+    switch (field) {
+        case Q_ID: return textRef(t.transaction_id);
+        case Q_TIMESTAMP: return textRef(t.timestamp);
+        case Q_SENDER: return textRef(t.sender_account);
+        case Q_RECEIVER: return textRef(t.receiver_account);
+        case Q_TYPE: return textRef(t.transaction_type);
+        case Q_MERCHANT: return textRef(t.merchant_category);
+        case Q_LOCATION: return textRef(t.location);
+        case Q_DEVICE: return textRef(t.device_used);
+        case Q_FRAUD: return textRef(t.is_fraud);
+        case Q_FRAUD_TYPE: return textRef(t.fraud_type);
+        case Q_CHANNEL: return textRef(t.payment_channel);
+        case Q_IP: return textRef(t.ip_address);
+        default: return textRef(t.device_hash);
+    }
+}
+
+// A numeric field of a record
+template <typename Record>
+double queryFieldNumber(const Record& t, int field) {
+    switch (field) {
+        case Q_AMOUNT: return t.amount;
+        case Q_TIME_SINCE_LAST: return t.time_since_last_transaction;
+        case Q_SPENDING_DEVIATION: return t.spending_deviation_score;
+        case Q_GEO_ANOMALY: return t.geo_anomaly_score;
+        default: return t.velocity_score;
+    }
+}
+
+// Fraud Rules
+//
+// A rule names a conjunction of query predicates, written as
+//   remote_mobile: amount>5000 and geo_anomaly_score>0.8 and device_used=mobile
+// The active rules are compiled together into one FraudRuleProgram. Each
+// distinct condition becomes one bit: numeric conditions are [low, high]
+// interval tests over the row's five numeric fields (negated for !=), text
+// conditions a three-way compare checked against a mask of accepted
+// outcomes. A row evaluates every condition, without short-circuiting, into
+// a 64-bit truth word, and rule r matches when all the bits of its mask are
+// set. Imports and the ingest consumer run the program on each row before
+// publishing it, keep the matches in the row's rule_hits and count them.
+struct FraudRuleCounters {
+    atomic<uint64_t> hits;
+    atomic<uint64_t> fraudHits;   // hits on rows whose is_fraud is True
+
+    FraudRuleCounters() : hits(0), fraudHits(0) {}
+};
+
+struct FraudRule {
+    string name;
+    string text;   // the conditions, joined with " and "
+    vector<QueryPredicate> predicates;
+    shared_ptr<FraudRuleCounters> counters;
+};
+
+class FraudRuleProgram {
+public:
+    enum { MAX_RULES = 32, MAX_CONDITIONS = 64 };
+
+private:
+    struct RangeTest {
+        int value;         // amount, time since last, spending deviation, geo anomaly, velocity
+        double low, high;
+        uint64_t negate;
+        int bit;
+    };
+
+    struct TextTest {
+        int field;
+        string value;
+        unsigned accept;   // 1 below, 2 equal, 4 above
+        int bit;
+    };
+
+    vector<RangeTest> ranges;
+    vector<TextTest> texts;
+    vector<uint64_t> masks;   // condition bits of each rule
+    vector<shared_ptr<FraudRuleCounters> > counters;
+
+    int rangeBit(int value, double low, double high, uint64_t negate) {
+        for (const RangeTest& r : ranges) {
+            if (r.value == value && r.low == low && r.high == high && r.negate == negate) return r.bit;
+        }
+        RangeTest r = {value, low, high, negate, (int)(ranges.size() + texts.size())};
+        ranges.push_back(r);
+        return r.bit;
+    }
+
+    int textBit(int field, const string& value, unsigned accept) {
+        for (const TextTest& x : texts) {
+            if (x.field == field && x.value == value && x.accept == accept) return x.bit;
+        }
+        TextTest x = {field, value, accept, (int)(ranges.size() + texts.size())};
+        texts.push_back(x);
+        return x.bit;
+    }
+
+public:
+    // Fails when the rules have more than MAX_CONDITIONS distinct conditions
+    bool compile(const vector<FraudRule>& rules, string& error) {
+        static const unsigned accepts[6] = {2, 5, 1, 3, 4, 6};   // EQ, NE, LT, LE, GT, GE
+        const double inf = numeric_limits<double>::infinity();
+        ranges.clear();
+        texts.clear();
+        masks.clear();
+        counters.clear();
+        for (const FraudRule& rule : rules) {
+            uint64_t mask = 0;
+            for (const QueryPredicate& p : rule.predicates) {
+                int bit;
+                if (isNumericField(p.field)) {
+                    double low = -inf, high = inf;
+                    switch (p.op) {
+                        case Q_LT: high = nextafter(p.number, -inf); break;
+                        case Q_LE: high = p.number; break;
+                        case Q_GT: low = nextafter(p.number, inf); break;
+                        case Q_GE: low = p.number; break;
+                        default: low = high = p.number; break;
+                    }
+                    bit = rangeBit(p.field - Q_AMOUNT, low, high, p.op == Q_NE ? 1 : 0);
+                } else {
+                    bit = textBit(p.field, p.text, accepts[p.op]);
+                }
+                if (bit >= MAX_CONDITIONS) {
+                    error = "the rules have more than " + to_string((int)MAX_CONDITIONS) + " distinct conditions";
+                    return false;
+                }
+                mask |= 1ULL << bit;
+            }
+            masks.push_back(mask);
+            counters.push_back(rule.counters);
+        }
+        return true;
+    }
+
+    // Bit r of the result is set when rule r matches
+    template <typename Record>
+    uint32_t evaluate(const Record& t) const {
+        const double values[5] = {t.amount, t.time_since_last_transaction, t.spending_deviation_score,
+                                  t.geo_anomaly_score, (double)t.velocity_score};
+        uint64_t truth = 0;
+        for (const RangeTest& r : ranges) {
+            double v = values[r.value];
+            truth |= ((uint64_t)((v >= r.low) & (v <= r.high)) ^ r.negate) << r.bit;
+        }
+        for (const TextTest& x : texts) {
+            int c = compareText(queryFieldRef(t, x.field), x.value);
+            unsigned outcome = 1u << ((c >= 0) + (c > 0));
+            truth |= (uint64_t)((outcome & x.accept) != 0) << x.bit;
+        }
+        uint32_t hits = 0;
+        for (size_t r = 0; r < masks.size(); ++r) {
+            hits |= (uint32_t)((truth & masks[r]) == masks[r]) << r;
+        }
+        return hits;
+    }
+
+    // Evaluates one row, tags it and counts its hits
+    template <typename Record>
+    uint32_t apply(Record& t) const {
+        uint32_t hits = evaluate(t);
+        t.rule_hits = hits;
+        if (hits) {
+            bool fraud = t.is_fraud == "True";
+            for (size_t r = 0; r < masks.size(); ++r) {
+                if (hits & (1u << r)) {
+                    counters[r]->hits.fetch_add(1, memory_order_relaxed);
+                    if (fraud) counters[r]->fraudHits.fetch_add(1, memory_order_relaxed);
+                }
+            }
+        }
+        return hits;
+    }
+
+    size_t ruleCount() const { return masks.size(); }
+    size_t conditionCount() const { return ranges.size() + texts.size(); }
+
+    uint64_t totalHits() const {
+        uint64_t total = 0;
+        for (const shared_ptr<FraudRuleCounters>& c : counters) {
+            total += c->hits.load(memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+// Parses "NAME: CONDITION [and CONDITION ...]". Conditions use the query
+// predicate syntax (== is accepted for =, and spaces around the operator
+// are dropped); a word without an operator continues the previous value,
+// so location=New York works.
+bool parseFraudRule(const string& line, FraudRule& rule, string& error) {
+    size_t colon = line.find(':');
+    if (colon == string::npos) {
+        error = "expected NAME: CONDITION [and CONDITION ...], got '" + line + "'";
+        return false;
+    }
+    istringstream nameStream(line.substr(0, colon));
+    nameStream >> rule.name;
+    string extra;
+    if (rule.name.empty() || nameStream >> extra) {
+        error = "a rule name is one word, got '" + line.substr(0, colon) + "'";
+        return false;
+    }
+
+    string body;
+    for (size_t i = colon + 1; i < line.size(); ++i) {
+        bool space = line[i] == ' ' || line[i] == '\t';
+        size_t next = line.find_first_not_of(" \t", i);
+        if (space && ((!body.empty() && strchr("=!<>", body.back())) ||
+                      (next != string::npos && strchr("=!<>", line[next])))) {
+            continue;
+        }
+        body += line[i];
+    }
+
+    vector<string> conditions;
+    istringstream in(body);
+    string token;
+    while (in >> token) {
+        if (token == "and" || token == "AND" || token == "&&") {
+            continue;
+        }
+        if (token.find_first_of("=!<>") == string::npos && !conditions.empty()) {
+            conditions.back() += " " + token;
+            continue;
+        }
+        size_t doubled = token.find("==");
+        if (doubled != string::npos) {
+            token.erase(doubled, 1);
+        }
+        conditions.push_back(token);
+    }
+    if (conditions.empty()) {
+        error = "rule " + rule.name + " has no conditions";
+        return false;
+    }
+
+    rule.text.clear();
+    rule.predicates.clear();
+    for (const string& condition : conditions) {
+        QueryPredicate p;
+        if (!parseQueryPredicate(condition, p, error)) {
+            return false;
+        }
+        if (p.op == Q_PREFIX || p.op == Q_CONTAINS) {
+            error = "rules take whole values, not prefix or substring conditions";
+            return false;
+        }
+        rule.predicates.push_back(p);
+        rule.text += (rule.text.empty() ? "" : " and ") + condition;
+    }
+    rule.counters = make_shared<FraudRuleCounters>();
+    return true;
+}
+
+// The active rules and the program compiled from them. Importers take the
+// program once and use it for every row; changing the rules compiles a new
+// one, so a running import keeps the rules it started with.
+class FraudRuleEngine {
+private:
+    mutable mutex lock;
+    vector<FraudRule> rules;
+    shared_ptr<const FraudRuleProgram> compiled;   // null while there are no rules
+    atomic<uint64_t> evaluated;
+
+    bool install(const vector<FraudRule>& next, string& error) {
+        if (next.size() > FraudRuleProgram::MAX_RULES) {
+            error = "at most " + to_string((int)FraudRuleProgram::MAX_RULES) + " rules can be active";
+            return false;
+        }
+        shared_ptr<FraudRuleProgram> program;
+        if (!next.empty()) {
+            program = make_shared<FraudRuleProgram>();
+            if (!program->compile(next, error)) {
+                return false;
+            }
+        }
+        rules = next;
+        compiled = program;
+        return true;
+    }
+
+public:
+    FraudRuleEngine() : evaluated(0) {}
+
+    // Adds a rule line, replacing an existing rule of the same name
+    bool addRule(const string& line, string& error) {
+        FraudRule rule;
+        if (!parseFraudRule(line, rule, error)) {
+            return false;
+        }
+        lock_guard<mutex> guard(lock);
+        vector<FraudRule> next = rules;
+        size_t r = 0;
+        while (r < next.size() && next[r].name != rule.name) r++;
+        if (r < next.size()) {
+            next[r] = rule;
+        } else {
+            next.push_back(rule);
+        }
+        return install(next, error);
+    }
+
+    bool removeRule(const string& name) {
+        lock_guard<mutex> guard(lock);
+        vector<FraudRule> next;
+        for (const FraudRule& rule : rules) {
+            if (rule.name != name) next.push_back(rule);
+        }
+        string error;
+        return next.size() < rules.size() && install(next, error);
+    }
+
+    // Adds the rules in a file, one per line, '#' for comments. Reports the
+    // first bad line and keeps the rules added before it.
+    bool loadFile(const string& filename, size_t& added) {
+        added = 0;
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cout << "Failed to open rules file: " << filename << endl;
+            return false;
+        }
+        string line, error;
+        size_t lineNumber = 0;
+        while (getline(file, line)) {
+            lineNumber++;
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == string::npos || line[first] == '#') {
+                continue;
+            }
+            if (!addRule(line, error)) {
+                cout << "Error in rules file " << filename << " line " << lineNumber << ": " << error << endl;
+                return false;
+            }
+            added++;
+        }
+        return true;
+    }
+
+    shared_ptr<const FraudRuleProgram> program() const {
+        lock_guard<mutex> guard(lock);
+        return compiled;
+    }
+
+    vector<FraudRule> list() const {
+        lock_guard<mutex> guard(lock);
+        return rules;
+    }
+
+    void resetCounts() {
+        lock_guard<mutex> guard(lock);
+        for (const FraudRule& rule : rules) {
+            rule.counters->hits = 0;
+            rule.counters->fraudHits = 0;
+        }
+        evaluated = 0;
+    }
+
+    void addEvaluated(uint64_t rows) { evaluated.fetch_add(rows, memory_order_relaxed); }
+    uint64_t rowsEvaluated() const { return evaluated.load(memory_order_relaxed); }
+};
+
+inline FraudRuleEngine& fraudRules() {
+    static FraudRuleEngine engine;
+    return engine;
+}
+
+// Takes the current program at the start of an import and prints the hits
+// the import added at the end
+class FraudRuleScope {
+private:
+    shared_ptr<const FraudRuleProgram> rules;
+    uint64_t hitsBefore;
+
+public:
+    FraudRuleScope() : rules(fraudRules().program()), hitsBefore(rules ? rules->totalHits() : 0) {}
+
+    const FraudRuleProgram* program() const { return rules.get(); }
+
+    void report(int processed) const {
+        if (!rules) return;
+        fraudRules().addEvaluated(processed);
+        cout << "Fraud rules: " << rules->ruleCount() << " rules, " << (rules->totalHits() - hitsBefore)
+             << " hits over " << processed << " rows." << endl;
+    }
+};
+
+// Helper functions
+void clearInputBuffer() {
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+
+// Splits one CSV row (in the column order documented in the README) into
+// a record. Numeric fields that fail to parse throw like stod/stoi do.
+template <typename Record>
+void parseTransactionCSV(const string& line, Record& t) {
+    stringstream ss(line);
+    string field;
+
+    getline(ss, t.transaction_id, ',');
+    getline(ss, t.timestamp, ',');
+    getline(ss, t.sender_account, ',');
+    getline(ss, t.receiver_account, ',');
+
+    getline(ss, field, ',');
+    t.amount = field.empty() ? 0.0 : stod(field);
+
+    getline(ss, t.transaction_type, ',');
+    getline(ss, t.merchant_category, ',');
+    getline(ss, t.location, ',');
+    getline(ss, t.device_used, ',');
+    getline(ss, t.is_fraud, ',');
+    getline(ss, t.fraud_type, ',');
+
+    getline(ss, field, ',');
+    t.time_since_last_transaction = field.empty() ? 0.0 : stod(field);
+
+    getline(ss, field, ',');
+    t.spending_deviation_score = field.empty() ? 0.0 : stod(field);
+
+    getline(ss, field, ',');
+    t.velocity_score = field.empty() ? 0 : stoi(field);
+
+    getline(ss, field, ',');
+    t.geo_anomaly_score = field.empty() ? 0.0 : stod(field);
+
+    getline(ss, t.payment_channel, ',');
+    getline(ss, t.ip_address, ',');
+    getline(ss, t.device_hash, ',');
+}
+
+// Index of a payment channel in ACH, card, UPI, wire order, or -1
+inline int channelIndex(const string& channel) {
+    if (channel == "ACH") return 0;
+    if (channel == "card") return 1;
+    if (channel == "UPI") return 2;
+    if (channel == "wire_transfer") return 3;
+    return -1;
+}
+
+// Adds a record to the list of its channel, running the fraud rules on it
+// first when a program is given
+template <typename List>
+bool routeTransaction(typename List::Record* t, List& achList, List& cardList,
+                      List& upiList, List& wireList, const FraudRuleProgram* rules = nullptr) {
+    List* lists[4] = {&achList, &cardList, &upiList, &wireList};
+    int c = channelIndex(t->payment_channel);
+    if (c < 0) {
+        return false;
+    }
+    if (rules) {
+        rules->apply(*t);
+    }
+    lists[c]->addTransaction(t);
+    return true;
+}
+
+bool importCSV(const string& filename, TransactionList& achList,
+               TransactionList& cardList, TransactionList& upiList,
+               TransactionList& wireList) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cout << "Failed to open file: " << filename << endl;
+        return false;
+    }
+
+    size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+    int processed = 0;
+    string line;
+    getline(file, line); // Skip header
+
+    PerfScope perf("importCSV");
+    FraudRuleScope rules;
+    auto start = chrono::high_resolution_clock::now(); // Start timer
+
+    while (getline(file, line)) {
+        Transaction* t = new Transaction();
+
+        try {
+            parseTransactionCSV(line, *t);
+
+            if (!routeTransaction(t, achList, cardList, upiList, wireList, rules.program())) {
+                delete t;
+                continue;
+            }
+
+            processed++;
+        } catch (const exception& e) {
+            cout << "Error parsing line: " << line << endl;
+            cout << "Error: " << e.what() << endl;
+            delete t;
+            continue;
+        }
+    }
+
+    file.close();
+    auto end = chrono::high_resolution_clock::now(); // End timer
+    chrono::duration<double> elapsed = end - start; // Calculate elapsed time
+
+    cout << "Successfully processed " << processed << " transactions." << endl;
+    cout << "Linked List Implementation:" << endl;
+    cout << "Time taken to load CSV: " << elapsed.count() << " seconds." << endl;
+    perf.setRows(processed);
+    printImportMemory(heapBefore, processed);
+    rules.report(processed);
+    cout << "Transaction counts by channel:" << endl;
+    cout << "- ACH: " << achList.getCount() << endl;
+    cout << "- Card: " << cardList.getCount() << endl;
+    cout << "- UPI: " << upiList.getCount() << endl;
+    cout << "- Wire Transfer: " << wireList.getCount() << endl;
+
+    return true;
+}
+
+bool importCSVArray(const string& filename, ArrayTransactionList& achList,
+                    ArrayTransactionList& cardList, ArrayTransactionList& upiList,
+                    ArrayTransactionList& wireList) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cout << "Failed to open file: " << filename << endl;
+        return false;
+    }
+
+    size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+    int processed = 0;
+    string line;
+    getline(file, line); // Skip header
+
+    PerfScope perf("importCSVArray");
+    FraudRuleScope rules;
+    auto start = chrono::high_resolution_clock::now(); // Start timer
+
+    while (getline(file, line)) {
+        ArrayTransaction* t = new ArrayTransaction();
+
+        try {
+            parseTransactionCSV(line, *t);
+
+            if (!routeTransaction(t, achList, cardList, upiList, wireList, rules.program())) {
+                delete t;
+                continue;
+            }
+
+            processed++;
+        } catch (const exception& e) {
+            cout << "Error parsing line: " << line << endl;
+            cout << "Error: " << e.what() << endl;
+            delete t;
+            continue;
+        }
+    }
+
+    file.close();
+    auto end = chrono::high_resolution_clock::now(); // End timer
+    chrono::duration<double> elapsed = end - start; // Calculate elapsed time
+
+    cout << "Successfully processed " << processed << " transactions." << endl;
+    cout << "Array Implementation:" << endl;
+    cout << "Time taken to load CSV: " << elapsed.count() << " seconds." << endl;
+    perf.setRows(processed);
+    printImportMemory(heapBefore, processed);
+    rules.report(processed);
+    cout << "Transaction counts by channel:" << endl;
+    cout << "- ACH: " << achList.getCount() << endl;
+    cout << "- Card: " << cardList.getCount() << endl;
+    cout << "- UPI: " << upiList.getCount() << endl;
+    cout << "- Wire Transfer: " << wireList.getCount() << endl;
+
+    return true;
+}
+
+template <typename Record>
+string snapshotCategory(const Record& t, int dict) {
+    switch (dict) {
+        case DICT_TYPE: return t.transaction_type;
+        case DICT_MERCHANT: return t.merchant_category;
+        case DICT_LOCATION: return t.location;
+        case DICT_DEVICE: return t.device_used;
+        case DICT_FRAUD: return t.is_fraud;
+        case DICT_FRAUD_TYPE: return t.fraud_type;
+        default: return t.payment_channel;
+    }
+}
+
+template <typename Record>
+string snapshotString(const Record& t, int column) {
+    switch (column) {
+        case STR_ID: return t.transaction_id;
+        case STR_TIMESTAMP: return t.timestamp;
+        case STR_SENDER: return t.sender_account;
+        case STR_RECEIVER: return t.receiver_account;
+        case STR_IP: return t.ip_address;
+        default: return t.device_hash;
+    }
+}
+
+class SnapshotWriter {
+private:
+    ofstream& out;
+    uint64_t position;
+
+public:
+    SnapshotWriter(ofstream& file) : out(file), position(0) {}
+
+    uint64_t write(const void* data, size_t bytes) {
+        uint64_t at = position;
+        out.write((const char*)data, bytes);
+        position += bytes;
+        return at;
+    }
+
+    void align() {
+        static const char zeros[8] = {0};
+        if (position % 8) {
+            write(zeros, 8 - position % 8);
+        }
+    }
+
+    template <typename T>
+    uint64_t writeColumn(const vector<T>& column) {
+        align();
+        return write(column.data(), column.size() * sizeof(T));
+    }
+
+    uint64_t getPosition() const { return position; }
+};
+
+// Writes every channel to a snapshot file. Each column is gathered with its
+// own pass over the list, so the extra memory needed is about one column.
+template <typename List>
+bool saveSnapshot(const string& filename, const List& achList, const List& cardList,
+                  const List& upiList, const List& wireList) {
+    typedef typename List::Record Record;
+    // Pin one version of every list so that all passes see the same rows
+    EpochGuard guard;
+    typename List::View lists[SNAPSHOT_CHANNELS] = {achList.view(), cardList.view(),
+                                                    upiList.view(), wireList.view()};
+
+    ofstream outFile(filename, ios::binary | ios::trunc);
+    if (!outFile.is_open()) {
+        cout << "Failed to open file for writing: " << filename << endl;
+        return false;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+
+    // Build sorted dictionaries so that code order matches string order
+    map<string, uint32_t> dictionaries[DICT_COUNT];
+    for (int c = 0; c < SNAPSHOT_CHANNELS; ++c) {
+        lists[c].forEach([&](const Record& t) {
+            for (int d = 0; d < DICT_COUNT; ++d) {
+                dictionaries[d][snapshotCategory(t, d)] = 0;
+            }
+        });
+    }
+
+    SnapshotFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.channelCount = SNAPSHOT_CHANNELS;
+
+    SnapshotWriter writer(outFile);
+    writer.write(&header, sizeof(header));
+
+    for (int d = 0; d < DICT_COUNT; ++d) {
+        vector<uint64_t> offsets;
+        string data;
+        uint32_t code = 0;
+        for (auto& entry : dictionaries[d]) {
+            entry.second = code++;
+            offsets.push_back(data.size());
+            data += entry.first;
+        }
+        offsets.push_back(data.size());
+        uint64_t entries = dictionaries[d].size();
+
+        writer.align();
+        header.dictionaryOffset[d] = writer.write(&entries, sizeof(entries));
+        writer.write(offsets.data(), offsets.size() * sizeof(uint64_t));
+        writer.write(data.data(), data.size());
+    }
+
+    uint64_t total = 0;
+    for (int c = 0; c < SNAPSHOT_CHANNELS; ++c) {
+        const typename List::View& list = lists[c];
+        SnapshotChannelHeader ch;
+        memset(&ch, 0, sizeof(ch));
+        ch.count = (uint64_t)list.getCount();
+        total += ch.count;
+
+        vector<double> numbers;
+        numbers.reserve(ch.count);
+        for (int n = 0; n < NUM_COUNT; ++n) {
+            numbers.clear();
+            list.forEach([&](const Record& t) {
+                switch (n) {
+                    case NUM_AMOUNT: numbers.push_back(t.amount); break;
+                    case NUM_TIME_SINCE_LAST: numbers.push_back(t.time_since_last_transaction); break;
+                    case NUM_SPENDING_DEVIATION: numbers.push_back(t.spending_deviation_score); break;
+                    default: numbers.push_back(t.geo_anomaly_score); break;
+                }
+            });
+            ch.numericOffset[n] = writer.writeColumn(numbers);
+        }
+        vector<double>().swap(numbers);
+
+        vector<int32_t> velocities;
+        velocities.reserve(ch.count);
+        list.forEach([&](const Record& t) { velocities.push_back(t.velocity_score); });
+        ch.velocityOffset = writer.writeColumn(velocities);
+        vector<int32_t>().swap(velocities);
+
+        vector<uint32_t> codes, locationCodes, typeCodes;
+        codes.reserve(ch.count);
+        for (int d = 0; d < DICT_COUNT; ++d) {
+            codes.clear();
+            list.forEach([&](const Record& t) {
+                codes.push_back(dictionaries[d][snapshotCategory(t, d)]);
+            });
+            ch.codeOffset[d] = writer.writeColumn(codes);
+            if (d == DICT_LOCATION) {
+                locationCodes = codes;
+            } else if (d == DICT_TYPE) {
+                typeCodes = codes;
+            }
+        }
+        vector<uint32_t>().swap(codes);
+
+        for (int s = 0; s < STR_COUNT; ++s) {
+            vector<uint64_t> offsets;
+            string data;
+            offsets.reserve(ch.count + 1);
+            list.forEach([&](const Record& t) {
+                offsets.push_back(data.size());
+                data += snapshotString(t, s);
+            });
+            offsets.push_back(data.size());
+            ch.stringOffset[s] = writer.writeColumn(offsets);
+            ch.stringDataOffset[s] = writer.write(data.data(), data.size());
+        }
+
+        // Stable, so the location index reproduces what merge sort would give
+        vector<uint32_t> index(ch.count);
+        for (uint32_t i = 0; i < index.size(); ++i) index[i] = i;
+        stable_sort(index.begin(), index.end(), [&](uint32_t a, uint32_t b) {
+            return locationCodes[a] < locationCodes[b];
+        });
+        ch.locationIndexOffset = writer.writeColumn(index);
+        for (uint32_t i = 0; i < index.size(); ++i) index[i] = i;
+        stable_sort(index.begin(), index.end(), [&](uint32_t a, uint32_t b) {
+            return typeCodes[a] < typeCodes[b];
+        });
+        ch.typeIndexOffset = writer.writeColumn(index);
+
+        writer.align();
+        header.channelOffset[c] = writer.write(&ch, sizeof(ch));
+    }
+
+    header.fileSize = writer.getPosition();
+    outFile.seekp(0);
+    outFile.write((const char*)&header, sizeof(header));
+    outFile.close();
+    if (!outFile) {
+        cout << "Failed while writing snapshot: " << filename << endl;
+        return false;
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed = end - start;
+
+    cout << "Successfully saved " << total << " transactions to snapshot " << filename << endl;
+    cout << "Snapshot size: ~" << header.fileSize / (1024 * 1024) << " MB, written in "
+         << elapsed.count() << " seconds." << endl;
+    return true;
+}
+
+bool loadSnapshot(const string& filename, SnapshotFile& snapshot,
+                  SnapshotTransactionList& achList, SnapshotTransactionList& cardList,
+                  SnapshotTransactionList& upiList, SnapshotTransactionList& wireList) {
+    size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+    PerfScope perf("loadSnapshot");
+    auto start = chrono::high_resolution_clock::now(); // Start timer
+
+    if (!snapshot.open(filename)) {
+        return false;
+    }
+
+    SnapshotTransactionList* lists[SNAPSHOT_CHANNELS] = {&achList, &cardList, &upiList, &wireList};
+    int processed = 0;
+    for (int c = 0; c < SNAPSHOT_CHANNELS; ++c) {
+        if (!lists[c]->attach(snapshot, c)) {
+            cout << "Snapshot channel " << c << " is corrupt: " << filename << endl;
+            return false;
+        }
+        processed += lists[c]->getCount();
+    }
+
+    auto end = chrono::high_resolution_clock::now(); // End timer
+    chrono::duration<double> elapsed = end - start;
+
+    cout << "Successfully loaded " << processed << " transactions from snapshot." << endl;
+    cout << "Snapshot Implementation (" << (snapshot.isMapped() ? "memory-mapped" : "read into memory") << "):" << endl;
+    cout << "Time taken to load snapshot: " << elapsed.count() << " seconds." << endl;
+    cout << "Snapshot file size: ~" << snapshot.getSize() / (1024 * 1024) << " MB" << endl;
+    perf.setRows(processed);
+    printImportMemory(heapBefore, processed);
+    cout << "Transaction counts by channel:" << endl;
+    cout << "- ACH: " << achList.getCount() << endl;
+    cout << "- Card: " << cardList.getCount() << endl;
+    cout << "- UPI: " << upiList.getCount() << endl;
+    cout << "- Wire Transfer: " << wireList.getCount() << endl;
+
+    return true;
+}
+
+// Columnar Archive Format
+//
+// Rows are written in blocks of up to ARCHIVE_BLOCK_ROWS rows from a single
+// channel. Each block stores its 18 columns separately with a per-column
+// encoding chosen for the data (dictionary codes and velocity bit-packed,
+// timestamps delta-encoded, scores and amounts as fixed-point integers) and
+// the block directory at the end of the file keeps min/max statistics for
+// every column so queries can skip whole blocks without decoding them.
+const char ARCHIVE_MAGIC[8] = {'T', 'D', 'M', 'S', 'C', 'O', 'L', 'A'};
+const uint32_t ARCHIVE_VERSION = 1;
+const uint32_t ARCHIVE_BLOCK_ROWS = 65536;
+const uint32_t ARCHIVE_MAX_BLOCK_ROWS = 1 << 20;   // largest block size a reader accepts
+
+// Column numbering: the snapshot string columns, then the numeric columns,
+// then velocity, then the dictionary-coded categorical columns.
+const int ARCHIVE_NUMERIC_BASE = STR_COUNT;
+const int ARCHIVE_VELOCITY = ARCHIVE_NUMERIC_BASE + NUM_COUNT;
+const int ARCHIVE_CODE_BASE = ARCHIVE_VELOCITY + 1;
+const int ARCHIVE_COLUMNS = ARCHIVE_CODE_BASE + DICT_COUNT;
+
+enum ArchiveEncoding {
+    ENC_RAW_STRING = 0,   // varint length + bytes per value
+    ENC_DELTA_TIME = 1,   // "YYYY-MM-DD HH:MM:SS" as zigzag deltas of epoch seconds
+    ENC_FIXED_POINT = 2,  // decimal exponent byte + zigzag varint of value * 10^exp
+    ENC_RAW_DOUBLE = 3,   // 8 bytes per value
+    ENC_BIT_PACKED = 4    // zigzag varint base + width byte + packed (value - base)
+};
+
+struct ArchiveFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t blockRows;
+};
+
+struct ArchiveBlockInfo {
+    uint32_t channel;
+    uint32_t rows;
+    uint64_t columnOffset[ARCHIVE_COLUMNS];
+    uint64_t columnSize[ARCHIVE_COLUMNS];
+    double minValue[ARCHIVE_COLUMNS];
+    double maxValue[ARCHIVE_COLUMNS];
+    uint8_t hasStats[ARCHIVE_COLUMNS];
+};
+
+struct ArchiveTrailer {
+    uint64_t directoryOffset;
+    uint64_t blockCount;
+    char magic[8];
+};
+
+class ArchiveBuffer {
+private:
+    string bytes;
+
+public:
+    void putByte(uint8_t b) { bytes.push_back((char)b); }
+
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            bytes.push_back((char)(v | 0x80));
+            v >>= 7;
+        }
+        bytes.push_back((char)v);
+    }
+
+    void putSigned(int64_t v) { putVarint(((uint64_t)v << 1) ^ (uint64_t)(v >> 63)); }
+
+    void putDouble(double v) { bytes.append((const char*)&v, sizeof(v)); }
+
+    void putBytes(const char* data, size_t n) {
+        putVarint(n);
+        bytes.append(data, n);
+    }
+
+    void putBits(const vector<uint64_t>& values, int width) {
+        uint64_t acc = 0;
+        int used = 0;
+        for (uint64_t v : values) {
+            acc |= v << used;
+            used += width;
+            while (used >= 8) {
+                bytes.push_back((char)(acc & 0xFF));
+                acc >>= 8;
+                used -= 8;
+            }
+        }
+        if (used > 0) {
+            bytes.push_back((char)(acc & 0xFF));
+        }
+    }
+
+    const string& data() const { return bytes; }
+    void clear() { bytes.clear(); }
+};
+
+class ArchiveCursor {
+private:
+    const char* p;
+    const char* end;
+    bool good;
+
+public:
+    ArchiveCursor(const char* data, size_t size) : p(data), end(data + size), good(true) {}
+
+    bool ok() const { return good; }
+    size_t remaining() const { return end - p; }
+
+    uint8_t getByte() {
+        if (p >= end) {
+            good = false;
+            return 0;
+        }
+        return (uint8_t)*p++;
+    }
+
+    uint64_t getVarint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = getByte();
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        good = false;
+        return 0;
+    }
+
+    int64_t getSigned() {
+        uint64_t v = getVarint();
+        return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+
+    double getDouble() {
+        double v = 0;
+        if (end - p < (ptrdiff_t)sizeof(v)) {
+            good = false;
+            return 0;
+        }
+        memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return v;
+    }
+
+    string getBytes() {
+        uint64_t n = getVarint();
+        if (!good || (uint64_t)(end - p) < n) {
+            good = false;
+            return string();
+        }
+        string s(p, (size_t)n);
+        p += n;
+        return s;
+    }
+
+    void getBits(vector<uint64_t>& values, size_t count, int width) {
+        values.resize(count);
+        uint64_t acc = 0;
+        int have = 0;
+        uint64_t mask = (width == 64) ? ~0ull : ((1ull << width) - 1);
+        for (size_t i = 0; i < count; ++i) {
+            while (have < width) {
+                acc |= (uint64_t)getByte() << have;
+                have += 8;
+            }
+            values[i] = acc & mask;
+            acc = (width == 64) ? 0 : acc >> width;
+            have -= width;
+        }
+    }
+};
+
+inline int bitWidth(uint64_t maxValue) {
+    int width = 0;
+    while (maxValue) {
+        width++;
+        maxValue >>= 1;
+    }
+    return width;
+}
+
+// Decoded form of one column of one block. Numeric, velocity and code
+// columns fill numbers; string columns fill strings; delta-encoded
+// timestamps fill both (numbers holds epoch seconds).
+struct ArchiveColumnValues {
+    vector<string> strings;
+    vector<double> numbers;
+};
+
+class ArchiveBlockBuilder {
+public:
+    uint32_t channel;
+    vector<string> strings[STR_COUNT];
+    vector<double> numbers[NUM_COUNT];
+    vector<int64_t> velocity;
+    vector<uint32_t> codes[DICT_COUNT];
+
+    size_t rows() const { return velocity.size(); }
+
+    void clear() {
+        for (auto& c : strings) c.clear();
+        for (auto& c : numbers) c.clear();
+        velocity.clear();
+        for (auto& c : codes) c.clear();
+    }
+
+    static void encodeStrings(const vector<string>& values, ArchiveBuffer& out) {
+        out.putByte(ENC_RAW_STRING);
+        for (const string& s : values) {
+            out.putBytes(s.data(), s.size());
+        }
+    }
+
+    static void encodeTimestamps(const vector<string>& values, ArchiveBuffer& out,
+                                 ArchiveBlockInfo& info, int column) {
+        vector<int64_t> seconds(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (!parseTimestamp(values[i], seconds[i])) {
+                encodeStrings(values, out);
+                return;
+            }
+        }
+        out.putByte(ENC_DELTA_TIME);
+        int64_t previous = 0;
+        for (int64_t s : seconds) {
+            out.putSigned(s - previous);
+            previous = s;
+        }
+        if (!seconds.empty()) {
+            info.hasStats[column] = 1;
+            info.minValue[column] = (double)*min_element(seconds.begin(), seconds.end());
+            info.maxValue[column] = (double)*max_element(seconds.begin(), seconds.end());
+        }
+    }
+
+    // Picks the smallest decimal exponent (0-6) at which every value survives
+    // the round trip through an integer; otherwise stores raw doubles.
+    // A -0.0 forces the raw path too, since it cannot survive as an integer.
+    static void encodeDoubles(const vector<double>& values, ArchiveBuffer& out) {
+        for (int exponent = 0; exponent <= 6; ++exponent) {
+            double factor = pow(10.0, exponent);
+            bool exact = true;
+            for (double v : values) {
+                double scaled = v * factor;
+                if (!(fabs(scaled) < 9007199254740992.0) || (double)llround(scaled) / factor != v ||
+                    (v == 0 && signbit(v))) {
+                    exact = false;
+                    break;
+                }
+            }
+            if (exact) {
+                out.putByte(ENC_FIXED_POINT);
+                out.putByte((uint8_t)exponent);
+                for (double v : values) {
+                    out.putSigned(llround(v * factor));
+                }
+                return;
+            }
+        }
+        out.putByte(ENC_RAW_DOUBLE);
+        for (double v : values) {
+            out.putDouble(v);
+        }
+    }
+
+    template <typename T>
+    static void encodeBitPacked(const vector<T>& values, ArchiveBuffer& out) {
+        int64_t base = values.empty() ? 0 : (int64_t)*min_element(values.begin(), values.end());
+        int64_t top = values.empty() ? 0 : (int64_t)*max_element(values.begin(), values.end());
+        int width = bitWidth((uint64_t)(top - base));
+        vector<uint64_t> packed(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            packed[i] = (uint64_t)((int64_t)values[i] - base);
+        }
+        out.putByte(ENC_BIT_PACKED);
+        out.putSigned(base);
+        out.putByte((uint8_t)width);
+        out.putBits(packed, width);
+    }
+
+    template <typename T>
+    static void setStats(const vector<T>& values, ArchiveBlockInfo& info, int column) {
+        if (values.empty()) {
+            return;
+        }
+        info.hasStats[column] = 1;
+        info.minValue[column] = (double)*min_element(values.begin(), values.end());
+        info.maxValue[column] = (double)*max_element(values.begin(), values.end());
+    }
+
+    void write(ofstream& out, uint64_t& position, ArchiveBlockInfo& info) const {
+        memset(&info, 0, sizeof(info));
+        info.channel = channel;
+        info.rows = (uint32_t)rows();
+
+        ArchiveBuffer buffer;
+        for (int column = 0; column < ARCHIVE_COLUMNS; ++column) {
+            buffer.clear();
+            if (column == STR_TIMESTAMP) {
+                encodeTimestamps(strings[column], buffer, info, column);
+            } else if (column < ARCHIVE_NUMERIC_BASE) {
+                encodeStrings(strings[column], buffer);
+            } else if (column < ARCHIVE_VELOCITY) {
+                encodeDoubles(numbers[column - ARCHIVE_NUMERIC_BASE], buffer);
+                setStats(numbers[column - ARCHIVE_NUMERIC_BASE], info, column);
+            } else if (column == ARCHIVE_VELOCITY) {
+                encodeBitPacked(velocity, buffer);
+                setStats(velocity, info, column);
+            } else {
+                encodeBitPacked(codes[column - ARCHIVE_CODE_BASE], buffer);
+                setStats(codes[column - ARCHIVE_CODE_BASE], info, column);
+            }
+            info.columnOffset[column] = position;
+            info.columnSize[column] = buffer.data().size();
+            out.write(buffer.data().data(), buffer.data().size());
+            position += buffer.data().size();
+        }
+    }
+};
+
+// Writes every channel to a columnar archive. Dictionaries are built in a
+// first pass over the lists; rows are then buffered one block at a time.
+template <typename List>
+bool exportColumnar(const string& filename, const List& achList, const List& cardList,
+                    const List& upiList, const List& wireList) {
+    typedef typename List::Record Record;
+    // Pin one version of every list so that all passes see the same rows
+    EpochGuard guard;
+    typename List::View lists[SNAPSHOT_CHANNELS] = {achList.view(), cardList.view(),
+                                                    upiList.view(), wireList.view()};
+
+    ofstream outFile(filename, ios::binary | ios::trunc);
+    if (!outFile.is_open()) {
+        cout << "Failed to open file for writing: " << filename << endl;
+        return false;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+
+    map<string, uint32_t> dictionaries[DICT_COUNT];
+    for (int c = 0; c < SNAPSHOT_CHANNELS; ++c) {
+        lists[c].forEach([&](const Record& t) {
+            for (int d = 0; d < DICT_COUNT; ++d) {
+                dictionaries[d][snapshotCategory(t, d)] = 0;
+            }
+        });
+    }
+
+    ArchiveFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.version = ARCHIVE_VERSION;
+    header.blockRows = ARCHIVE_BLOCK_ROWS;
+    outFile.write((const char*)&header, sizeof(header));
+
+    ArchiveBuffer buffer;
+    for (int d = 0; d < DICT_COUNT; ++d) {
+        uint32_t code = 0;
+        buffer.putVarint(dictionaries[d].size());
+        for (auto& entry : dictionaries[d]) {
+            entry.second = code++;
+            buffer.putBytes(entry.first.data(), entry.first.size());
+        }
+    }
+    outFile.write(buffer.data().data(), buffer.data().size());
+    uint64_t position = sizeof(header) + buffer.data().size();
+
+    vector<ArchiveBlockInfo> blocks;
+    ArchiveBlockBuilder builder;
+    uint64_t total = 0;
+    for (int c = 0; c < SNAPSHOT_CHANNELS; ++c) {
+        builder.clear();
+        builder.channel = (uint32_t)c;
+        lists[c].forEach([&](const Record& t) {
+            for (int s = 0; s < STR_COUNT; ++s) {
+                builder.strings[s].push_back(snapshotString(t, s));
+            }
+            builder.numbers[NUM_AMOUNT].push_back(t.amount);
+            builder.numbers[NUM_TIME_SINCE_LAST].push_back(t.time_since_last_transaction);
+            builder.numbers[NUM_SPENDING_DEVIATION].push_back(t.spending_deviation_score);
+            builder.numbers[NUM_GEO_ANOMALY].push_back(t.geo_anomaly_score);
+            builder.velocity.push_back(t.velocity_score);
+            for (int d = 0; d < DICT_COUNT; ++d) {
+                builder.codes[d].push_back(dictionaries[d][snapshotCategory(t, d)]);
+            }
+            if (builder.rows() == ARCHIVE_BLOCK_ROWS) {
+                blocks.push_back(ArchiveBlockInfo());
+                builder.write(outFile, position, blocks.back());
+                builder.clear();
+            }
+        });
+        total += lists[c].getCount();
+        if (builder.rows() > 0) {
+            blocks.push_back(ArchiveBlockInfo());
+            builder.write(outFile, position, blocks.back());
+        }
+    }
+
+    ArchiveTrailer trailer;
+    trailer.directoryOffset = position;
+    trailer.blockCount = blocks.size();
+    memcpy(trailer.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    outFile.write((const char*)blocks.data(), blocks.size() * sizeof(ArchiveBlockInfo));
+    outFile.write((const char*)&trailer, sizeof(trailer));
+    position += blocks.size() * sizeof(ArchiveBlockInfo) + sizeof(trailer);
+    outFile.close();
+    if (!outFile) {
+        cout << "Failed while writing archive: " << filename << endl;
+        return false;
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed = end - start;
+
+    cout << "Successfully archived " << total << " transactions in " << blocks.size()
+         << " blocks to " << filename << endl;
+    cout << "Archive size: " << position << " bytes (~" << position / (1024 * 1024)
+         << " MB), written in " << elapsed.count() << " seconds." << endl;
+    return true;
+}
+
+class ColumnarArchive {
+private:
+    ifstream file;
+    vector<string> dictionaries[DICT_COUNT];
+    vector<ArchiveBlockInfo> blocks;
+    uint64_t fileSize;
+
+public:
+    ColumnarArchive() : fileSize(0) {}
+
+    bool open(const string& filename) {
+        file.open(filename, ios::binary | ios::ate);
+        if (!file.is_open()) {
+            cout << "Failed to open archive: " << filename << endl;
+            return false;
+        }
+        fileSize = (uint64_t)file.tellg();
+
+        ArchiveFileHeader header;
+        ArchiveTrailer trailer;
+        if (fileSize < sizeof(header) + sizeof(trailer)) {
+            cout << "Archive is too small to be valid: " << filename << endl;
+            return false;
+        }
+        file.seekg(0);
+        file.read((char*)&header, sizeof(header));
+        file.seekg(fileSize - sizeof(trailer));
+        file.read((char*)&trailer, sizeof(trailer));
+        if (memcmp(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+            memcmp(trailer.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+            cout << "Not a columnar archive (or truncated): " << filename << endl;
+            return false;
+        }
+        if (header.version != ARCHIVE_VERSION) {
+            cout << "Unsupported archive version " << header.version
+                 << " (expected " << ARCHIVE_VERSION << ")." << endl;
+            return false;
+        }
+        if (header.blockRows == 0 || header.blockRows > ARCHIVE_MAX_BLOCK_ROWS) {
+            cout << "Archive block size is corrupt: " << filename << endl;
+            return false;
+        }
+        uint64_t directoryBytes = trailer.blockCount * sizeof(ArchiveBlockInfo);
+        if (trailer.directoryOffset > fileSize ||
+            directoryBytes != fileSize - sizeof(trailer) - trailer.directoryOffset) {
+            cout << "Archive directory is corrupt: " << filename << endl;
+            return false;
+        }
+
+        string dictionaryBytes(trailer.directoryOffset - sizeof(header), '\0');
+        file.seekg(sizeof(header));
+        file.read(&dictionaryBytes[0], dictionaryBytes.size());
+        ArchiveCursor cursor(dictionaryBytes.data(), dictionaryBytes.size());
+        for (int d = 0; d < DICT_COUNT; ++d) {
+            uint64_t entries = cursor.getVarint();
+            for (uint64_t i = 0; i < entries && cursor.ok(); ++i) {
+                dictionaries[d].push_back(cursor.getBytes());
+            }
+        }
+
+        blocks.resize(trailer.blockCount);
+        file.seekg(trailer.directoryOffset);
+        file.read((char*)blocks.data(), directoryBytes);
+        if (!cursor.ok() || !file) {
+            cout << "Archive metadata is corrupt: " << filename << endl;
+            return false;
+        }
+        for (const ArchiveBlockInfo& block : blocks) {
+            if (block.channel >= SNAPSHOT_CHANNELS || block.rows > header.blockRows) {
+                cout << "Archive block directory is corrupt: " << filename << endl;
+                return false;
+            }
+            for (int c = 0; c < ARCHIVE_COLUMNS; ++c) {
+                if (block.columnOffset[c] > trailer.directoryOffset ||
+                    block.columnSize[c] > trailer.directoryOffset - block.columnOffset[c]) {
+                    cout << "Archive block directory is corrupt: " << filename << endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool readColumn(const ArchiveBlockInfo& block, int column, ArchiveColumnValues& values) {
+        string bytes(block.columnSize[column], '\0');
+        file.seekg(block.columnOffset[column]);
+        file.read(&bytes[0], bytes.size());
+        if (!file) {
+            return false;
+        }
+
+        ArchiveCursor cursor(bytes.data(), bytes.size());
+        values.strings.clear();
+        values.numbers.clear();
+        uint8_t encoding = cursor.getByte();
+
+        // The smallest encoding of block.rows values must fit in the column
+        // before anything is sized from the row count
+        uint64_t minimumBytes = block.rows;   // one varint per value
+        if (encoding == ENC_RAW_DOUBLE) {
+            minimumBytes = (uint64_t)block.rows * sizeof(double);
+        } else if (encoding == ENC_BIT_PACKED) {
+            minimumBytes = 0;   // checked once the width is known
+        }
+        if (minimumBytes > cursor.remaining()) {
+            return false;
+        }
+        if (encoding == ENC_RAW_STRING) {
+            values.strings.resize(block.rows);
+            for (uint32_t i = 0; i < block.rows; ++i) {
+                values.strings[i] = cursor.getBytes();
+            }
+        } else if (encoding == ENC_DELTA_TIME) {
+            values.strings.resize(block.rows);
+            values.numbers.resize(block.rows);
+            int64_t seconds = 0;
+            for (uint32_t i = 0; i < block.rows; ++i) {
+                seconds += cursor.getSigned();
+                values.numbers[i] = (double)seconds;
+                values.strings[i] = formatTimestamp(seconds);
+            }
+        } else if (encoding == ENC_FIXED_POINT) {
+            double factor = pow(10.0, cursor.getByte());
+            values.numbers.resize(block.rows);
+            for (uint32_t i = 0; i < block.rows; ++i) {
+                values.numbers[i] = (double)cursor.getSigned() / factor;
+            }
+        } else if (encoding == ENC_RAW_DOUBLE) {
+            values.numbers.resize(block.rows);
+            for (uint32_t i = 0; i < block.rows; ++i) {
+                values.numbers[i] = cursor.getDouble();
+            }
+        } else if (encoding == ENC_BIT_PACKED) {
+            int64_t base = cursor.getSigned();
+            int width = cursor.getByte();
+            vector<uint64_t> packed;
+            if (width > 64 || ((uint64_t)block.rows * width + 7) / 8 > cursor.remaining()) {
+                return false;
+            }
+            cursor.getBits(packed, block.rows, width);
+            values.numbers.resize(block.rows);
+            for (uint32_t i = 0; i < block.rows; ++i) {
+                values.numbers[i] = (double)(base + (int64_t)packed[i]);
+            }
+        } else {
+            return false;
+        }
+        if (!cursor.ok()) {
+            return false;
+        }
+
+        // Dictionary-coded columns are returned as strings as well
+        if (column >= ARCHIVE_CODE_BASE) {
+            const vector<string>& dictionary = dictionaries[column - ARCHIVE_CODE_BASE];
+            values.strings.resize(block.rows);
+            for (uint32_t i = 0; i < block.rows; ++i) {
+                size_t code = (size_t)values.numbers[i];
+                if (code >= dictionary.size()) {
+                    return false;
+                }
+                values.strings[i] = dictionary[code];
+            }
+        }
+        return true;
+    }
+
+    bool findCode(int dict, const string& value, uint32_t& code) const {
+        const vector<string>& dictionary = dictionaries[dict];
+        auto it = lower_bound(dictionary.begin(), dictionary.end(), value);
+        if (it == dictionary.end() || *it != value) {
+            return false;
+        }
+        code = (uint32_t)(it - dictionary.begin());
+        return true;
+    }
+
+    const vector<ArchiveBlockInfo>& getBlocks() const { return blocks; }
+    uint64_t getFileSize() const { return fileSize; }
+};
+
+bool isColumnarArchive(const string& filename) {
+    ifstream file(filename, ios::binary);
+    char magic[sizeof(ARCHIVE_MAGIC)] = {0};
+    file.read(magic, sizeof(magic));
+    return file && memcmp(magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) == 0;
+}
+
+template <typename List>
+bool importColumnar(const string& filename, List& achList, List& cardList,
+                    List& upiList, List& wireList, const string& implementation) {
+    typedef typename List::Record Record;
+    List* lists[SNAPSHOT_CHANNELS] = {&achList, &cardList, &upiList, &wireList};
+
+    size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+    PerfScope perf("importColumnar");
+    FraudRuleScope rules;
+    auto start = chrono::high_resolution_clock::now(); // Start timer
+
+    ColumnarArchive archive;
+    if (!archive.open(filename)) {
+        return false;
+    }
+
+    int processed = 0;
+    vector<ArchiveColumnValues> columns(ARCHIVE_COLUMNS);
+    for (const ArchiveBlockInfo& block : archive.getBlocks()) {
+        for (int column = 0; column < ARCHIVE_COLUMNS; ++column) {
+            if (!archive.readColumn(block, column, columns[column])) {
+                cout << "Failed to decode archive block (column " << column << "): " << filename << endl;
+                return false;
+            }
+        }
+
+        for (uint32_t r = 0; r < block.rows; ++r) {
+            Record* t = new Record();
+            t->transaction_id = columns[STR_ID].strings[r];
+            t->timestamp = columns[STR_TIMESTAMP].strings[r];
+            t->sender_account = columns[STR_SENDER].strings[r];
+            t->receiver_account = columns[STR_RECEIVER].strings[r];
+            t->amount = columns[ARCHIVE_NUMERIC_BASE + NUM_AMOUNT].numbers[r];
+            t->transaction_type = columns[ARCHIVE_CODE_BASE + DICT_TYPE].strings[r];
+            t->merchant_category = columns[ARCHIVE_CODE_BASE + DICT_MERCHANT].strings[r];
+            t->location = columns[ARCHIVE_CODE_BASE + DICT_LOCATION].strings[r];
+            t->device_used = columns[ARCHIVE_CODE_BASE + DICT_DEVICE].strings[r];
+            t->is_fraud = columns[ARCHIVE_CODE_BASE + DICT_FRAUD].strings[r];
+            t->fraud_type = columns[ARCHIVE_CODE_BASE + DICT_FRAUD_TYPE].strings[r];
+            t->time_since_last_transaction = columns[ARCHIVE_NUMERIC_BASE + NUM_TIME_SINCE_LAST].numbers[r];
+            t->spending_deviation_score = columns[ARCHIVE_NUMERIC_BASE + NUM_SPENDING_DEVIATION].numbers[r];
+            t->velocity_score = (int)columns[ARCHIVE_VELOCITY].numbers[r];
+            t->geo_anomaly_score = columns[ARCHIVE_NUMERIC_BASE + NUM_GEO_ANOMALY].numbers[r];
+            t->payment_channel = columns[ARCHIVE_CODE_BASE + DICT_CHANNEL].strings[r];
+            t->ip_address = columns[STR_IP].strings[r];
+            t->device_hash = columns[STR_DEVICE_HASH].strings[r];
+            if (rules.program()) {
+                rules.program()->apply(*t);
+            }
+            lists[block.channel]->addTransaction(t);
+            processed++;
+        }
+    }
+
+    auto end = chrono::high_resolution_clock::now(); // End timer
+    chrono::duration<double> elapsed = end - start;
+
+    cout << "Successfully processed " << processed << " transactions." << endl;
+    cout << implementation << " Implementation:" << endl;
+    cout << "Time taken to load archive: " << elapsed.count() << " seconds." << endl;
+    cout << "Archive file size: ~" << archive.getFileSize() / (1024 * 1024) << " MB" << endl;
+    perf.setRows(processed);
+    printImportMemory(heapBefore, processed);
+    rules.report(processed);
+    cout << "Transaction counts by channel:" << endl;
+    cout << "- ACH: " << achList.getCount() << endl;
+    cout << "- Card: " << cardList.getCount() << endl;
+    cout << "- UPI: " << upiList.getCount() << endl;
+    cout << "- Wire Transfer: " << wireList.getCount() << endl;
+
+    return true;
+}
+
+// Maps a query field name onto its archive column; categorical fields are
+// matched by equality, everything else by an inclusive [low, high] range.
+int archiveColumnForField(const string& field, bool& categorical) {
+    static const char* categories[DICT_COUNT] = {
+        "type", "merchant", "location", "device", "fraud", "fraud_type", "channel"};
+    static const char* numerics[NUM_COUNT] = {
+        "amount", "time_since_last", "spending_deviation", "geo_anomaly"};
+    categorical = true;
+    for (int d = 0; d < DICT_COUNT; ++d) {
+        if (field == categories[d]) return ARCHIVE_CODE_BASE + d;
+    }
+    categorical = false;
+    for (int n = 0; n < NUM_COUNT; ++n) {
+        if (field == numerics[n]) return ARCHIVE_NUMERIC_BASE + n;
+    }
+    if (field == "velocity") return ARCHIVE_VELOCITY;
+    if (field == "timestamp") return STR_TIMESTAMP;
+    return -1;
+}
+
+// Counts matching rows per channel straight from an archive, decoding only
+// the predicate column of blocks whose min/max statistics allow a match.
+void queryColumnar(const string& filename, const string& field, const string& value,
+                   double low, double high) {
+    LatencyTimer latency("Archive", "columnar query");
+    ColumnarArchive archive;
+    if (!archive.open(filename)) {
+        return;
+    }
+
+    bool categorical;
+    int column = archiveColumnForField(field, categorical);
+    if (column < 0) {
+        cout << "Unknown field: " << field << endl;
+        return;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+
+    uint32_t code = 0;
+    bool known = true;
+    if (categorical) {
+        known = archive.findCode(column - ARCHIVE_CODE_BASE, value, code);
+        low = high = code;
+    }
+
+    int matches[SNAPSHOT_CHANNELS] = {0, 0, 0, 0};
+    int scanned = 0, skipped = 0;
+    ArchiveColumnValues values;
+    for (const ArchiveBlockInfo& block : archive.getBlocks()) {
+        if (!known || (block.hasStats[column] &&
+                       (block.maxValue[column] < low || block.minValue[column] > high))) {
+            skipped++;
+            continue;
+        }
+        if (!archive.readColumn(block, column, values)) {
+            cout << "Failed to decode archive block: " << filename << endl;
+            return;
+        }
+        scanned++;
+        if (values.numbers.empty()) {
+            continue; // timestamps that could not be delta-encoded carry no numbers
+        }
+        for (double v : values.numbers) {
+            matches[block.channel] += (v >= low && v <= high);
+        }
+    }
+
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed = end - start;
+
+    cout << "\nArchive Query Results for " << field;
+    if (categorical) {
+        cout << " = " << value << ":" << endl;
+    } else {
+        cout << " in [" << value << "]:" << endl;
+    }
+    cout << "- ACH: " << matches[0] << endl;
+    cout << "- Card: " << matches[1] << endl;
+    cout << "- UPI: " << matches[2] << endl;
+    cout << "- Wire Transfer: " << matches[3] << endl;
+    cout << "Blocks scanned: " << scanned << ", skipped by statistics: " << skipped
+         << " (" << elapsed.count() << " seconds)" << endl;
+}
+
+void queryColumnarMenu() {
+    string filename, field, value;
+    cout << "Enter archive filename: ";
+    getline(cin, filename);
+    cout << "Fields: type, merchant, location, device, fraud, fraud_type, channel (equality)" << endl;
+    cout << "        amount, time_since_last, spending_deviation, geo_anomaly, velocity, timestamp (range)" << endl;
+    cout << "Enter field: ";
+    getline(cin, field);
+
+    bool categorical;
+    if (archiveColumnForField(field, categorical) < 0) {
+        cout << "Unknown field: " << field << endl;
+        return;
+    }
+    if (categorical) {
+        cout << "Enter value: ";
+        getline(cin, value);
+        queryColumnar(filename, field, value, 0, 0);
+        return;
+    }
+
+    string lowText, highText;
+    cout << "Enter minimum: ";
+    getline(cin, lowText);
+    cout << "Enter maximum: ";
+    getline(cin, highText);
+    double low, high;
+    try {
+        if (field == "timestamp") {
+            int64_t lowSeconds, highSeconds;
+            if (!parseTimestamp(lowText, lowSeconds) || !parseTimestamp(highText, highSeconds)) {
+                cout << "Timestamps must look like YYYY-MM-DD HH:MM:SS." << endl;
+                return;
+            }
+            low = (double)lowSeconds;
+            high = (double)highSeconds;
+        } else {
+            low = stod(lowText);
+            high = stod(highText);
+        }
+    } catch (const exception& e) {
+        cout << "Invalid range: " << e.what() << endl;
+        return;
+    }
+    queryColumnar(filename, field, lowText + ", " + highText, low, high);
+}
+
+// JSON / NDJSON Import
+//
+// Accepts either a top-level array of transaction objects (the shape that
+// exportToJSON writes) or newline-delimited JSON with one object per line.
+// Parsing goes through nlohmann's SAX interface, so records are built field
+// by field and handed to the channel lists without ever holding a DOM.
+template <typename Record>
+void assignJsonText(Record& t, const string& key, const string& value) {
+    if (key == "transaction_id") t.transaction_id = value;
+    else if (key == "timestamp") t.timestamp = value;
+    else if (key == "sender_account") t.sender_account = value;
+    else if (key == "receiver_account") t.receiver_account = value;
+    else if (key == "transaction_type") t.transaction_type = value;
+    else if (key == "merchant_category") t.merchant_category = value;
+    else if (key == "location") t.location = value;
+    else if (key == "device_used") t.device_used = value;
+    else if (key == "is_fraud") t.is_fraud = value;
+    else if (key == "fraud_type") t.fraud_type = value;
+    else if (key == "payment_channel") t.payment_channel = value;
+    else if (key == "ip_address") t.ip_address = value;
+    else if (key == "device_hash") t.device_hash = value;
+    else if (key == "amount") t.amount = value.empty() ? 0.0 : stod(value);
+    else if (key == "time_since_last_transaction") t.time_since_last_transaction = value.empty() ? 0.0 : stod(value);
+    else if (key == "spending_deviation_score") t.spending_deviation_score = value.empty() ? 0.0 : stod(value);
+    else if (key == "velocity_score") t.velocity_score = value.empty() ? 0 : stoi(value);
+    else if (key == "geo_anomaly_score") t.geo_anomaly_score = value.empty() ? 0.0 : stod(value);
+}
+
+template <typename Record>
+void assignJsonNumber(Record& t, const string& key, double value, const string& text) {
+    if (key == "amount") t.amount = value;
+    else if (key == "time_since_last_transaction") t.time_since_last_transaction = value;
+    else if (key == "spending_deviation_score") t.spending_deviation_score = value;
+    else if (key == "velocity_score") t.velocity_score = (int)value;
+    else if (key == "geo_anomaly_score") t.geo_anomaly_score = value;
+    else assignJsonText(t, key, text);
+}
+
+template <typename List>
+class JsonTransactionHandler : public nlohmann::json_sax<nlohmann::json> {
+private:
+    typedef typename List::Record Record;
+
+    List* lists[4];
+    int recordDepth;   // 2 inside a top-level array, 1 for NDJSON lines
+    int depth;
+    Record* current;
+    std::string currentKey;
+    bool currentValid;
+    int processed;
+    int skipped;
+    std::string error;
+    const FraudRuleProgram* rules;
+
+    void assignText(const std::string& value) {
+        if (!current || depth != recordDepth) return;
+        try {
+            assignJsonText(*current, currentKey, value);
+        } catch (const exception& e) {
+            cout << "Error parsing field " << currentKey << " = " << value << endl;
+            cout << "Error: " << e.what() << endl;
+            currentValid = false;
+        }
+    }
+
+    void assignNumber(double value, const std::string& text) {
+        if (!current || depth != recordDepth) return;
+        assignJsonNumber(*current, currentKey, value, text);
+    }
+
+public:
+    JsonTransactionHandler(List& achList, List& cardList, List& upiList, List& wireList)
+        : recordDepth(2), depth(0), current(nullptr), currentValid(true), processed(0), skipped(0),
+          rules(nullptr) {
+        lists[0] = &achList;
+        lists[1] = &cardList;
+        lists[2] = &upiList;
+        lists[3] = &wireList;
+    }
+
+    ~JsonTransactionHandler() { delete current; }
+
+    void setRecordDepth(int d) { recordDepth = d; }
+    void setRules(const FraudRuleProgram* program) { rules = program; }
+
+    bool null() override { return true; }
+
+    bool boolean(bool val) override {
+        assignText(val ? "True" : "False");
+        return true;
+    }
+
+    bool number_integer(number_integer_t val) override {
+        assignNumber((double)val, to_string(val));
+        return true;
+    }
+
+    bool number_unsigned(number_unsigned_t val) override {
+        assignNumber((double)val, to_string(val));
+        return true;
+    }
+
+    bool number_float(number_float_t val, const string_t& s) override {
+        assignNumber(val, s);
+        return true;
+    }
+
+    bool string(string_t& val) override {
+        assignText(val);
+        return true;
+    }
+
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override {
+        depth++;
+        if (depth == recordDepth) {
+            delete current;
+            current = new Record();
+            currentValid = true;
+        } else if (depth < recordDepth) {
+            error = "expected an array of transaction objects";
+            return false;
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        currentKey = val;
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth == recordDepth && current) {
+            if (currentValid && routeTransaction(current, *lists[0], *lists[1], *lists[2], *lists[3], rules)) {
+                processed++;
+            } else {
+                delete current;
+                skipped++;
+            }
+            current = nullptr;
+        }
+        depth--;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        depth++;
+        if (depth == recordDepth && recordDepth == 1) {
+            error = "NDJSON lines must be objects";
+            return false;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        (void)position;
+        return false;
+    }
+
+    int getProcessed() const { return processed; }
+    int getSkipped() const { return skipped; }
+    const std::string& getError() const { return error; }
+};
+
+// Looks at the first non-blank byte: '[' is a JSON array, '{' is NDJSON.
+char detectJSONFormat(const string& filename) {
+    ifstream file(filename, ios::binary);
+    char c;
+    while (file.get(c)) {
+        if (c == '[' || c == '{') return c;
+        if (!isspace((unsigned char)c)) return 0;
+    }
+    return 0;
+}
+
+bool isJSONFile(const string& filename) {
+    return detectJSONFormat(filename) != 0;
+}
+
+template <typename List>
+bool importJSON(const string& filename, List& achList, List& cardList,
+                List& upiList, List& wireList, const string& implementation) {
+    char format = detectJSONFormat(filename);
+    ifstream file(filename, ios::binary);
+    if (!file.is_open() || format == 0) {
+        cout << "Failed to open JSON file: " << filename << endl;
+        return false;
+    }
+
+    size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+    PerfScope perf("importJSON");
+    FraudRuleScope rules;
+    auto start = chrono::high_resolution_clock::now(); // Start timer
+
+    JsonTransactionHandler<List> handler(achList, cardList, upiList, wireList);
+    handler.setRules(rules.program());
+    bool ok = true;
+    if (format == '[') {
+        ok = nlohmann::json::sax_parse(file, &handler);
+    } else {
+        // One document per line keeps memory bounded by the longest line
+        handler.setRecordDepth(1);
+        string line;
+        size_t lineNumber = 0;
+        while (ok && getline(file, line)) {
+            lineNumber++;
+            if (line.find_first_not_of(" \t\r") == string::npos) {
+                continue;
+            }
+            ok = nlohmann::json::sax_parse(line, &handler);
+            if (!ok) {
+                cout << "Error parsing NDJSON line " << lineNumber << endl;
+            }
+        }
+    }
+
+    auto end = chrono::high_resolution_clock::now(); // End timer
+    chrono::duration<double> elapsed = end - start;
+
+    if (!ok) {
+        cout << "JSON parse error: " << handler.getError() << endl;
+        cout << "Imported " << handler.getProcessed() << " transactions before the error." << endl;
+        return false;
+    }
+
+    cout << "Successfully processed " << handler.getProcessed() << " transactions";
+    if (handler.getSkipped() > 0) {
+        cout << " (" << handler.getSkipped() << " skipped)";
+    }
+    cout << "." << endl;
+    cout << implementation << " Implementation:" << endl;
+    cout << "Time taken to load " << (format == '[' ? "JSON" : "NDJSON") << ": " << elapsed.count() << " seconds." << endl;
+    perf.setRows((long)handler.getProcessed());
+    printImportMemory(heapBefore, (int)handler.getProcessed());
+    rules.report((int)handler.getProcessed());
+    cout << "Transaction counts by channel:" << endl;
+    cout << "- ACH: " << achList.getCount() << endl;
+    cout << "- Card: " << cardList.getCount() << endl;
+    cout << "- UPI: " << upiList.getCount() << endl;
+    cout << "- Wire Transfer: " << wireList.getCount() << endl;
+
+    return true;
+}
+
+inline void writeJSONString(ostream& out, const string& value) {
+    out << '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if ((unsigned char)c < 0x20) {
+            out << "\\u" << hex << setw(4) << setfill('0') << (int)c << dec << setfill(' ');
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+// Appends response text straight into an output buffer, usually the
+// connection's. Numbers are formatted into a stack buffer and strings,
+// including snapshot StringRefs that point into the mapping, are escaped
+// in place, so a response costs no temporaries beyond buffer growth.
+// With a spill function, the buffer is handed off each time it passes
+// spillBytes; that is how large results are streamed.
+class ResponseWriter {
+private:
+    string& out;
+    function<bool(string&)> spill;
+    size_t spillBytes;
+    bool failed;
+
+    template <typename T>
+    ResponseWriter& formatted(const char* format, T value) {
+        char buffer[32];
+        int n = snprintf(buffer, sizeof(buffer), format, value);
+        out.append(buffer, n);
+        return *this;
+    }
+
+public:
+    explicit ResponseWriter(string& target) : out(target), spillBytes(0), failed(false) {}
+    ResponseWriter(string& target, function<bool(string&)> spillTo, size_t threshold)
+        : out(target), spill(spillTo), spillBytes(threshold), failed(false) {}
+
+    ResponseWriter& operator<<(const char* s) { out.append(s); return *this; }
+    ResponseWriter& operator<<(const string& s) { out.append(s); return *this; }
+    ResponseWriter& operator<<(const StringRef& s) { out.append(s.ptr, s.len); return *this; }
+    ResponseWriter& operator<<(char c) { out.push_back(c); return *this; }
+    ResponseWriter& operator<<(int v) { return formatted("%d", v); }
+    ResponseWriter& operator<<(long v) { return formatted("%ld", v); }
+    ResponseWriter& operator<<(unsigned long v) { return formatted("%lu", v); }
+    ResponseWriter& operator<<(double v) { return formatted("%.15g", v); }   // same digits as setprecision(15)
+
+    // Writes a quoted JSON string, escaped like writeJSONString
+    void writeString(const char* p, size_t n) {
+        out.push_back('"');
+        for (size_t i = 0; i < n; ++i) {
+            char c = p[i];
+            if (c == '"' || c == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if ((unsigned char)c < 0x20) {
+                formatted("\\u%04x", (int)(unsigned char)c);
+            } else {
+                out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+
+    // Called between records: spills the buffer once it is big enough
+    void checkpoint() {
+        if (spill && !failed && out.size() >= spillBytes) {
+            failed = !spill(out);
+        }
+    }
+
+    // Spills whatever is left. Returns false if any spill failed.
+    bool finish() {
+        if (spill && !failed && !out.empty()) {
+            failed = !spill(out);
+        }
+        return !failed;
+    }
+
+    bool hasFailed() const { return failed; }
+    size_t size() const { return out.size(); }
+};
+
+inline void writeJSONString(ResponseWriter& out, const string& value) {
+    out.writeString(value.data(), value.size());
+}
+
+inline void writeJSONString(ResponseWriter& out, const StringRef& value) {
+    out.writeString(value.data(), value.size());
+}
+
+// Writes one transaction as a single-line JSON object to a stream or a
+// ResponseWriter
+template <typename Out, typename Record>
+void writeTransactionJSON(Out& out, const Record& t) {
+    out << "{\"transaction_id\":"; writeJSONString(out, t.transaction_id);
+    out << ",\"timestamp\":"; writeJSONString(out, t.timestamp);
+    out << ",\"sender_account\":"; writeJSONString(out, t.sender_account);
+    out << ",\"receiver_account\":"; writeJSONString(out, t.receiver_account);
+    out << ",\"amount\":" << t.amount;
+    out << ",\"transaction_type\":"; writeJSONString(out, t.transaction_type);
+    out << ",\"merchant_category\":"; writeJSONString(out, t.merchant_category);
+    out << ",\"location\":"; writeJSONString(out, t.location);
+    out << ",\"device_used\":"; writeJSONString(out, t.device_used);
+    out << ",\"is_fraud\":"; writeJSONString(out, t.is_fraud);
+    out << ",\"fraud_type\":"; writeJSONString(out, t.fraud_type);
+    out << ",\"time_since_last_transaction\":" << t.time_since_last_transaction;
+    out << ",\"spending_deviation_score\":" << t.spending_deviation_score;
+    out << ",\"velocity_score\":" << t.velocity_score;
+    out << ",\"geo_anomaly_score\":" << t.geo_anomaly_score;
+    out << ",\"payment_channel\":"; writeJSONString(out, t.payment_channel);
+    out << ",\"ip_address\":"; writeJSONString(out, t.ip_address);
+    out << ",\"device_hash\":"; writeJSONString(out, t.device_hash);
+    out << "}";
+}
+
+// Writes all four channels as one NDJSON file (one object per line).
+template <typename List>
+bool exportNDJSON(const string& filename, const List& achList, const List& cardList,
+                  const List& upiList, const List& wireList) {
+    typedef typename List::Record Record;
+    ofstream outFile(filename);
+    if (!outFile.is_open()) {
+        cout << "Failed to open file for writing: " << filename << endl;
+        return false;
+    }
+
+    outFile << setprecision(15);
+    const List* lists[4] = {&achList, &cardList, &upiList, &wireList};
+    int written = 0;
+    for (const List* list : lists) {
+        list->forEach([&](const Record& t) {
+            writeTransactionJSON(outFile, t);
+            outFile << "\n";
+            written++;
+        });
+    }
+
+    outFile.close();
+    if (outFile.fail()) {
+        cout << "Failed to write " << filename << endl;
+        return false;
+    }
+    cout << "Successfully exported " << written << " transactions to " << filename << endl;
+    return true;
+}
+
+// Discards everything written to cout while in scope, so benchmarks can
+// call the normal importers without their progress output.
+class SilenceOutput {
+private:
+    streambuf* saved;
+    ostringstream sink;
+
+public:
+    SilenceOutput() : saved(cout.rdbuf(sink.rdbuf())) {}
+    ~SilenceOutput() { cout.rdbuf(saved); }
+};
+
+inline double fileSizeMB(const string& filename) {
+    ifstream file(filename, ios::binary | ios::ate);
+    return file.is_open() ? (double)file.tellg() / (1024.0 * 1024.0) : 0.0;
+}
+
+// Loads the CSV, writes the same rows as NDJSON, and then times importing
+// each file into fresh array lists.
+void benchmarkJSONImport(const string& csvFile, const string& jsonFile) {
+    struct Result { string format; double megabytes; double seconds; int rows; };
+    vector<Result> results;
+
+    {
+        ArrayTransactionList ach, card, upi, wire;
+        bool ok;
+        auto start = chrono::high_resolution_clock::now();
+        {
+            SilenceOutput quiet;
+            ok = importCSVArray(csvFile, ach, card, upi, wire);
+        }
+        chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+        if (!ok) {
+            cout << "Failed to open file: " << csvFile << endl;
+            return;
+        }
+        results.push_back({"CSV", fileSizeMB(csvFile), elapsed.count(),
+                           ach.getCount() + card.getCount() + upi.getCount() + wire.getCount()});
+        SilenceOutput quiet;
+        if (!exportNDJSON(jsonFile, ach, card, upi, wire)) {
+            return;
+        }
+    }
+
+    {
+        ArrayTransactionList ach, card, upi, wire;
+        bool ok;
+        auto start = chrono::high_resolution_clock::now();
+        {
+            SilenceOutput quiet;
+            ok = importJSON(jsonFile, ach, card, upi, wire, "Array");
+        }
+        chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+        if (!ok) {
+            cout << "Failed to import generated NDJSON: " << jsonFile << endl;
+            return;
+        }
+        results.push_back({"NDJSON", fileSizeMB(jsonFile), elapsed.count(),
+                           ach.getCount() + card.getCount() + upi.getCount() + wire.getCount()});
+    }
+
+    cout << "\nImport Throughput (Array Implementation):" << endl;
+    cout << left << setw(10) << "Format" << right << setw(12) << "Size (MB)" << setw(12) << "Rows"
+         << setw(12) << "Seconds" << setw(14) << "Rows/sec" << setw(10) << "MB/sec" << endl;
+    for (const Result& r : results) {
+        cout << left << setw(10) << r.format << right << fixed << setprecision(2)
+             << setw(12) << r.megabytes << setw(12) << r.rows << setprecision(3)
+             << setw(12) << r.seconds << setprecision(0) << setw(14) << r.rows / r.seconds
+             << setprecision(2) << setw(10) << r.megabytes / r.seconds << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    if (results[0].rows != results[1].rows) {
+        cout << "Warning: row counts differ between formats." << endl;
+    }
+}
+
+// Account Features
+//
+// Computes time_since_last_transaction (seconds since the sender's previous
+// transaction, 0 for its first) and velocity_score (the sender's
+// transactions in the trailing window, this one included) as records are
+// ingested, instead of taking them from the feed. Each sender has one
+// 32-byte slot in an open-addressing table keyed by a 64-bit hash of the
+// account: the latest time seen and a ring of counts for BUCKETS buckets
+// spanning the window, so counts are exact to a bucket width. One thread
+// (the ingest consumer) updates it; the counters can be read from others.
+class AccountFeatures {
+public:
+    static const int BUCKETS = 8;
+
+private:
+    struct Slot {
+        uint64_t key;              // account hash, 0 for an empty slot
+        uint32_t last;             // latest time seen, epoch seconds
+        uint32_t newest;           // newest bucket number (time / width)
+        uint16_t counts[BUCKETS];  // by bucket number % BUCKETS
+    };
+
+    vector<Slot> slots;
+    size_t used;
+    int64_t window;
+    uint32_t width;
+    // Written by the updating thread only, so a relaxed load and store
+    // stands in for an increment
+    atomic<size_t> accountCount;
+    atomic<size_t> slotCount;
+    atomic<uint64_t> filled;
+    atomic<uint64_t> skipped;
+
+    static void bump(atomic<uint64_t>& counter) {
+        counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    Slot& find(uint64_t key) {
+        if ((used + 1) * 4 > slots.size() * 3) {
+            vector<Slot> old(slots.size() * 2, Slot());
+            old.swap(slots);
+            for (const Slot& s : old) {
+                if (s.key == 0) continue;
+                size_t i = s.key & (slots.size() - 1);
+                while (slots[i].key != 0) i = (i + 1) & (slots.size() - 1);
+                slots[i] = s;
+            }
+            slotCount.store(slots.size(), memory_order_relaxed);
+        }
+        size_t mask = slots.size() - 1;
+        size_t i = key & mask;
+        while (slots[i].key != key && slots[i].key != 0) {
+            i = (i + 1) & mask;
+        }
+        return slots[i];
+    }
+
+    // Records one transaction of the account at time; returns the seconds
+    // since its previous one and its count in the window ending at time
+    void update(uint64_t key, uint32_t time, uint32_t& sinceLast, uint32_t& velocity) {
+        Slot& s = find(key);
+        uint32_t bucket = time / width;
+        if (s.key == 0) {
+            memset(&s, 0, sizeof(s));
+            s.key = key;
+            s.last = time;
+            s.newest = bucket;
+            accountCount.store(++used, memory_order_relaxed);
+            sinceLast = 0;
+        } else {
+            sinceLast = time > s.last ? time - s.last : 0;
+            s.last = max(s.last, time);
+        }
+        if (bucket > s.newest) {
+            for (uint32_t b = s.newest + 1; b <= bucket && b <= s.newest + BUCKETS; ++b) {
+                s.counts[b % BUCKETS] = 0;
+            }
+            s.newest = bucket;
+        }
+        uint32_t oldest = s.newest >= BUCKETS - 1 ? s.newest - (BUCKETS - 1) : 0;
+        if (bucket < oldest) {
+            velocity = 1;   // older than the ring, so only this row is known
+            return;
+        }
+        uint16_t& count = s.counts[bucket % BUCKETS];
+        if (count < numeric_limits<uint16_t>::max()) count++;
+        velocity = 0;
+        for (uint32_t b = oldest; b <= bucket; ++b) {
+            velocity += s.counts[b % BUCKETS];
+        }
+    }
+
+    template <typename Record>
+    bool key(const Record& t, uint64_t& hash, uint32_t& time) const {
+        int64_t seconds;
+        if (!parseTimestamp(t.timestamp.data(), t.timestamp.size(), seconds) || seconds < 0 ||
+            seconds > numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        hash = hashBytes(t.sender_account.data(), t.sender_account.size());
+        hash += hash == 0;
+        time = (uint32_t)seconds;
+        return true;
+    }
+
+public:
+    explicit AccountFeatures(int64_t windowSeconds = 3600)
+        : slots(1 << 16, Slot()), used(0), window(max(windowSeconds, (int64_t)BUCKETS)),
+          width((uint32_t)(window / BUCKETS)), accountCount(0), slotCount(slots.size()), filled(0), skipped(0) {}
+
+    // Overwrites both fields of t from the sender's history, then adds t to
+    // it. Rows without a usable timestamp keep their fields.
+    template <typename Record>
+    void fill(Record& t) {
+        uint64_t hash;
+        uint32_t time, sinceLast, velocity;
+        if (!key(t, hash, time)) {
+            bump(skipped);
+            return;
+        }
+        update(hash, time, sinceLast, velocity);
+        t.time_since_last_transaction = sinceLast;
+        t.velocity_score = (int)velocity;
+        bump(filled);
+    }
+
+    // Adds t to the sender's history without changing it, for rows that
+    // were loaded before features were computed
+    template <typename Record>
+    void observe(const Record& t) {
+        uint64_t hash;
+        uint32_t time, sinceLast, velocity;
+        if (key(t, hash, time)) {
+            update(hash, time, sinceLast, velocity);
+        }
+    }
+
+    int64_t windowSeconds() const { return window; }
+    size_t accounts() const { return accountCount.load(memory_order_relaxed); }
+    uint64_t rowsFilled() const { return filled.load(memory_order_relaxed); }
+    uint64_t rowsSkipped() const { return skipped.load(memory_order_relaxed); }
+    size_t memoryBytes() const { return sizeof(*this) + slotCount.load(memory_order_relaxed) * sizeof(Slot); }
+};
+
+// Lock-free Ingest Queue
+//
+// Bounded multi-producer single-consumer ring (Vyukov's sequence-numbered
+// slots): producers claim a slot with one CAS on the enqueue position and
+// never take a lock; the single consumer drains up to a batch of records
+// and routes the whole batch into the channel lists under the store lock,
+// so readers see a batch either entirely or not at all.
+template <typename List>
+class IngestQueue {
+private:
+    typedef typename List::Record Record;
+    typedef chrono::steady_clock Clock;
+
+    struct Slot {
+        atomic<size_t> sequence;
+        Record* record;
+        Clock::time_point enqueuedAt;
+    };
+
+    Slot* slots;
+    size_t mask;
+    size_t batchSize;
+    alignas(64) atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;
+
+    List* lists[4];
+    vector<Record*> groups[4];
+    mutex& storeMutex;
+    thread consumer;
+    atomic<bool> running;
+
+    atomic<uint64_t> published;
+    atomic<uint64_t> rejected;
+    atomic<uint64_t> batches;
+    atomic<double> lastLatencyMs;
+    vector<double>* latencySink;   // per-record latencies in microseconds, for benchmarks
+    unique_ptr<AccountFeatures> features;   // set while stopped, used by the consumer only
+
+    Record* tryPop(Clock::time_point& enqueuedAt) {
+        Slot& slot = slots[dequeuePos & mask];
+        size_t seq = slot.sequence.load(memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(dequeuePos + 1) < 0) {
+            return nullptr;
+        }
+        Record* t = slot.record;
+        enqueuedAt = slot.enqueuedAt;
+        slot.sequence.store(dequeuePos + mask + 1, memory_order_release);
+        dequeuePos++;
+        return t;
+    }
+
+    // Drains what is available right now; returns the number of records taken.
+    size_t drainOnce(vector<Record*>& batch, vector<Clock::time_point>& times) {
+        batch.clear();
+        times.clear();
+        Clock::time_point enqueuedAt;
+        while (batch.size() < batchSize) {
+            Record* t = tryPop(enqueuedAt);
+            if (!t) break;
+            batch.push_back(t);
+            times.push_back(enqueuedAt);
+        }
+        if (batch.empty()) {
+            return 0;
+        }
+
+        uint64_t accepted = 0, dropped = 0;
+        for (vector<Record*>& group : groups) {
+            group.clear();
+        }
+        shared_ptr<const FraudRuleProgram> rules = fraudRules().program();
+        for (Record* t : batch) {
+            int c = channelIndex(t->payment_channel);
+            if (c < 0) {
+                delete t;
+                dropped++;
+            } else {
+                if (features) {
+                    features->fill(*t);
+                }
+                if (rules) {
+                    rules->apply(*t);
+                }
+                groups[c].push_back(t);
+                accepted++;
+            }
+        }
+        {
+            // The store mutex only serialises writers; readers are never blocked
+            lock_guard<mutex> guard(storeMutex);
+            for (int c = 0; c < 4; ++c) {
+                if (!groups[c].empty()) {
+                    lists[c]->addBatch(groups[c]);
+                }
+            }
+        }
+        epochManager().reclaim();
+
+        Clock::time_point now = Clock::now();
+        if (latencySink) {
+            for (const Clock::time_point& at : times) {
+                latencySink->push_back(chrono::duration<double, micro>(now - at).count());
+            }
+        }
+        lastLatencyMs = chrono::duration<double, milli>(now - times.front()).count();
+        published += accepted;
+        rejected += dropped;
+        batches++;
+        if (rules) {
+            fraudRules().addEvaluated(accepted);
+        }
+        return batch.size();
+    }
+
+    void run() {
+        vector<Record*> batch;
+        vector<Clock::time_point> times;
+        batch.reserve(batchSize);
+        times.reserve(batchSize);
+        int idle = 0;
+        while (true) {
+            if (drainOnce(batch, times) > 0) {
+                idle = 0;
+                continue;
+            }
+            if (!running) {
+                break;   // stopped and fully drained
+            }
+            // Back off gradually so an idle consumer does not burn a core
+            if (++idle < 64) {
+                this_thread::yield();
+            } else {
+                this_thread::sleep_for(chrono::microseconds(idle < 1024 ? 50 : 1000));
+            }
+        }
+    }
+
+public:
+    IngestQueue(List& achList, List& cardList, List& upiList, List& wireList, mutex& lock,
+                size_t capacity = 65536, size_t batch = 4096)
+        : batchSize(batch), enqueuePos(0), dequeuePos(0), storeMutex(lock), running(false),
+          published(0), rejected(0), batches(0), lastLatencyMs(0), latencySink(nullptr) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots = new Slot[size];
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+        lists[0] = &achList;
+        lists[1] = &cardList;
+        lists[2] = &upiList;
+        lists[3] = &wireList;
+    }
+
+    ~IngestQueue() {
+        stop();
+        delete[] slots;
+    }
+
+    bool tryPush(Record* t) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            size_t seq = slot.sequence.load(memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    slot.record = t;
+                    slot.enqueuedAt = Clock::now();
+                    slot.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;   // full
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    // Blocks (yielding) while the ring is full, which is the backpressure
+    // producers see when the consumer falls behind.
+    void push(Record* t) {
+        while (!tryPush(t)) {
+            this_thread::yield();
+        }
+    }
+
+    void start() {
+        if (running) return;
+        running = true;
+        consumer = thread(&IngestQueue::run, this);
+    }
+
+    // Stops the consumer after everything already queued is published.
+    void stop() {
+        if (!running) return;
+        running = false;
+        if (consumer.joinable()) {
+            consumer.join();
+        }
+    }
+
+    void setLatencySink(vector<double>* sink) { latencySink = sink; }
+
+    // From now on fills time_since_last_transaction and velocity_score of
+    // every accepted record, with history seeded from the rows already in
+    // the lists; a window of 0 turns this off again. Only while the
+    // consumer is stopped.
+    bool computeFeatures(int64_t windowSeconds) {
+        if (running) {
+            return false;
+        }
+        features.reset(windowSeconds > 0 ? new AccountFeatures(windowSeconds) : nullptr);
+        if (!features) {
+            return true;
+        }
+        EpochGuard guard;
+        for (int c = 0; c < 4; ++c) {
+            lists[c]->forEach([this](const Record& t) { features->observe(t); });
+        }
+        return true;
+    }
+
+    const AccountFeatures* accountFeatures() const { return features.get(); }
+    bool isRunning() const { return running; }
+    uint64_t getPublished() const { return published; }
+    uint64_t getRejected() const { return rejected; }
+    uint64_t getBatches() const { return batches; }
+    double getLastLatencyMs() const { return lastLatencyMs; }
+};
+
+inline double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+// Builds n synthetic records spread over the four channels.
+template <typename Record>
+vector<Record*> makeBenchmarkRecords(int n) {
+    static const char* channels[4] = {"ACH", "card", "UPI", "wire_transfer"};
+    vector<Record*> records(n);
+    for (int i = 0; i < n; ++i) {
+        Record* t = new Record();
+        t->transaction_id = "B" + to_string(i);
+        t->amount = i % 1000;
+        t->velocity_score = i % 20;
+        t->time_since_last_transaction = t->spending_deviation_score = t->geo_anomaly_score = 0;
+        t->is_fraud = (i % 50 == 0) ? "True" : "False";
+        t->payment_channel = channels[i % 4];
+        records[i] = t;
+    }
+    return records;
+}
+
+// Pushes the same total number of records from 1-16 producer threads,
+// through the lock-free queue and through a plain mutex around
+// addTransaction, and reports throughput and enqueue-to-visible latency.
+void benchmarkIngestQueue(int totalRecords) {
+    typedef chrono::steady_clock Clock;
+    const int producerCounts[] = {1, 2, 4, 8, 16};
+
+    cout << "\nIngest Benchmark (" << totalRecords << " records, Array Implementation):" << endl;
+    cout << left << setw(14) << "Method" << right << setw(10) << "Producers" << setw(14) << "Rows/sec"
+         << setw(11) << "p50 (us)" << setw(11) << "p99 (us)" << setw(12) << "p99.9 (us)"
+         << setw(12) << "max (us)" << endl;
+
+    for (int producers : producerCounts) {
+        for (int method = 0; method < 2; ++method) {
+            ArrayTransactionList ach, card, upi, wire;
+            mutex storeMutex;
+            vector<ArrayTransaction*> records = makeBenchmarkRecords<ArrayTransaction>(totalRecords);
+            vector<double> latencies;
+            latencies.reserve(totalRecords);
+            vector<vector<double> > producerLatencies(producers);
+            atomic<bool> go(false);
+            vector<thread> threads;
+
+            IngestQueue<ArrayTransactionList> queue(ach, card, upi, wire, storeMutex);
+            queue.setLatencySink(&latencies);
+            if (method == 0) {
+                queue.start();
+            }
+
+            for (int p = 0; p < producers; ++p) {
+                threads.push_back(thread([&, p]() {
+                    while (!go) this_thread::yield();
+                    for (int i = p; i < totalRecords; i += producers) {
+                        if (method == 0) {
+                            queue.push(records[i]);
+                        } else {
+                            Clock::time_point at = Clock::now();
+                            lock_guard<mutex> guard(storeMutex);
+                            routeTransaction(records[i], ach, card, upi, wire);
+                            producerLatencies[p].push_back(
+                                chrono::duration<double, micro>(Clock::now() - at).count());
+                        }
+                    }
+                }));
+            }
+
+            Clock::time_point start = Clock::now();
+            go = true;
+            for (thread& t : threads) t.join();
+            if (method == 0) {
+                queue.stop();
+            } else {
+                for (const vector<double>& v : producerLatencies) {
+                    latencies.insert(latencies.end(), v.begin(), v.end());
+                }
+            }
+            double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+            sort(latencies.begin(), latencies.end());
+            cout << left << setw(14) << (method == 0 ? "lock-free" : "mutex") << right
+                 << setw(10) << producers << fixed << setprecision(0)
+                 << setw(14) << totalRecords / seconds << setprecision(1)
+                 << setw(11) << percentile(latencies, 50) << setw(11) << percentile(latencies, 99)
+                 << setw(12) << percentile(latencies, 99.9)
+                 << setw(12) << (latencies.empty() ? 0.0 : latencies.back()) << endl;
+            cout.unsetf(ios::fixed);
+            cout << setprecision(6);
+        }
+    }
+    cout << "Lock-free latency is enqueue -> batch visible to readers; mutex latency is lock wait + insert." << endl;
+}
+
+// One writer appends batches while reader threads scan the ACH list
+// continuously. Readers either run lock-free under an EpochGuard or take
+// the store mutex for every scan, which is how the menu worked before.
+template <typename List>
+void benchmarkConcurrentReads(const string& implementation, int totalRecords, int readers) {
+    typedef typename List::Record Record;
+    typedef chrono::steady_clock Clock;
+    const size_t batchRows = 1024;
+
+    for (int method = 0; method < 2; ++method) {
+        List lists[4];
+        mutex storeMutex;
+        vector<Record*> records = makeBenchmarkRecords<Record>(totalRecords);
+
+        // Preload half so readers have something to scan from the start
+        int preload = totalRecords / 2;
+        vector<Record*> groups[4];
+        for (int i = 0; i < preload; ++i) {
+            groups[channelIndex(records[i]->payment_channel)].push_back(records[i]);
+        }
+        for (int c = 0; c < 4; ++c) {
+            lists[c].addBatch(groups[c]);
+        }
+
+        atomic<bool> writing(true);
+        vector<double> batchLatencies;
+        vector<vector<double> > scanLatencies(readers);
+        vector<thread> threads;
+
+        for (int r = 0; r < readers; ++r) {
+            threads.push_back(thread([&, r]() {
+                while (writing) {
+                    Clock::time_point at = Clock::now();
+                    if (method == 0) {
+                        lists[0].countMatches("True", "fraud");
+                    } else {
+                        lock_guard<mutex> guard(storeMutex);
+                        lists[0].countMatches("True", "fraud");
+                    }
+                    scanLatencies[r].push_back(chrono::duration<double, milli>(Clock::now() - at).count());
+                }
+            }));
+        }
+
+        Clock::time_point start = Clock::now();
+        for (int i = preload; i < totalRecords; ) {
+            for (int c = 0; c < 4; ++c) {
+                groups[c].clear();
+            }
+            int end = min(totalRecords, i + (int)batchRows);
+            for (; i < end; ++i) {
+                groups[channelIndex(records[i]->payment_channel)].push_back(records[i]);
+            }
+            Clock::time_point at = Clock::now();
+            {
+                lock_guard<mutex> guard(storeMutex);
+                for (int c = 0; c < 4; ++c) {
+                    lists[c].addBatch(groups[c]);
+                }
+            }
+            batchLatencies.push_back(chrono::duration<double, milli>(Clock::now() - at).count());
+            epochManager().reclaim();
+        }
+        double seconds = chrono::duration<double>(Clock::now() - start).count();
+        writing = false;
+        for (thread& t : threads) t.join();
+        epochManager().reclaim();
+
+        vector<double> scans;
+        for (const vector<double>& v : scanLatencies) {
+            scans.insert(scans.end(), v.begin(), v.end());
+        }
+        sort(scans.begin(), scans.end());
+        sort(batchLatencies.begin(), batchLatencies.end());
+        cout << left << setw(14) << implementation << setw(10) << (method == 0 ? "epoch" : "mutex") << right
+             << fixed << setprecision(0) << setw(14) << (totalRecords - preload) / seconds
+             << setprecision(3) << setw(14) << percentile(batchLatencies, 99)
+             << setprecision(0) << setw(12) << scans.size() / seconds
+             << setprecision(3) << setw(12) << percentile(scans, 50) << setw(12) << percentile(scans, 99) << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+}
+
+void benchmarkConcurrentReads(int totalRecords) {
+    const int readers = 4;
+    cout << "\nConcurrent Read Benchmark (" << totalRecords << " records, 1 writer, "
+         << readers << " readers scanning ACH):" << endl;
+    cout << left << setw(14) << "Backend" << setw(10) << "Readers" << right << setw(14) << "Rows/sec"
+         << setw(14) << "Batch p99 ms" << setw(12) << "Scans/sec" << setw(12) << "Scan p50 ms"
+         << setw(12) << "Scan p99 ms" << endl;
+    benchmarkConcurrentReads<TransactionList>("Linked List", totalRecords, readers);
+    benchmarkConcurrentReads<ArrayTransactionList>("Array", totalRecords, readers);
+}
+
+// Live Tail Ingestion
+//
+// Follows an append-only CSV feed from a background thread. New bytes are
+// picked up on inotify change events (or a short poll elsewhere), complete
+// lines are parsed and pushed into the shared IngestQueue, one producer per
+// followed file. A trailing partial line is kept until the rest of it arrives.
+template <typename List>
+class LiveTail {
+private:
+    typedef typename List::Record Record;
+    typedef chrono::steady_clock Clock;
+
+    IngestQueue<List>& queue;
+    thread worker;
+    atomic<bool> running;
+
+    // Owned by the worker thread
+    string filename;
+    uint64_t offset;
+    uint64_t inode;
+    string pending;
+    bool skipHeader;
+
+    // Statistics, guarded by statsMutex
+    mutable mutex statsMutex;
+    uint64_t rowsIngested;
+    uint64_t rowsRejected;
+    uint64_t bytesBehind;
+    double lastLagMs;
+    Clock::time_point startedAt;
+    Clock::time_point lastRowAt;
+    deque<pair<Clock::time_point, uint64_t> > recentBatches;
+    string lastError;
+
+    bool statFile(uint64_t& size, uint64_t& fileInode) {
+#ifdef TDMS_HAVE_MMAP
+        struct stat st;
+        if (::stat(filename.c_str(), &st) != 0) {
+            return false;
+        }
+        size = (uint64_t)st.st_size;
+        fileInode = (uint64_t)st.st_ino;
+        return true;
+#else
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file.is_open()) {
+            return false;
+        }
+        size = (uint64_t)file.tellg();
+        fileInode = 0;
+        return true;
+#endif
+    }
+
+    // Reads everything appended since the last call and publishes it, in
+    // blocks of at most readBlockBytes so a long backlog is never held in
+    // memory at once; a partial last line carries over to the next block.
+    void readAppended(Clock::time_point noticedAt) {
+        static const size_t readBlockBytes = 4 << 20;
+        uint64_t size, fileInode;
+        if (!statFile(size, fileInode)) {
+            lock_guard<mutex> guard(statsMutex);
+            lastError = "cannot stat " + filename;
+            return;
+        }
+        if (size < offset || fileInode != inode) {
+            // Truncated or replaced (log rotation): start over on the new file
+            offset = 0;
+            inode = fileInode;
+            pending.clear();
+            skipHeader = true;
+        }
+        if (size <= offset) {
+            publish(vector<Record*>(), 0, size, noticedAt);
+            return;
+        }
+
+        ifstream file(filename, ios::binary);
+        file.seekg((streamoff)offset);
+        string chunk;
+        while (offset < size && running) {
+            chunk.resize((size_t)min<uint64_t>(size - offset, readBlockBytes));
+            file.read(&chunk[0], chunk.size());
+            chunk.resize((size_t)file.gcount());
+            if (chunk.empty()) {
+                break;
+            }
+            offset += chunk.size();
+            pending += chunk;
+
+            vector<Record*> batch;
+            uint64_t rejected = 0;
+            size_t lineStart = 0, newline;
+            while ((newline = pending.find('\n', lineStart)) != string::npos) {
+                string line = pending.substr(lineStart, newline - lineStart);
+                lineStart = newline + 1;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (skipHeader) {
+                    skipHeader = false;
+                    continue;
+                }
+                if (line.empty()) {
+                    continue;
+                }
+                Record* t = new Record();
+                try {
+                    parseTransactionCSV(line, *t);
+                    batch.push_back(t);
+                } catch (const exception&) {
+                    delete t;
+                    rejected++;
+                }
+            }
+            pending.erase(0, lineStart);
+            publish(batch, rejected, size, noticedAt);
+        }
+    }
+
+    void publish(const vector<Record*>& batch, uint64_t rejected, uint64_t size, Clock::time_point noticedAt) {
+        uint64_t accepted = batch.size();
+        for (Record* t : batch) {
+            queue.push(t);
+        }
+
+        Clock::time_point now = Clock::now();
+        lock_guard<mutex> guard(statsMutex);
+        bytesBehind = size > offset ? size - offset : 0;
+        rowsRejected += rejected;
+        if (accepted > 0) {
+            rowsIngested += accepted;
+            lastRowAt = now;
+            lastLagMs = chrono::duration<double, milli>(now - noticedAt).count();
+            recentBatches.push_back(make_pair(now, accepted));
+        }
+        while (!recentBatches.empty() && now - recentBatches.front().first > chrono::seconds(10)) {
+            recentBatches.pop_front();
+        }
+    }
+
+    void run() {
+#ifdef __linux__
+        int notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        int watch = -1;
+        if (notifyFd >= 0) {
+            watch = inotify_add_watch(notifyFd, filename.c_str(), IN_MODIFY | IN_CLOSE_WRITE |
+                                      IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+        }
+#endif
+        readAppended(Clock::now());
+        while (running) {
+            Clock::time_point noticedAt;
+#ifdef __linux__
+            if (notifyFd >= 0 && watch >= 0) {
+                struct pollfd pfd;
+                pfd.fd = notifyFd;
+                pfd.events = POLLIN;
+                int ready = poll(&pfd, 1, 250);
+                noticedAt = Clock::now();
+                if (ready > 0) {
+                    char events[4096];
+                    bool replaced = false;
+                    ssize_t n;
+                    while ((n = read(notifyFd, events, sizeof(events))) > 0) {
+                        for (char* p = events; p < events + n;) {
+                            const struct inotify_event* ev = (const struct inotify_event*)p;
+                            replaced |= (ev->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) != 0;
+                            p += sizeof(struct inotify_event) + ev->len;
+                        }
+                    }
+                    if (replaced) {
+                        inotify_rm_watch(notifyFd, watch);
+                        watch = inotify_add_watch(notifyFd, filename.c_str(), IN_MODIFY | IN_CLOSE_WRITE |
+                                                  IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+                    }
+                }
+            } else
+#endif
+            {
+                this_thread::sleep_for(chrono::milliseconds(200));
+                noticedAt = Clock::now();
+            }
+            // Re-check on timeouts too, in case an event was missed or the
+            // watch could not be re-established yet after a rotation.
+            readAppended(noticedAt);
+#ifdef __linux__
+            if (notifyFd >= 0 && watch < 0) {
+                watch = inotify_add_watch(notifyFd, filename.c_str(), IN_MODIFY | IN_CLOSE_WRITE |
+                                          IN_MOVE_SELF | IN_DELETE_SELF | IN_ATTRIB);
+            }
+#endif
+        }
+#ifdef __linux__
+        if (notifyFd >= 0) {
+            ::close(notifyFd);
+        }
+#endif
+    }
+
+public:
+    explicit LiveTail(IngestQueue<List>& ingestQueue)
+        : queue(ingestQueue), running(false), offset(0), inode(0), skipHeader(false),
+          rowsIngested(0), rowsRejected(0), bytesBehind(0), lastLagMs(0) {}
+
+    ~LiveTail() { stop(); }
+
+    // Starts following the file, either from its current end or from the
+    // first data row (the header line is skipped in that case).
+    bool start(const string& file, bool fromBeginning) {
+        if (running) {
+            cout << "Live tail is already running on " << filename << endl;
+            return false;
+        }
+        filename = file;
+        uint64_t size;
+        if (!statFile(size, inode)) {
+            cout << "Failed to open file: " << filename << endl;
+            return false;
+        }
+        offset = fromBeginning ? 0 : size;
+        skipHeader = fromBeginning;
+        pending.clear();
+        {
+            lock_guard<mutex> guard(statsMutex);
+            rowsIngested = rowsRejected = bytesBehind = 0;
+            lastLagMs = 0;
+            recentBatches.clear();
+            lastError.clear();
+            startedAt = lastRowAt = Clock::now();
+        }
+        queue.start();
+        running = true;
+        worker = thread(&LiveTail::run, this);
+        cout << "Following " << filename << (fromBeginning ? " from the beginning." : " from its current end.") << endl;
+        return true;
+    }
+
+    void stop() {
+        if (!running) {
+            return;
+        }
+        running = false;
+        if (worker.joinable()) {
+            worker.join();
+        }
+        cout << "Stopped following " << filename << "." << endl;
+    }
+
+    bool isRunning() const { return running; }
+
+    string statusLine() const {
+        lock_guard<mutex> guard(statsMutex);
+        Clock::time_point now = Clock::now();
+        uint64_t recent = 0;
+        for (const auto& batch : recentBatches) {
+            if (now - batch.first <= chrono::seconds(10)) recent += batch.second;
+        }
+        ostringstream out;
+        out << filename << ": " << rowsIngested << " rows, " << fixed << setprecision(0) << recent / 10.0
+            << " rows/s, lag " << setprecision(1) << lastLagMs << " ms, " << bytesBehind << " bytes behind";
+        return out.str();
+    }
+
+    void printStatus() const {
+        lock_guard<mutex> guard(statsMutex);
+        Clock::time_point now = Clock::now();
+        double running_for = chrono::duration<double>(now - startedAt).count();
+        uint64_t recent = 0;
+        for (const auto& batch : recentBatches) {
+            if (now - batch.first <= chrono::seconds(10)) recent += batch.second;
+        }
+        cout << "\nLive Tail Status:" << endl;
+        cout << "File: " << filename << (running ? " (following)" : " (stopped)") << endl;
+        cout << "Rows ingested: " << rowsIngested << " (" << rowsRejected << " rejected)" << endl;
+        cout << "Rows/second (last 10s): " << recent / 10.0 << endl;
+        cout << "Rows/second (since start): " << (running_for > 0 ? rowsIngested / running_for : 0.0) << endl;
+        cout << "Ingest lag (change noticed -> rows queued): " << lastLagMs << " ms" << endl;
+        cout << "Bytes not yet ingested: " << bytesBehind << endl;
+        cout << "Seconds since last row: " << chrono::duration<double>(now - lastRowAt).count() << endl;
+        if (!lastError.empty()) {
+            cout << "Last error: " << lastError << endl;
+        }
+    }
+};
+
+// Holds the store lock for the duration of a writer operation so it never
+// overlaps a live ingest batch. Readers use EpochGuard instead.
+class StoreGuard {
+private:
+    mutex* lock;
+
+public:
+    explicit StoreGuard(mutex* m) : lock(m) {
+        if (lock) lock->lock();
+    }
+    ~StoreGuard() {
+        if (lock) lock->unlock();
+    }
+};
+
+template <typename List>
+string liveStatusLine(const vector<unique_ptr<LiveTail<List> > >& tails, const IngestQueue<List>& queue) {
+    ostringstream out;
+    out << "[Live ingest: " << queue.getPublished() << " rows published in " << queue.getBatches()
+        << " batches, last batch " << fixed << setprecision(1) << queue.getLastLatencyMs() << " ms queued]";
+    for (const auto& tail : tails) {
+        if (tail->isRunning()) {
+            out << "\n  [" << tail->statusLine() << "]";
+        }
+    }
+    return out.str();
+}
+
+// Each followed file gets its own LiveTail producer; all of them feed the
+// one IngestQueue consumer.
+template <typename List>
+void liveTailMenu(vector<unique_ptr<LiveTail<List> > >& tails, IngestQueue<List>& queue,
+                  const string& loadedFile) {
+    int subChoice;
+    do {
+        cout << "\n=== Live Tail ===" << endl;
+        if (queue.isRunning()) {
+            cout << liveStatusLine(tails, queue) << endl;
+        }
+        cout << "1. Start Following a CSV Feed" << endl;
+        cout << "2. Show Status" << endl;
+        cout << "3. Stop All Feeds" << endl;
+        cout << "4. Back to Main Menu" << endl;
+        cout << "Enter choice: ";
+        cin >> subChoice;
+        clearInputBuffer();
+
+        switch (subChoice) {
+            case 1: {
+                string feed, fromStart;
+                cout << "Enter CSV filename to follow (blank for " << loadedFile << "): ";
+                getline(cin, feed);
+                if (feed.empty()) {
+                    feed = loadedFile;
+                }
+                cout << "Read existing rows from the beginning? (y/n): ";
+                getline(cin, fromStart);
+                if (!queue.isRunning()) {
+                    string answer, windowText;
+                    cout << "Recompute velocity_score and time_since_last_transaction? (y/n): ";
+                    getline(cin, answer);
+                    int64_t window = 0;
+                    if (!answer.empty() && (answer[0] == 'y' || answer[0] == 'Y')) {
+                        cout << "Velocity window in seconds (default 3600): ";
+                        getline(cin, windowText);
+                        window = windowText.empty() ? 3600 : atoll(windowText.c_str());
+                        if (window <= 0) {
+                            cout << "Invalid window length." << endl;
+                            break;
+                        }
+                    }
+                    auto seedStart = chrono::high_resolution_clock::now();
+                    queue.computeFeatures(window);
+                    chrono::duration<double, milli> seeded = chrono::high_resolution_clock::now() - seedStart;
+                    if (queue.accountFeatures()) {
+                        cout << "Successfully seeded account features for " << queue.accountFeatures()->accounts()
+                             << " senders from the loaded rows in " << fixed << setprecision(1) << seeded.count()
+                             << " ms." << endl;
+                        cout.unsetf(ios::fixed);
+                        cout << setprecision(6);
+                    }
+                }
+                unique_ptr<LiveTail<List> > tail(new LiveTail<List>(queue));
+                if (tail->start(feed, !fromStart.empty() && (fromStart[0] == 'y' || fromStart[0] == 'Y'))) {
+                    tails.push_back(move(tail));
+                }
+                break;
+            }
+            case 2:
+                for (const auto& tail : tails) {
+                    tail->printStatus();
+                }
+                cout << "\nIngest Queue:" << endl;
+                cout << "Rows published: " << queue.getPublished() << " in " << queue.getBatches() << " batches" << endl;
+                cout << "Rows rejected (unknown channel): " << queue.getRejected() << endl;
+                cout << "Queue latency of last batch: " << queue.getLastLatencyMs() << " ms" << endl;
+                if (const AccountFeatures* features = queue.accountFeatures()) {
+                    cout << "Features computed: " << features->rowsFilled() << " rows ("
+                         << features->rowsSkipped() << " without a timestamp), " << features->accounts()
+                         << " senders, " << features->windowSeconds() << " s velocity window, "
+                         << toMB(features->memoryBytes()) << " MB" << endl;
+                }
+                break;
+            case 3:
+                for (auto& tail : tails) {
+                    tail->stop();
+                }
+                tails.clear();
+                queue.stop();
+                break;
+            case 4:
+                break;
+            default:
+                cout << "Invalid choice." << endl;
+                break;
+        }
+    } while (subChoice != 4);
+}
+
+// Measured memory per channel and per structure, next to what the
+// counting allocator and the kernel report for the whole process.
+template <typename List>
+void printMemoryReport(const List& achList, const List& cardList, const List& upiList,
+                       const List& wireList, const string& implementation) {
+    const List* lists[4] = {&achList, &cardList, &upiList, &wireList};
+    const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    MemoryBreakdown totals;
+    int rows = 0;
+
+    cout << "\nMemory Report (" << implementation << " Implementation):" << endl;
+    cout << left << setw(15) << "Channel" << right << setw(10) << "Rows" << setw(13) << "Records MB"
+         << setw(13) << "Strings MB" << setw(13) << "Indexes MB" << setw(11) << "Total MB"
+         << setw(11) << "Bytes/row" << endl;
+    cout << fixed;
+    for (int c = 0; c < 4; ++c) {
+        MemoryBreakdown m;
+        lists[c]->accountMemory(m);
+        int count = lists[c]->getCount();
+        totals.records += m.records;
+        totals.strings += m.strings;
+        totals.indexes += m.indexes;
+        rows += count;
+        cout << left << setw(15) << names[c] << right << setw(10) << count << setprecision(1)
+             << setw(13) << toMB(m.records) << setw(13) << toMB(m.strings) << setw(13) << toMB(m.indexes)
+             << setw(11) << toMB(m.total()) << setprecision(0)
+             << setw(11) << (count ? (double)m.total() / count : 0.0) << endl;
+    }
+    cout << left << setw(15) << "All channels" << right << setw(10) << rows << setprecision(1)
+         << setw(13) << toMB(totals.records) << setw(13) << toMB(totals.strings) << setw(13) << toMB(totals.indexes)
+         << setw(11) << toMB(totals.total()) << setprecision(0)
+         << setw(11) << (rows ? (double)totals.total() / rows : 0.0) << endl;
+
+    size_t live = heapLiveBytes.load(memory_order_relaxed);
+    cout << setprecision(1);
+    cout << "Heap in use (all allocations): " << toMB(live) << " MB, peak "
+         << toMB(heapPeakBytes.load(memory_order_relaxed)) << " MB, "
+         << heapAllocations.load(memory_order_relaxed) << " allocations so far" << endl;
+    size_t rss, peakRss;
+    if (readProcessMemory(rss, peakRss)) {
+        cout << "Process RSS: " << toMB(rss) << " MB (peak " << toMB(peakRss) << " MB)" << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Loads a CSV, JSON/NDJSON or columnar archive file into either backend.
+bool importData(const string& filename, TransactionList& achList, TransactionList& cardList,
+                TransactionList& upiList, TransactionList& wireList) {
+    if (isColumnarArchive(filename)) {
+        return importColumnar(filename, achList, cardList, upiList, wireList, "Linked List");
+    } else if (isJSONFile(filename)) {
+        return importJSON(filename, achList, cardList, upiList, wireList, "Linked List");
+    }
+    return importCSV(filename, achList, cardList, upiList, wireList);
+}
+
+bool importData(const string& filename, ArrayTransactionList& achList, ArrayTransactionList& cardList,
+                ArrayTransactionList& upiList, ArrayTransactionList& wireList) {
+    if (isColumnarArchive(filename)) {
+        return importColumnar(filename, achList, cardList, upiList, wireList, "Array");
+    } else if (isJSONFile(filename)) {
+        return importJSON(filename, achList, cardList, upiList, wireList, "Array");
+    }
+    return importCSVArray(filename, achList, cardList, upiList, wireList);
+}
+
+struct BenchmarkResult {
+    string backend;
+    string operation;
+    vector<double> milliseconds;
+    PerfSample counters;   // summed over the timed runs, when --perf is on
+    long rowsPerRun;
+};
+
+struct BackendMemory {
+    string backend;
+    int rows;
+    size_t heapBytes;   // heap growth measured across the import
+    size_t dataBytes;   // accountMemory() total over all channels
+};
+
+// Creates a new empty file in the temporary directory and returns its
+// path, or "" on failure, so benchmark output never replaces a user's file.
+// The caller removes it.
+string makeTemporaryFile(const string& prefix) {
+#ifdef TDMS_HAVE_MMAP
+    const char* dir = getenv("TMPDIR");
+    string path = string(dir && *dir ? dir : "/tmp") + "/" + prefix + "XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        return "";
+    }
+    ::close(fd);
+    return path;
+#else
+    char name[L_tmpnam];
+    return tmpnam(name) ? string(name) : string();
+#endif
+}
+
+// Runs warmup + repetitions of one operation over all four channels with
+// output silenced, keeping only the timings after the warmup.
+template <typename List, typename Operation>
+void timeOperation(List* lists, const string& backend, const string& operation, Operation op,
+                   int warmup, int repetitions, vector<BenchmarkResult>& results) {
+    BenchmarkResult result = {backend, operation, vector<double>(), PerfSample(), 0};
+    for (int c = 0; c < 4; ++c) {
+        result.rowsPerRun += lists[c].getCount();
+    }
+    for (int run = 0; run < warmup + repetitions; ++run) {
+        PerfSample before = readPerfCounters();
+        auto start = chrono::high_resolution_clock::now();
+        {
+            SilenceOutput quiet;
+            for (int c = 0; c < 4; ++c) {
+                op(lists[c]);
+            }
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        PerfSample after = readPerfCounters();
+        epochManager().reclaim();
+        if (run >= warmup) {
+            result.milliseconds.push_back(elapsed.count());
+            result.counters += after - before;
+        }
+    }
+    results.push_back(result);
+}
+
+// Times import, linear search, binary search, export and sort on one
+// backend. load(lists) fills four fresh lists and returns false on error.
+template <typename List, typename Loader>
+bool benchmarkBackend(const string& backend, Loader load, const string& query, int warmup, int repetitions,
+                      vector<BenchmarkResult>& results, vector<BackendMemory>& memory) {
+    unique_ptr<List[]> lists;
+    BenchmarkResult imports = {backend, "import", vector<double>(), PerfSample(), 0};
+    BackendMemory usage = {backend, 0, 0, 0};
+    for (int run = 0; run < warmup + repetitions; ++run) {
+        lists.reset();
+        epochManager().reclaim();
+        lists.reset(new List[4]);
+        size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+        bool ok;
+        PerfSample before = readPerfCounters();
+        auto start = chrono::high_resolution_clock::now();
+        {
+            SilenceOutput quiet;
+            ok = load(lists.get());
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        PerfSample after = readPerfCounters();
+        if (!ok) {
+            cout << "Failed to load benchmark data for the " << backend << " backend." << endl;
+            return false;
+        }
+        size_t heapAfter = heapLiveBytes.load(memory_order_relaxed);
+        usage.heapBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+        if (run >= warmup) {
+            imports.milliseconds.push_back(elapsed.count());
+            imports.counters += after - before;
+        }
+    }
+
+    MemoryBreakdown data;
+    for (int c = 0; c < 4; ++c) {
+        lists[c].accountMemory(data);
+        usage.rows += lists[c].getCount();
+    }
+    imports.rowsPerRun = usage.rows;
+    results.push_back(imports);
+    usage.dataBytes = data.total();
+    memory.push_back(usage);
+
+    const string exportFile = makeTemporaryFile("tdms_benchmark_export_");
+    if (exportFile.empty()) {
+        cout << "Failed to create a temporary file for the export benchmark." << endl;
+        return false;
+    }
+    timeOperation(lists.get(), backend, "linear search",
+                  [&](List& list) { list.linearSearch(query, "location"); }, warmup, repetitions, results);
+    timeOperation(lists.get(), backend, "binary search",
+                  [&](List& list) { list.binarySearch(query, "location"); }, warmup, repetitions, results);
+    timeOperation(lists.get(), backend, "export JSON",
+                  [&](List& list) { list.exportToJSON(exportFile); }, warmup, repetitions, results);
+    remove(exportFile.c_str());
+
+    // Every sort run starts from freshly loaded, unsorted lists; the
+    // reload is not timed
+    BenchmarkResult sorts = {backend, "sort", vector<double>(), PerfSample(), usage.rows};
+    for (int run = 0; run < warmup + repetitions; ++run) {
+        if (run > 0) {
+            lists.reset();
+            epochManager().reclaim();
+            lists.reset(new List[4]);
+            SilenceOutput quiet;
+            if (!load(lists.get())) {
+                return false;
+            }
+        }
+        PerfSample before = readPerfCounters();
+        auto start = chrono::high_resolution_clock::now();
+        {
+            SilenceOutput quiet;
+            for (int c = 0; c < 4; ++c) {
+                lists[c].sortByLocation();
+            }
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        PerfSample after = readPerfCounters();
+        epochManager().reclaim();
+        if (run >= warmup) {
+            sorts.milliseconds.push_back(elapsed.count());
+            sorts.counters += after - before;
+        }
+    }
+    results.push_back(sorts);
+    return true;
+}
+
+// Empirical comparison of every backend on the same data: median, p95
+// and minimum time per operation, plus measured memory. Used as the
+// regression baseline for new builds.
+bool compareEfficiency(const string& dataFile, int repetitions = 5, int warmup = 1) {
+    vector<BenchmarkResult> results;
+    vector<BackendMemory> memory;
+
+    // The search key is the location of the first row, so every backend
+    // looks for the same value.
+    string query;
+    const string snapshotFile = makeTemporaryFile("tdms_benchmark_");
+    if (snapshotFile.empty()) {
+        cout << "Failed to create a temporary file for the snapshot benchmark." << endl;
+        return false;
+    }
+    {
+        ArrayTransactionList ach, card, upi, wire;
+        bool ok;
+        {
+            SilenceOutput quiet;
+            ok = importData(dataFile, ach, card, upi, wire);
+        }
+        if (!ok) {
+            cout << "Failed to load benchmark data: " << dataFile << endl;
+            remove(snapshotFile.c_str());
+            return false;
+        }
+        ArrayTransactionList* lists[4] = {&ach, &card, &upi, &wire};
+        for (int c = 0; c < 4 && query.empty(); ++c) {
+            if (lists[c]->getCount() > 0) {
+                lists[c]->view().forEach([&](const ArrayTransaction& t) {
+                    if (query.empty()) query = t.location;
+                });
+            }
+        }
+        SilenceOutput quiet;
+        saveSnapshot(snapshotFile, ach, card, upi, wire);
+    }
+
+    cout << "\nBenchmarking " << dataFile << " (" << warmup << " warmup, " << repetitions
+         << " timed runs per operation, search key location = " << query << ")..." << endl;
+
+    bool ok = benchmarkBackend<TransactionList>("Linked List", [&](TransactionList* l) {
+            return importData(dataFile, l[0], l[1], l[2], l[3]);
+        }, query, warmup, repetitions, results, memory)
+        && benchmarkBackend<ArrayTransactionList>("Array", [&](ArrayTransactionList* l) {
+            return importData(dataFile, l[0], l[1], l[2], l[3]);
+        }, query, warmup, repetitions, results, memory);
+
+    SnapshotFile snapshot;
+    if (ok) {
+        ok = benchmarkBackend<SnapshotTransactionList>("Snapshot", [&](SnapshotTransactionList* l) {
+            return loadSnapshot(snapshotFile, snapshot, l[0], l[1], l[2], l[3]);
+        }, query, warmup, repetitions, results, memory);
+    }
+    if (!ok) {
+        remove(snapshotFile.c_str());
+        return false;
+    }
+
+    cout << "\nPerformance Comparison (all four channels per run):" << endl;
+    cout << left << setw(14) << "Backend" << setw(16) << "Operation" << right << setw(13) << "Median ms"
+         << setw(13) << "p95 ms" << setw(13) << "Min ms" << endl;
+    cout << fixed << setprecision(3);
+    for (BenchmarkResult& r : results) {
+        sort(r.milliseconds.begin(), r.milliseconds.end());
+        cout << left << setw(14) << r.backend << setw(16) << r.operation << right
+             << setw(13) << percentile(r.milliseconds, 50) << setw(13) << percentile(r.milliseconds, 95)
+             << setw(13) << r.milliseconds.front() << endl;
+    }
+
+    cout << "\nMemory per backend:" << endl;
+    cout << left << setw(14) << "Backend" << right << setw(10) << "Rows" << setw(12) << "Heap MB"
+         << setw(12) << "Data MB" << setw(12) << "Bytes/row" << endl;
+    for (const BackendMemory& m : memory) {
+        cout << left << setw(14) << m.backend << right << setw(10) << m.rows << setprecision(1)
+             << setw(12) << toMB(m.heapBytes) << setw(12) << toMB(m.dataBytes) << setprecision(0)
+             << setw(12) << (m.rows ? (double)m.dataBytes / m.rows : 0.0) << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    cout << "Heap MB is measured across the import; snapshot data is memory-mapped, not heap." << endl;
+
+    bool haveCounters = false;
+    for (const BenchmarkResult& r : results) {
+        haveCounters = haveCounters || r.counters.any();
+    }
+    if (haveCounters) {
+        cout << "\nHardware counters per row (averaged over the timed runs):" << endl;
+        cout << left << setw(14) << "Backend" << setw(16) << "Operation" << right << setw(7) << "IPC";
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            cout << setw(15) << PERF_EVENT_NAMES[e];
+        }
+        cout << endl;
+        cout << fixed;
+        for (const BenchmarkResult& r : results) {
+            double rows = (double)max<long>(r.rowsPerRun, 1) * r.milliseconds.size();
+            const PerfSample& c = r.counters;
+            cout << left << setw(14) << r.backend << setw(16) << r.operation << right << setprecision(2) << setw(7);
+            if (c.available[PERF_CYCLES] && c.available[PERF_INSTRUCTIONS] && c.values[PERF_CYCLES] > 0) {
+                cout << c.values[PERF_INSTRUCTIONS] / c.values[PERF_CYCLES];
+            } else {
+                cout << "-";
+            }
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                cout << setw(15);
+                if (c.available[e]) {
+                    cout << setprecision(3) << c.values[e] / rows;
+                } else {
+                    cout << "-";
+                }
+            }
+            cout << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+
+    remove(snapshotFile.c_str());
+    return true;
+}
+
+// Text Search
+//
+// Prefix and substring search over location, merchant category and
+// transaction type. The matching runs over the distinct values rather
+// than the rows. Values are kept sorted, so the values with a prefix are
+// one range found by two binary searches, and a substring is found with
+// memmem over the values stored back to back. Snapshots already hold
+// sorted dictionaries and a code per row, so the matched codes are
+// counted in the code column. The Linked List and Array backends get a
+// ValueIndex: the sorted values of one field and the rows holding each,
+// built in one pass and rebuilt after rows are added or the list is
+// reordered.
+
+// The query field searched for a field name, or -1
+inline int textSearchField(const string& field) {
+    if (field == "location") return Q_LOCATION;
+    if (field == "merchant" || field == "merchant_category") return Q_MERCHANT;
+    if (field == "type" || field == "transaction_type") return Q_TYPE;
+    return -1;
+}
+
+// Codes of the sorted values that start with (or contain) text. Value i
+// is data[offsets[i], offsets[i + 1]).
+template <typename Offset>
+vector<uint32_t> matchSortedValues(const char* data, const Offset* offsets, size_t count, const string& text,
+                                   bool substring) {
+    vector<uint32_t> matched;
+    if (!substring) {
+        // Comparing only the first text.size() bytes, the values with the
+        // prefix compare equal and sit together
+        auto bound = [&](bool upper) {
+            size_t low = 0, high = count;
+            while (low < high) {
+                size_t mid = (low + high) / 2;
+                size_t length = offsets[mid + 1] - offsets[mid];
+                int order = memcmp(data + offsets[mid], text.data(), min(length, text.size()));
+                if (order == 0 && length < text.size()) order = -1;
+                if (order < 0 || (upper && order == 0)) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            return low;
+        };
+        for (size_t code = bound(false), end = bound(true); code < end; ++code) {
+            matched.push_back((uint32_t)code);
+        }
+        return matched;
+    }
+
+    if (text.empty()) {
+        for (size_t code = 0; code < count; ++code) matched.push_back((uint32_t)code);
+        return matched;
+    }
+    const char* end = data + offsets[count];
+    const char* from = data + offsets[0];
+    size_t code = 0;
+    while (from < end) {
+        const char* hit = (const char*)memmem(from, end - from, text.data(), text.size());
+        if (hit == nullptr) break;
+        Offset at = (Offset)(hit - data);
+        code = upper_bound(offsets + code, offsets + count, at) - offsets - 1;   // value holding the hit
+        if (at + text.size() <= offsets[code + 1]) {
+            matched.push_back((uint32_t)code);
+            from = data + offsets[code + 1];   // on to the next value
+        } else {
+            from = hit + 1;   // the hit runs into the next value
+        }
+    }
+    return matched;
+}
+
+template <typename List>
+class ValueIndex {
+private:
+    string values;                  // distinct values in sorted order, back to back
+    vector<uint32_t> valueOffsets;  // values + 1 entries into values
+    vector<uint32_t> rowCounts;     // rows holding each value
+    const List* built;
+    int count;
+    unsigned generation;
+    double buildMilliseconds;
+
+public:
+    ValueIndex() : built(nullptr), count(0), generation(0), buildMilliseconds(0) {}
+
+    void build(const List& list, int field) {
+        typedef typename List::Record Record;
+        auto start = chrono::high_resolution_clock::now();
+        built = &list;
+        count = list.getCount();
+        generation = list.rowGeneration();
+        unordered_map<string, uint32_t> rows;
+        string key;
+        list.forEachRef([&](typename List::RowRef, const Record& t) {
+            StringRef value = queryFieldRef(t, field);
+            key.assign(value.data(), value.size());
+            rows[key]++;
+        });
+
+        vector<pair<string, uint32_t> > sorted(rows.begin(), rows.end());
+        sort(sorted.begin(), sorted.end());
+        values.clear();
+        valueOffsets.assign(1, 0);
+        rowCounts.clear();
+        for (const pair<string, uint32_t>& entry : sorted) {
+            values += entry.first;
+            valueOffsets.push_back((uint32_t)values.size());
+            rowCounts.push_back(entry.second);
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        buildMilliseconds = elapsed.count();
+    }
+
+    // False once rows were added or the list was rebuilt since build()
+    bool current(const List& list) const {
+        return built == &list && count == list.getCount() && generation == list.rowGeneration();
+    }
+
+    vector<uint32_t> match(const string& text, bool substring) const {
+        return matchSortedValues(values.data(), valueOffsets.data(), rowCounts.size(), text, substring);
+    }
+
+    StringRef value(uint32_t code) const {
+        return StringRef(values.data() + valueOffsets[code], valueOffsets[code + 1] - valueOffsets[code]);
+    }
+
+    uint32_t rows(uint32_t code) const { return rowCounts[code]; }
+    size_t valueCount() const { return rowCounts.size(); }
+    int rowCount() const { return count; }
+    double buildTime() const { return buildMilliseconds; }
+};
+
+// The value index of one field of a list, rebuilt first if it is missing
+// or stale; rebuilt tells the caller which
+template <typename List>
+shared_ptr<const ValueIndex<List> > valueIndex(const List& list, int field, bool& rebuilt) {
+    static mutex lock;
+    static map<pair<const List*, int>, shared_ptr<const ValueIndex<List> > > indexes;
+    lock_guard<mutex> hold(lock);
+    shared_ptr<const ValueIndex<List> >& index = indexes[make_pair(&list, field)];
+    rebuilt = !index || !index->current(list);
+    if (rebuilt) {
+        shared_ptr<ValueIndex<List> > fresh = make_shared<ValueIndex<List> >();
+        fresh->build(list, field);
+        index = fresh;
+    }
+    return index;
+}
+
+// Prints the matched values, most rows first, and the total
+void printTextSearch(const string& field, const string& text, bool substring,
+                     vector<pair<StringRef, uint32_t> >& matched, size_t valueCount, double seconds) {
+    sort(matched.begin(), matched.end(), [](const pair<StringRef, uint32_t>& a, const pair<StringRef, uint32_t>& b) {
+        return a.second > b.second;
+    });
+    long found = 0;
+    for (const pair<StringRef, uint32_t>& entry : matched) {
+        found += entry.second;
+    }
+    cout << "\n" << (substring ? "Substring" : "Prefix") << " Search Results for " << field
+         << (substring ? " containing " : " starting with ") << "\"" << text << "\":" << endl;
+    cout << "Matched " << matched.size() << " of " << valueCount << " values";
+    for (size_t i = 0; i < matched.size() && i < 10; ++i) {
+        cout << (i == 0 ? ": " : ", ") << matched[i].first << " (" << matched[i].second << ")";
+    }
+    if (matched.size() > 10) {
+        cout << ", ... " << matched.size() - 10 << " more";
+    }
+    cout << endl;
+    cout << "Found " << found << " matches in " << seconds << " seconds" << endl;
+}
+
+template <typename List>
+void textSearch(const List& list, const string& field, const string& text, bool substring,
+                const string& implementation) {
+    int queryField = textSearchField(field);
+    if (queryField < 0) {
+        cout << "Prefix and substring search cover location, merchant and type, not " << field << "." << endl;
+        return;
+    }
+    if (list.getCount() == 0) {
+        cout << "No transactions to search." << endl;
+        return;
+    }
+    bool rebuilt;
+    shared_ptr<const ValueIndex<List> > index = valueIndex(list, queryField, rebuilt);
+    if (rebuilt) {
+        cout << "Successfully built " << field << " value index: " << index->valueCount() << " values from "
+             << index->rowCount() << " rows in " << fixed << setprecision(1) << index->buildTime() << " ms" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+
+    vector<pair<StringRef, uint32_t> > matched;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        LatencyTimer latency(implementation, substring ? "substring search" : "prefix search");
+        for (uint32_t code : index->match(text, substring)) {
+            matched.push_back(make_pair(index->value(code), index->rows(code)));
+        }
+    }
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+    printTextSearch(field, text, substring, matched, index->valueCount(), elapsed.count());
+}
+
+// Snapshot dictionaries are sorted and shared by all channels; the rows
+// of each code in this channel are counted once per snapshot
+inline void textSearch(const SnapshotTransactionList& list, const string& field, const string& text, bool substring,
+                       const string& implementation) {
+    int queryField = textSearchField(field);
+    if (queryField < 0) {
+        cout << "Prefix and substring search cover location, merchant and type, not " << field << "." << endl;
+        return;
+    }
+    if (list.getCount() == 0) {
+        cout << "No transactions to search." << endl;
+        return;
+    }
+    int dict = queryField == Q_LOCATION ? DICT_LOCATION : (queryField == Q_MERCHANT ? DICT_MERCHANT : DICT_TYPE);
+    const SnapshotDictionaryView& dictionary = list.dictionary(dict);
+
+    vector<pair<StringRef, uint32_t> > matched;
+    size_t present = 0;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        LatencyTimer latency(implementation, substring ? "substring search" : "prefix search");
+        vector<uint32_t> codes = matchSortedValues(dictionary.data, dictionary.offsets, dictionary.count, text, substring);
+        const vector<uint32_t>& rows = list.codeCounts(dict);
+        for (uint32_t code : codes) {
+            if (rows[code] > 0) matched.push_back(make_pair(dictionary.get(code), rows[code]));
+        }
+        for (uint32_t n : rows) {
+            present += n > 0;
+        }
+    }
+    chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+    printTextSearch(field, text, substring, matched, present, elapsed.count());
+}
+
+// The values of a field that start with (or contain) text, added to values
+template <typename List>
+void matchValues(const List& list, int field, const string& text, bool substring, vector<string>& values) {
+    bool rebuilt;
+    shared_ptr<const ValueIndex<List> > index = valueIndex(list, field, rebuilt);
+    for (uint32_t code : index->match(text, substring)) {
+        values.push_back(string(index->value(code)));
+    }
+}
+
+inline void matchValues(const SnapshotTransactionList& list, int field, const string& text, bool substring,
+                        vector<string>& values) {
+    int dict = field == Q_LOCATION ? DICT_LOCATION : (field == Q_MERCHANT ? DICT_MERCHANT : DICT_TYPE);
+    const SnapshotDictionaryView& dictionary = list.dictionary(dict);
+    const vector<uint32_t>& rows = list.codeCounts(dict);
+    for (uint32_t code : matchSortedValues(dictionary.data, dictionary.offsets, dictionary.count, text, substring)) {
+        if (rows[code] > 0) values.push_back(string(dictionary.get(code)));
+    }
+}
+
+// Turns each ^= and *= predicate into the set of values it matches in
+// the lists, so rows are then tested by a lookup among those values
+// instead of a prefix or substring test against each row
+template <typename List>
+void resolveValueSets(List* const lists[4], vector<QueryPredicate>& predicates) {
+    for (QueryPredicate& p : predicates) {
+        if (p.op != Q_PREFIX && p.op != Q_CONTAINS) continue;
+        vector<string> values;
+        for (int c = 0; c < 4; ++c) {
+            if (lists[c]->getCount() > 0) matchValues(*lists[c], p.field, p.text, p.op == Q_CONTAINS, values);
+        }
+        sort(values.begin(), values.end());
+        values.erase(unique(values.begin(), values.end()), values.end());
+        p.values = make_shared<const vector<string> >(move(values));
+    }
+}
+
+template <typename List>
+void channelMenu(List& list, const string& name, const string& implementation, mutex* storeLock = nullptr) {
+    int subChoice;
+    do {
+        int currentCount = list.getCount();
+        cout << "\n=== " << name << " Transactions (" << implementation << ") (" << currentCount << ") ===" << endl;
+        cout << "1. Display First 10 Transactions" << endl;
+        cout << "2. Display All Transactions" << endl;
+        cout << "3. Search by Transaction Type (Linear)" << endl;
+        cout << "4. Search by Location (Linear)" << endl;
+        cout << "5. Search by Fraud Status (Linear)" << endl;
+        cout << "6. Search by Transaction Type (Binary)" << endl;
+        cout << "7. Search by Location (Binary)" << endl;
+        cout << "8. Sort by Location" << endl;
+        cout << "9. Export to JSON" << endl;
+        cout << "10. Prefix / Substring Search (Location, Merchant or Type)" << endl;
+        cout << "11. Back to Main Menu" << endl;
+        cout << "Enter choice: ";
+        cin >> subChoice;
+        clearInputBuffer();
+
+        switch (subChoice) {
+            case 1: {
+                list.displayTransactions(10);
+                break;
+            }
+            case 2: {
+                list.displayTransactions(-1);
+                break;
+            }
+            case 3: {
+                string searchType;
+                cout << "Enter transaction type to search (Linear): ";
+                getline(cin, searchType);
+                list.linearSearch(searchType, "type");
+                break;
+            }
+            case 4: {
+                string searchLocation;
+                cout << "Enter location to search (Linear): ";
+                getline(cin, searchLocation);
+                list.linearSearch(searchLocation, "location");
+                break;
+            }
+            case 5: {
+                string searchFraud;
+                cout << "Enter fraud status to search (Linear): ";
+                getline(cin, searchFraud);
+                list.linearSearch(searchFraud, "fraud");
+                break;
+            }
+            case 6: {
+                string searchType;
+                cout << "Enter transaction type to search (Binary): ";
+                getline(cin, searchType);
+                list.binarySearch(searchType, "type");
+                break;
+            }
+            case 7: {
+                string searchLocation;
+                cout << "Enter location to search (Binary): ";
+                getline(cin, searchLocation);
+                list.binarySearch(searchLocation, "location");
+                break;
+            }
+            case 8: {
+                // Sorting publishes a new version, so it is serialised with
+                // live ingest; every other operation is a lock-free reader.
+                StoreGuard guard(storeLock);
+                list.sortByLocation();
+                epochManager().reclaim();
+                break;
+            }
+            case 9: {
+                string filename;
+                cout << "Enter filename to export (e.g., ach_transactions.json): ";
+                getline(cin, filename);
+                list.exportToJSON(filename);
+                break;
+            }
+            case 10: {
+                string field, mode, text;
+                cout << "Enter field (location, merchant or type): ";
+                getline(cin, field);
+                cout << "Match values that start with or contain the text (prefix/substring): ";
+                getline(cin, mode);
+                if (mode != "prefix" && mode != "substring") {
+                    cout << "Invalid mode." << endl;
+                    break;
+                }
+                cout << "Enter text to search for: ";
+                getline(cin, text);
+                textSearch(list, field, text, mode == "substring", implementation);
+                break;
+            }
+            case 11:
+                break;
+            default:
+                cout << "Invalid choice." << endl;
+                break;
+        }
+    } while (subChoice != 11);
+}
+
+// Group-By Aggregation
+//
+// One pass over the selected channels accumulates count, sum, min, max and
+// fraud count per group and channel; totals, means and fraud rates are
+// derived afterwards. Snapshot lists aggregate categorical columns straight
+// from their dictionary codes into a dense array, reading only the code,
+// amount and fraud columns. Every other case hashes the key text into an
+// open-addressing table whose keys point into the records, so no string is
+// copied until the result is built.
+struct GroupAccumulator {
+    long count;
+    long fraud;
+    double sum, minimum, maximum;
+
+    GroupAccumulator() : count(0), fraud(0), sum(0), minimum(0), maximum(0) {}
+
+    void add(double amount, bool isFraud) {
+        if (count == 0 || amount < minimum) minimum = amount;
+        if (count == 0 || amount > maximum) maximum = amount;
+        sum += amount;
+        fraud += isFraud;
+        count++;
+    }
+
+    void merge(const GroupAccumulator& other) {
+        if (other.count == 0) return;
+        if (count == 0 || other.minimum < minimum) minimum = other.minimum;
+        if (count == 0 || other.maximum > maximum) maximum = other.maximum;
+        sum += other.sum;
+        fraud += other.fraud;
+        count += other.count;
+    }
+
+    double mean() const { return count ? sum / count : 0.0; }
+    double fraudRate() const { return count ? (double)fraud / count : 0.0; }
+};
+
+struct GroupRow {
+    string key;
+    GroupAccumulator channels[4];
+
+    GroupAccumulator total() const {
+        GroupAccumulator all;
+        for (int c = 0; c < 4; ++c) all.merge(channels[c]);
+        return all;
+    }
+};
+
+struct GroupByResult {
+    int field;
+    vector<GroupRow> groups;   // sorted by key
+    long rows;                 // rows aggregated
+    bool usedCodes;            // dictionary codes rather than hashed keys
+    double milliseconds;
+
+    GroupByResult() : field(-1), rows(0), usedCodes(false), milliseconds(0) {}
+};
+
+// Only text fields group; numeric ones would give a group per value
+inline bool isGroupField(int field) {
+    return field >= 0 && !isNumericField(field);
+}
+
+inline int groupDictionary(int field) {
+    switch (field) {
+        case Q_TYPE: return DICT_TYPE;
+        case Q_MERCHANT: return DICT_MERCHANT;
+        case Q_LOCATION: return DICT_LOCATION;
+        case Q_DEVICE: return DICT_DEVICE;
+        case Q_FRAUD: return DICT_FRAUD;
+        case Q_FRAUD_TYPE: return DICT_FRAUD_TYPE;
+        case Q_CHANNEL: return DICT_CHANNEL;
+        default: return -1;
+    }
+}
+
+// Open-addressing (linear probing) map from key text to a group number.
+// Keys are StringRefs into the records, valid while the caller's epoch is
+// pinned.
+class GroupTable {
+private:
+    struct Slot {
+        StringRef key;
+        uint64_t hash;
+        int group;   // -1 while empty
+    };
+
+    vector<Slot> slots;
+    size_t mask;
+
+    static uint64_t hashKey(const StringRef& key) {
+        uint64_t h = 1469598103934665603ULL;   // FNV-1a
+        for (size_t i = 0; i < key.len; ++i) {
+            h = (h ^ (unsigned char)key.ptr[i]) * 1099511628211ULL;
+        }
+        return h;
+    }
+
+    void place(const StringRef& key, uint64_t hash, int group) {
+        size_t i = hash & mask;
+        while (slots[i].group >= 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i].key = key;
+        slots[i].hash = hash;
+        slots[i].group = group;
+    }
+
+    void grow() {
+        vector<Slot> old;
+        old.swap(slots);
+        slots.resize(old.size() * 2);
+        mask = slots.size() - 1;
+        for (Slot& s : slots) s.group = -1;
+        for (const Slot& s : old) {
+            if (s.group >= 0) place(s.key, s.hash, s.group);
+        }
+    }
+
+public:
+    vector<StringRef> keys;
+    vector<GroupAccumulator> accumulators;   // group * 4 + channel
+
+    GroupTable() : slots(64), mask(63) {
+        for (Slot& s : slots) s.group = -1;
+    }
+
+    GroupAccumulator& at(const StringRef& key, int channel) {
+        uint64_t h = hashKey(key);
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot& s = slots[i];
+            if (s.group < 0) {
+                break;
+            }
+            if (s.hash == h && s.key.len == key.len && memcmp(s.key.ptr, key.ptr, key.len) == 0) {
+                return accumulators[s.group * 4 + channel];
+            }
+        }
+        int group = (int)keys.size();
+        keys.push_back(key);
+        accumulators.resize(accumulators.size() + 4);
+        if (keys.size() * 2 > slots.size()) {
+            grow();   // keeps the load factor at or below one half
+        }
+        place(key, h, group);
+        return accumulators[group * 4 + channel];
+    }
+};
+
+template <typename List>
+void groupByRows(List* const lists[4], const bool selected[4], int field,
+                 const vector<QueryPredicate>& predicates, GroupByResult& result) {
+    typedef typename List::Record Record;
+    static const string fraudValue = "True";
+    GroupTable table;
+    EpochGuard guard;   // table keys point into the records until they are copied below
+    for (int c = 0; c < 4; ++c) {
+        if (!selected[c]) continue;
+        lists[c]->view().forEach([&](const Record& t) {
+            if (!predicates.empty() && !matchesQuery(t, predicates)) {
+                return;
+            }
+            table.at(queryFieldRef(t, field), c).add(t.amount, t.is_fraud == fraudValue);
+            result.rows++;
+        });
+    }
+    result.groups.resize(table.keys.size());
+    for (size_t g = 0; g < table.keys.size(); ++g) {
+        result.groups[g].key = table.keys[g];
+        for (int c = 0; c < 4; ++c) {
+            result.groups[g].channels[c] = table.accumulators[g * 4 + c];
+        }
+    }
+}
+
+inline void finishGroupBy(GroupByResult& result, chrono::high_resolution_clock::time_point start) {
+    sort(result.groups.begin(), result.groups.end(),
+         [](const GroupRow& a, const GroupRow& b) { return a.key < b.key; });
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    result.milliseconds = elapsed.count();
+}
+
+// Groups the selected channels by a text field, keeping only rows that
+// match every predicate
+template <typename List>
+void groupBy(List* const lists[4], const bool selected[4], int field,
+             const vector<QueryPredicate>& predicates, GroupByResult& result) {
+    auto start = chrono::high_resolution_clock::now();
+    result = GroupByResult();
+    result.field = field;
+    groupByRows(lists, selected, field, predicates, result);
+    finishGroupBy(result, start);
+}
+
+// Snapshot lists share the file's dictionaries, so the code of a value is
+// the same in every channel and an unfiltered group-by never decodes a row
+void groupBy(SnapshotTransactionList* const lists[4], const bool selected[4], int field,
+             const vector<QueryPredicate>& predicates, GroupByResult& result) {
+    auto start = chrono::high_resolution_clock::now();
+    result = GroupByResult();
+    result.field = field;
+    int dict = groupDictionary(field);
+    const SnapshotTransactionList* attached = nullptr;
+    for (int c = 0; c < 4; ++c) {
+        if (lists[c]->getCount() > 0) attached = lists[c];
+    }
+    if (dict < 0 || !predicates.empty() || attached == nullptr) {
+        groupByRows(lists, selected, field, predicates, result);
+        finishGroupBy(result, start);
+        return;
+    }
+
+    const SnapshotDictionaryView& dictionary = attached->dictionary(dict);
+    uint32_t fraudCode = 0;
+    bool hasFraud = attached->dictionary(DICT_FRAUD).find("True", fraudCode);
+    uint32_t size = (uint32_t)dictionary.count;
+    vector<GroupAccumulator> accumulators((size_t)size * 4);
+    for (int c = 0; c < 4; ++c) {
+        int n = lists[c]->getCount();
+        if (!selected[c] || n == 0) continue;
+        const uint32_t* keyCodes = lists[c]->codeColumn(dict);
+        const uint32_t* fraudCodes = lists[c]->codeColumn(DICT_FRAUD);
+        const double* amounts = lists[c]->numericColumn(NUM_AMOUNT);
+        for (int i = 0; i < n; ++i) {
+            uint32_t code = keyCodes[i];
+            if (code < size) {
+                accumulators[(size_t)code * 4 + c].add(amounts[i], hasFraud && fraudCodes[i] == fraudCode);
+            }
+        }
+        result.rows += n;
+    }
+    for (uint32_t code = 0; code < size; ++code) {
+        GroupRow row;
+        long total = 0;
+        for (int c = 0; c < 4; ++c) {
+            row.channels[c] = accumulators[(size_t)code * 4 + c];
+            total += row.channels[c].count;
+        }
+        if (total > 0) {
+            row.key = dictionary.get(code);
+            result.groups.push_back(row);
+        }
+    }
+    result.usedCodes = true;
+    finishGroupBy(result, start);   // dictionaries are sorted, so this is already in order
+}
+
+void printGroupBy(const GroupByResult& result, bool perChannel, size_t maxGroups = 100) {
+    static const char* channelNames[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    cout << "\nGroup-By " << queryFieldNames[result.field] << ": " << result.rows << " transactions in "
+         << result.groups.size() << " groups (" << fixed << setprecision(3) << result.milliseconds << " ms, "
+         << (result.usedCodes ? "dictionary codes" : "hashed keys") << ")" << endl;
+    cout << left << setw(24) << "Group" << right << setw(10) << "Count" << setw(16) << "Sum" << setw(12) << "Mean"
+         << setw(11) << "Min" << setw(11) << "Max" << setw(9) << "Fraud %" << endl;
+    auto printRow = [](const string& label, const GroupAccumulator& g) {
+        cout << left << setw(24) << label.substr(0, 23) << right << setw(10) << g.count << setprecision(2)
+             << setw(16) << g.sum << setw(12) << g.mean() << setw(11) << g.minimum << setw(11) << g.maximum
+             << setw(9) << g.fraudRate() * 100.0 << endl;
+    };
+    GroupAccumulator all;
+    for (size_t i = 0; i < result.groups.size(); ++i) {
+        const GroupRow& row = result.groups[i];
+        GroupAccumulator total = row.total();
+        all.merge(total);
+        if (i >= maxGroups) continue;
+        printRow(row.key.empty() ? "(empty)" : row.key, total);
+        if (perChannel) {
+            for (int c = 0; c < 4; ++c) {
+                if (row.channels[c].count > 0) printRow(string("  ") + channelNames[c], row.channels[c]);
+            }
+        }
+    }
+    if (result.groups.size() > maxGroups) {
+        cout << "... " << (result.groups.size() - maxGroups) << " more groups" << endl;
+    }
+    printRow("All groups", all);
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+template <typename List>
+void groupByMenu(List* lists[4]) {
+    string fieldName, answer;
+    cout << "Group by (type, merchant, location, device, fraud, fraud_type, channel, ...): ";
+    getline(cin, fieldName);
+    int field = queryFieldIndex(fieldName);
+    if (!isGroupField(field)) {
+        cout << "Cannot group by '" << fieldName << "'." << endl;
+        return;
+    }
+    cout << "Break each group down by channel? (y/n): ";
+    getline(cin, answer);
+    bool selected[4] = {true, true, true, true};
+    GroupByResult result;
+    groupBy(lists, selected, field, vector<QueryPredicate>(), result);
+    printGroupBy(result, !answer.empty() && (answer[0] == 'y' || answer[0] == 'Y'));
+}
+
+// Time Window Reports
+
+void printWindowTable(const string& title, int64_t width, int64_t start, int windowCount,
+                      const TimeWindows* const windows[4]) {
+    vector<WindowBucket> buckets[4];
+    for (int c = 0; c < 4; ++c) {
+        buckets[c] = windows[c]->tumbling(width, start, windowCount);
+    }
+    cout << "\n" << title << ":" << endl;
+    cout << left << setw(21) << "Window start" << right << setw(8) << "ACH" << setw(8) << "Card" << setw(8) << "UPI"
+         << setw(8) << "Wire" << setw(9) << "Total" << setw(16) << "Amount" << setw(8) << "Fraud" << endl;
+    for (int i = 0; i < windowCount; ++i) {
+        WindowBucket total;
+        cout << left << setw(21) << formatTimestamp(TimeWindows::bucketStart(start, width) + i * width) << right;
+        for (int c = 0; c < 4; ++c) {
+            cout << setw(8) << buckets[c][i].count;
+            total.merge(buckets[c][i]);
+        }
+        cout << setw(9) << total.count << setprecision(2) << setw(16) << total.amount << setw(8) << total.fraud << endl;
+    }
+}
+
+// Prints the latest hourly and per-minute tumbling windows over all
+// channels, each channel's sliding window of the given length ending at its
+// latest row, and then either one sender account's sliding window or the
+// busiest accounts of each channel.
+template <typename List>
+void printTimeWindows(List* const lists[4], int64_t seconds, const string& account, size_t topAccounts = 5) {
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    auto start = chrono::high_resolution_clock::now();
+    const TimeWindows* windows[4];
+    int64_t earliest = numeric_limits<int64_t>::max(), latest = numeric_limits<int64_t>::min();
+    int64_t channelLatest[4];
+    long rows = 0, skipped = 0;
+    for (int c = 0; c < 4; ++c) {
+        windows[c] = &lists[c]->timeWindows();
+        int64_t from, to;
+        long windowed, unparsed;
+        channelLatest[c] = numeric_limits<int64_t>::min();
+        if (windows[c]->range(from, to, windowed, unparsed)) {
+            earliest = min(earliest, from);
+            latest = max(latest, to);
+            channelLatest[c] = to;
+        }
+        rows += windowed;
+        skipped += unparsed;
+    }
+    if (rows == 0) {
+        cout << "No transactions with a valid timestamp to window." << endl;
+        return;
+    }
+
+    cout << "\nTime Windows: " << rows << " transactions from " << formatTimestamp(earliest) << " to "
+         << formatTimestamp(latest);
+    if (skipped > 0) {
+        cout << " (" << skipped << " without a valid timestamp)";
+    }
+    cout << endl << fixed;
+    printWindowTable("Hourly windows, last 24 hours", TimeWindows::HOUR, latest - 23 * 3600, 24, windows);
+    printWindowTable("Minute windows, last 15 minutes", TimeWindows::MINUTE, latest - 14 * 60, 15, windows);
+
+    cout << "\nSliding " << seconds << " s window ending at each channel's latest transaction:" << endl;
+    cout << left << setw(15) << "Channel" << setw(21) << "Window end" << right << setw(8) << "Count"
+         << setw(16) << "Amount" << setw(8) << "Fraud" << endl;
+    for (int c = 0; c < 4; ++c) {
+        if (channelLatest[c] == numeric_limits<int64_t>::min()) continue;
+        WindowBucket w = windows[c]->sliding(channelLatest[c], seconds);
+        cout << left << setw(15) << names[c] << setw(21) << formatTimestamp(channelLatest[c]) << right
+             << setw(8) << w.count << setprecision(2) << setw(16) << w.amount << setw(8) << w.fraud << endl;
+    }
+
+    if (!account.empty()) {
+        int64_t end = numeric_limits<int64_t>::min();
+        for (int c = 0; c < 4; ++c) {
+            int64_t time;
+            if (windows[c]->accountLatest(account, time)) end = max(end, time);
+        }
+        if (end == numeric_limits<int64_t>::min()) {
+            cout << "\nNo transactions from account " << account << "." << endl;
+        } else {
+            cout << "\nAccount " << account << ", sliding " << seconds << " s window ending at "
+                 << formatTimestamp(end) << ":" << endl;
+            WindowBucket total;
+            for (int c = 0; c < 4; ++c) {
+                WindowBucket w = windows[c]->accountWindow(account, end, seconds);
+                total.merge(w);
+                cout << left << setw(15) << names[c] << right << setw(8) << w.count << setprecision(2)
+                     << setw(16) << w.amount << setw(8) << w.fraud << endl;
+            }
+            cout << left << setw(15) << "All channels" << right << setw(8) << total.count << setprecision(2)
+                 << setw(16) << total.amount << setw(8) << total.fraud << endl;
+        }
+    } else {
+        cout << "\nBusiest sender accounts, sliding " << seconds << " s window ending at each account's latest transaction:"
+             << endl;
+        for (int c = 0; c < 4; ++c) {
+            vector<pair<string, WindowBucket> > busiest = windows[c]->busiestAccounts(seconds, topAccounts);
+            if (busiest.empty()) continue;
+            cout << names[c] << ":" << endl;
+            for (const auto& entry : busiest) {
+                cout << "  " << left << setw(13) << entry.first << right << setw(8) << entry.second.count
+                     << setprecision(2) << setw(16) << entry.second.amount << setw(8) << entry.second.fraud << endl;
+            }
+        }
+    }
+
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    cout << setprecision(3) << "Successfully reported time windows in " << elapsed.count() << " ms." << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Window length for sliding windows; tumbling windows are fixed at a minute
+// and an hour.
+inline bool parseWindowSeconds(const string& text, int64_t& seconds) {
+    char* end = nullptr;
+    long long value = strtoll(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value < 1 || value > TimeWindows::HISTORY) {
+        cout << "Window length must be between 1 and " << TimeWindows::HISTORY << " seconds." << endl;
+        return false;
+    }
+    seconds = value;
+    return true;
+}
+
+template <typename List>
+void timeWindowMenu(List* lists[4]) {
+    string text, account;
+    int64_t seconds = 3600;
+    cout << "Sliding window length in seconds (default 3600): ";
+    getline(cin, text);
+    if (!text.empty() && !parseWindowSeconds(text, seconds)) {
+        return;
+    }
+    cout << "Sender account to follow (blank for the busiest accounts): ";
+    getline(cin, account);
+    printTimeWindows(lists, seconds, account);
+}
+
+// Quantile Reports
+
+inline int sketchMetricIndex(const string& name) {
+    for (int m = 0; m < SKETCH_COUNT; ++m) {
+        if (name == sketchMetricNames[m]) return m;
+    }
+    return -1;
+}
+
+// Prints count, minimum, p50, p95, p99 and maximum of one metric per
+// channel and over all channels, merged from the per-location digests. With
+// perLocation, every location follows with its per-channel rows.
+template <typename List>
+void printQuantiles(List* const lists[4], int metric, bool perLocation) {
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    auto start = chrono::high_resolution_clock::now();
+    map<string, QuantileSketches::LocationDigests> digests[4];
+    TDigest channels[4], all;
+    map<string, TDigest> locations;
+    for (int c = 0; c < 4; ++c) {
+        digests[c] = lists[c]->quantileSketches().snapshot();
+        for (const auto& entry : digests[c]) {
+            channels[c].merge(entry.second.metrics[metric]);
+            locations[entry.first].merge(entry.second.metrics[metric]);
+        }
+        all.merge(channels[c]);
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    if (all.count() == 0) {
+        cout << "No transactions to summarize." << endl;
+        return;
+    }
+
+    cout << "\nQuantiles of " << sketchMetricNames[metric] << " (t-digest): " << (long)all.count() << " values in "
+         << locations.size() << " locations (" << fixed << setprecision(3) << elapsed.count() << " ms)" << endl;
+    cout << left << setw(24) << "Group" << right << setw(10) << "Count" << setw(12) << "Min" << setw(12) << "p50"
+         << setw(12) << "p95" << setw(12) << "p99" << setw(12) << "Max" << endl;
+    int digits = metric == SKETCH_AMOUNT ? 2 : 3;
+    auto printRow = [digits](const string& label, TDigest& d) {
+        cout << left << setw(24) << label.substr(0, 23) << right << setw(10) << (long)d.count() << setprecision(digits)
+             << setw(12) << d.smallest() << setw(12) << d.quantile(0.50) << setw(12) << d.quantile(0.95)
+             << setw(12) << d.quantile(0.99) << setw(12) << d.largest() << endl;
+    };
+    for (int c = 0; c < 4; ++c) {
+        if (channels[c].count() > 0) printRow(names[c], channels[c]);
+    }
+    printRow("All channels", all);
+    if (perLocation) {
+        cout << "By location:" << endl;
+        for (auto& entry : locations) {
+            printRow(entry.first.empty() ? "(empty)" : entry.first, entry.second);
+            for (int c = 0; c < 4; ++c) {
+                auto found = digests[c].find(entry.first);
+                if (found != digests[c].end()) {
+                    printRow(string("  ") + names[c], found->second.metrics[metric]);
+                }
+            }
+        }
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+template <typename List>
+void quantileMenu(List* lists[4]) {
+    string name, answer;
+    cout << "Metric (amount, spending_deviation, geo_anomaly): ";
+    getline(cin, name);
+    int metric = sketchMetricIndex(name);
+    if (metric < 0) {
+        cout << "Unknown metric '" << name << "'." << endl;
+        return;
+    }
+    cout << "Break down by location? (y/n): ";
+    getline(cin, answer);
+    printQuantiles(lists, metric, !answer.empty() && (answer[0] == 'y' || answer[0] == 'Y'));
+}
+
+// Distinct Count Reports
+
+static const char* const distinctFieldLabels[DISTINCT_COUNT] = {"Senders", "IPs", "Devices"};
+
+// Exact distinct values of one group, for validating the sketches
+struct ExactDistinct {
+    unordered_set<string> fields[DISTINCT_COUNT];
+};
+
+// Prints the estimated distinct sender accounts, IP addresses and device
+// hashes per channel and over all channels, merged from the channel
+// sketches. by is "channel", "location" or "day"; the latter two add a row
+// per group, merged across channels. With exact, the same counts are also
+// taken with hash sets, and the error and measured set memory are shown.
+template <typename List>
+void printDistinctCounts(List* const lists[4], const string& by, bool exact, size_t maxGroups = 100) {
+    typedef typename List::Record Record;
+    typedef DistinctSketches::FieldSketches FieldSketches;
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    bool grouped = by != "channel";
+    auto start = chrono::high_resolution_clock::now();
+    FieldSketches channels[4], all(DistinctSketches::TOTAL_PRECISION);
+    map<string, FieldSketches> groups;
+    size_t sketchBytes = 0;
+    int rows = 0;
+    for (int c = 0; c < 4; ++c) {
+        const DistinctSketches& sketches = lists[c]->distinctSketches();
+        channels[c] = sketches.channelTotal();
+        all.merge(channels[c]);
+        sketchBytes += channels[c].memoryBytes();
+        if (grouped) {
+            for (const auto& entry : sketches.groups(by == "day")) {
+                groups[entry.first].merge(entry.second);
+                sketchBytes += entry.second.memoryBytes();
+            }
+        }
+        rows += lists[c]->getCount();
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    if (rows == 0) {
+        cout << "No transactions to count." << endl;
+        return;
+    }
+
+    ExactDistinct exactChannels[4], exactAll;
+    map<string, ExactDistinct> exactGroups;
+    size_t exactBytes = 0;
+    chrono::duration<double, milli> exactElapsed(0);
+    if (exact) {
+        size_t heapBefore = heapLiveBytes.load(memory_order_relaxed);
+        auto exactStart = chrono::high_resolution_clock::now();
+        EpochGuard guard;
+        for (int c = 0; c < 4; ++c) {
+            lists[c]->view().forEach([&](const Record& t) {
+                string values[DISTINCT_COUNT] = {t.sender_account, t.ip_address, t.device_hash};
+                ExactDistinct* group = nullptr;
+                if (grouped) {
+                    group = &exactGroups[by == "day" ? string(t.timestamp.data(), min(t.timestamp.size(), (size_t)10))
+                                                     : string(t.location)];
+                }
+                for (int f = 0; f < DISTINCT_COUNT; ++f) {
+                    exactChannels[c].fields[f].insert(values[f]);
+                    exactAll.fields[f].insert(values[f]);
+                    if (group) group->fields[f].insert(values[f]);
+                }
+            });
+        }
+        exactElapsed = chrono::high_resolution_clock::now() - exactStart;
+        size_t heapAfter = heapLiveBytes.load(memory_order_relaxed);
+        exactBytes = heapAfter > heapBefore ? heapAfter - heapBefore : 0;
+    }
+
+    cout << "\nDistinct Counts (HyperLogLog, " << fixed << setprecision(3) << elapsed.count() << " ms):" << endl;
+    cout << left << setw(24) << "Group" << right;
+    for (int f = 0; f < DISTINCT_COUNT; ++f) {
+        cout << setw(10) << distinctFieldLabels[f];
+        if (exact) cout << setw(10) << "Exact" << setw(8) << "Err %";
+    }
+    cout << endl;
+    auto printRow = [exact](const string& label, const FieldSketches& s, const ExactDistinct* e) {
+        cout << left << setw(24) << label.substr(0, 23) << right;
+        for (int f = 0; f < DISTINCT_COUNT; ++f) {
+            double estimate = s.fields[f].estimate();
+            cout << setprecision(0) << setw(10) << estimate;
+            if (exact) {
+                size_t actual = e ? e->fields[f].size() : 0;
+                cout << setw(10) << actual << setprecision(2) << setw(8)
+                     << (actual ? (estimate - actual) * 100.0 / actual : 0.0);
+            }
+        }
+        cout << endl;
+    };
+    for (int c = 0; c < 4; ++c) {
+        if (lists[c]->getCount() > 0) printRow(names[c], channels[c], &exactChannels[c]);
+    }
+    printRow("All channels", all, &exactAll);
+    if (grouped) {
+        cout << "By " << by << ":" << endl;
+        size_t shown = 0;
+        for (const auto& entry : groups) {
+            if (shown++ >= maxGroups) break;
+            auto found = exactGroups.find(entry.first);
+            printRow(entry.first.empty() ? "(empty)" : entry.first, entry.second,
+                     found == exactGroups.end() ? nullptr : &found->second);
+        }
+        if (groups.size() > maxGroups) {
+            cout << "... " << (groups.size() - maxGroups) << " more groups" << endl;
+        }
+    }
+    cout << setprecision(1) << "Sketch memory: " << sketchBytes / 1024.0 << " KB";
+    if (exact) {
+        cout << "; exact sets: " << toMB(exactBytes) << " MB measured, built in " << setprecision(3)
+             << exactElapsed.count() << " ms";
+    }
+    cout << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+template <typename List>
+void distinctCountMenu(List* lists[4]) {
+    string by, answer;
+    cout << "Group by (channel, location, day): ";
+    getline(cin, by);
+    if (by.empty()) {
+        by = "channel";
+    } else if (by != "channel" && by != "location" && by != "day") {
+        cout << "Cannot count distinct values by '" << by << "'." << endl;
+        return;
+    }
+    cout << "Validate against exact counts? (y/n): ";
+    getline(cin, answer);
+    printDistinctCounts(lists, by, !answer.empty() && (answer[0] == 'y' || answer[0] == 'Y'));
+}
+
+// Top-K Queries
+//
+// The k rows with the largest (or smallest) value of a numeric field,
+// optionally restricted by predicates, without sorting. Each thread keeps
+// a heap of its best k candidates with the worst one at the root: a row
+// costs one comparison with the root and O(log k) only when it gets in,
+// and the predicates are only checked for rows that would get in. Work is
+// handed out in ranges of rows. A linked-list channel can only be walked
+// from its head and is one range; array and snapshot channels are cut
+// into ranges of 64K rows. The threads' heaps are merged at the end, so a
+// query is O(n log k) and its result does not depend on the split. Equal
+// values are ordered by transaction ID.
+template <typename RowRef>
+struct TopKEntry {
+    double key;   // the value, negated when the smallest are wanted
+    StringRef id;
+    int channel;
+    RowRef ref;
+};
+
+template <typename RowRef>
+inline bool topKBetter(const TopKEntry<RowRef>& a, const TopKEntry<RowRef>& b) {
+    if (a.key != b.key) return a.key > b.key;
+    int order = memcmp(a.id.ptr, b.id.ptr, min(a.id.len, b.id.len));
+    if (order == 0 && a.id.len != b.id.len) order = a.id.len < b.id.len ? -1 : 1;
+    return order != 0 ? order < 0 : a.channel < b.channel;
+}
+
+template <typename RowRef>
+class TopKHeap {
+private:
+    size_t k;
+    vector<TopKEntry<RowRef> > entries;
+
+public:
+    explicit TopKHeap(size_t limit) : k(limit) { entries.reserve(limit); }
+
+    // Rows with a key below this can be skipped without looking further
+    bool full() const { return entries.size() == k; }
+    double worstKey() const { return entries.front().key; }
+
+    void offer(const TopKEntry<RowRef>& entry) {
+        if (entries.size() < k) {
+            entries.push_back(entry);
+            push_heap(entries.begin(), entries.end(), topKBetter<RowRef>);
+        } else if (topKBetter(entry, entries.front())) {
+            pop_heap(entries.begin(), entries.end(), topKBetter<RowRef>);
+            entries.back() = entry;
+            push_heap(entries.begin(), entries.end(), topKBetter<RowRef>);
+        }
+    }
+
+    void merge(const TopKHeap& other) {
+        for (const TopKEntry<RowRef>& entry : other.entries) {
+            offer(entry);
+        }
+    }
+
+    // Best first
+    vector<TopKEntry<RowRef> > sorted() const {
+        vector<TopKEntry<RowRef> > result = entries;
+        sort(result.begin(), result.end(), topKBetter<RowRef>);
+        return result;
+    }
+};
+
+struct TopKRange {
+    int channel;
+    int begin, end;
+};
+
+struct TopKQuery {
+    int field;
+    bool smallest;
+    size_t k;
+    vector<QueryPredicate> predicates;
+};
+
+// Offers one row; the key check comes first so most rows stop there
+template <typename RowRef, typename Record>
+inline void topKOffer(TopKHeap<RowRef>& heap, const TopKQuery& query, int channel, RowRef ref, const Record& t) {
+    double key = queryFieldNumber(t, query.field);
+    if (query.smallest) key = -key;
+    if (key != key || (heap.full() && key < heap.worstKey())) return;   // NaN never ranks
+    if (!query.predicates.empty() && !matchesQuery(t, query.predicates)) return;
+    TopKEntry<RowRef> entry = {key, textRef(t.transaction_id), channel, ref};
+    heap.offer(entry);
+}
+
+template <typename List>
+void topKRanges(const List& list, int channel, vector<TopKRange>& ranges) {
+    const int chunk = 65536;
+    int total = list.getCount();
+    for (int begin = 0; begin < total; begin += chunk) {
+        TopKRange range = {channel, begin, min(total, begin + chunk)};
+        ranges.push_back(range);
+    }
+}
+
+inline void topKRanges(const TransactionList& list, int channel, vector<TopKRange>& ranges) {
+    TopKRange range = {channel, 0, list.getCount()};
+    ranges.push_back(range);
+}
+
+template <typename List>
+void topKScan(const List& list, const TopKRange& range, const TopKQuery& query,
+              TopKHeap<typename List::RowRef>& heap) {
+    typedef typename List::RowRef RowRef;
+    typedef typename List::Record Record;
+    list.forEachRefInRange(range.begin, range.end, [&](RowRef ref, const Record& t) {
+        topKOffer(heap, query, range.channel, ref, t);
+    });
+}
+
+inline void topKScan(const TransactionList& list, const TopKRange& range, const TopKQuery& query,
+                     TopKHeap<TransactionList::RowRef>& heap) {
+    list.forEachRef([&](TransactionList::RowRef ref, const Transaction& t) {
+        topKOffer(heap, query, range.channel, ref, t);
+    });
+}
+
+// Snapshot ranges are row numbers in the file. Only the value column is
+// read; a row is decoded only when its value would get it in.
+inline void topKScan(const SnapshotTransactionList& list, const TopKRange& range, const TopKQuery& query,
+                     TopKHeap<SnapshotTransactionList::RowRef>& heap) {
+    const double* values = query.field == Q_VELOCITY ? nullptr : list.numericColumn(query.field - Q_AMOUNT);
+    const int32_t* velocity = list.velocityColumn();
+    double sign = query.smallest ? -1.0 : 1.0;
+    for (int r = range.begin; r < range.end; ++r) {
+        double key = sign * (values ? values[r] : velocity[r]);
+        if (heap.full() && key < heap.worstKey()) continue;
+        topKOffer(heap, query, range.channel, (uint32_t)r, list.at((uint32_t)r));
+    }
+}
+
+// The best k rows of the selected channels, best first. Entries point into
+// the lists, so the caller holds an EpochGuard while it uses them.
+template <typename List>
+vector<TopKEntry<typename List::RowRef> > topK(List* const lists[4], const bool selected[4], const TopKQuery& query) {
+    typedef TopKHeap<typename List::RowRef> Heap;
+    vector<TopKRange> ranges;
+    for (int c = 0; c < 4; ++c) {
+        if (selected[c]) topKRanges(*lists[c], c, ranges);
+    }
+    int workers = max(1, min((int)thread::hardware_concurrency(), (int)ranges.size()));
+    vector<Heap> heaps(workers, Heap(query.k));
+    atomic<size_t> next(0);
+    auto work = [&](int w) {
+        for (size_t i = next++; i < ranges.size(); i = next++) {
+            topKScan(*lists[ranges[i].channel], ranges[i], query, heaps[w]);
+        }
+    };
+    vector<thread> threads;
+    for (int w = 1; w < workers; ++w) {
+        threads.emplace_back(work, w);
+    }
+    work(0);
+    for (thread& t : threads) {
+        t.join();
+    }
+    for (int w = 1; w < workers; ++w) {
+        heaps[0].merge(heaps[w]);
+    }
+    return heaps[0].sorted();
+}
+
+// Parses "FIELD [K] [asc|desc] [PREDICATE ...]". A word without an
+// operator continues the previous predicate's value (location=New York).
+bool parseTopKRequest(const string& text, TopKQuery& query, string& error) {
+    istringstream words(text);
+    string word;
+    query.field = Q_AMOUNT;
+    query.smallest = false;
+    query.k = 10;
+    query.predicates.clear();
+    if (words >> word) {
+        query.field = queryFieldIndex(word);
+        if (query.field < 0 || !isNumericField(query.field)) {
+            error = "'" + word + "' is not a numeric field (amount, time_since_last, spending_deviation, "
+                    "geo_anomaly or velocity)";
+            return false;
+        }
+    }
+    vector<string> conditions;
+    bool first = true;
+    while (words >> word) {
+        if (first && word.find_first_not_of("0123456789") == string::npos) {
+            query.k = strtoul(word.c_str(), nullptr, 10);
+        } else if (word == "asc" || word == "desc") {
+            query.smallest = word == "asc";
+        } else if (word.find_first_of("=!<>") == string::npos && !conditions.empty()) {
+            conditions.back() += " " + word;
+        } else {
+            conditions.push_back(word);
+        }
+        first = false;
+    }
+    if (query.k == 0 || query.k > 1000000) {
+        error = "K must be between 1 and 1000000";
+        return false;
+    }
+    for (const string& condition : conditions) {
+        QueryPredicate p;
+        if (!parseQueryPredicate(condition, p, error)) {
+            return false;
+        }
+        query.predicates.push_back(p);
+    }
+    return true;
+}
+
+// Prints the top rows with the list's own displayTransactions format,
+// each preceded by its rank, value and channel
+template <typename List>
+void printTopK(List* const lists[4], const bool selected[4], const TopKQuery& query, const string& implementation) {
+    typedef typename List::RowRef RowRef;
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    EpochGuard guard;
+    long rows = 0;
+    for (int c = 0; c < 4; ++c) {
+        if (selected[c]) rows += lists[c]->getCount();
+    }
+
+    vector<TopKEntry<RowRef> > top;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        LatencyTimer latency(implementation, "top-k");
+        top = topK(lists, selected, query);
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+
+    string filter;
+    for (const QueryPredicate& p : query.predicates) {
+        static const char* const operators[8] = {"=", "!=", "<", "<=", ">", ">=", "^=", "*="};
+        filter += (filter.empty() ? " where " : " and ") + string(queryFieldNames[p.field]) + operators[p.op] + p.text;
+    }
+    cout << "\nTop " << top.size() << " by " << queryFieldNames[query.field] << " ("
+         << (query.smallest ? "smallest" : "largest") << ")" << filter << ": " << rows << " rows scanned in "
+         << fixed << setprecision(3) << elapsed.count() << " ms" << endl;
+    cout << "=====================================" << endl;
+    for (size_t i = 0; i < top.size(); ++i) {
+        const TopKEntry<RowRef>& entry = top[i];
+        double value = query.smallest ? -entry.key : entry.key;
+        cout << "Rank " << (i + 1) << ": " << queryFieldNames[query.field] << " = ";
+        if (query.field == Q_VELOCITY) {
+            cout << (long)value;
+        } else {
+            cout << fixed << setprecision(2) << value;
+        }
+        cout << " (" << names[entry.channel] << ")" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        List::displayTransaction(lists[entry.channel]->at(entry.ref), (int)(i + 1));
+    }
+    cout << "=====================================" << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+template <typename List>
+void topKMenu(List* lists[4], const string& implementation) {
+    static const bool all[4] = {true, true, true, true};
+    string text, error;
+    cout << "Enter FIELD [K] [asc|desc] [PREDICATE ...]" << endl;
+    cout << "  (e.g. amount 10, or spending_deviation 20 location=Tokyo type=transfer; default amount 10): ";
+    getline(cin, text);
+    TopKQuery query;
+    if (!parseTopKRequest(text, query, error)) {
+        cout << "Invalid top-K query: " << error << endl;
+        return;
+    }
+    resolveValueSets(lists, query.predicates);
+    printTopK(lists, all, query, implementation);
+}
+
+// Account Index
+//
+// Every transaction of an account, as sender or receiver, across all four
+// channels. The index is compressed sparse rows: the rows of all channels
+// are numbered in time order, account names are kept sorted in one string,
+// and for each role an offsets array points into one positions array, so an
+// account's rows are a contiguous, already chronological slice. Built in
+// one pass over the lists; a lookup is a binary search over the names.
+// Rows appended later are merged into a copy of the arrays (extend) rather
+// than rebuilt from every row; only reordered or replaced lists rebuild.
+template <typename List>
+class AccountIndex {
+public:
+    typedef typename List::RowRef RowRef;
+    typedef typename List::AppendMark AppendMark;
+    enum Role { SENT = 0, RECEIVED = 1 };
+
+private:
+    string names;                    // account names in sorted order, back to back
+    vector<uint32_t> nameOffsets;    // accounts + 1 entries into names
+    vector<uint32_t> offsets[2];     // accounts + 1 entries into positions, per role
+    vector<uint32_t> positions[2];   // row numbers, grouped by account
+    vector<RowRef> refs;             // row number -> list row
+    vector<uint8_t> channels;        // row number -> channel
+    vector<uint32_t> rowTimes;       // row number -> seconds after baseTime, 0 if unparsed
+    int64_t baseTime;
+    size_t unparsedRows;             // rows without a timestamp, numbered first
+    const List* built[4];
+    int counts[4];
+    unsigned generations[4];
+    AppendMark marks[4];             // where rowsSince continues
+    size_t appendedRows;             // rows merged in by extend, 0 after build
+    double buildMilliseconds;
+
+    int64_t timeOf(size_t row) const {
+        return row < unparsedRows ? numeric_limits<int64_t>::min() : baseTime + rowTimes[row];
+    }
+
+    static bool nameBefore(StringRef a, const string& b) {
+        int order = memcmp(a.data(), b.data(), min(a.size(), b.size()));
+        return order < 0 || (order == 0 && a.size() < b.size());
+    }
+
+public:
+    // Where an account's rows are; empty if the account is unknown
+    struct Slice {
+        const uint32_t* begin[2];
+        const uint32_t* end[2];
+
+        size_t size(int role) const { return end[role] - begin[role]; }
+    };
+
+    AccountIndex() : baseTime(0), unparsedRows(0), appendedRows(0), buildMilliseconds(0) {
+        for (int c = 0; c < 4; ++c) {
+            built[c] = nullptr;
+            counts[c] = 0;
+            generations[c] = 0;
+            marks[c] = AppendMark();
+        }
+    }
+
+    void build(List* const lists[4]) {
+        typedef typename List::Record Record;
+        static const uint32_t NO_ID = 0xFFFFFFFFu;
+        auto start = chrono::high_resolution_clock::now();
+        vector<string> idNames;
+        vector<uint32_t> slots(1024, NO_ID);
+        vector<uint32_t> accounts[2];
+        vector<pair<int64_t, uint32_t> > times;   // (time, visit number)
+        vector<RowRef> rowRefs;
+        vector<uint8_t> rowChannels;
+        size_t expected = 0;
+        for (int c = 0; c < 4; ++c) expected += lists[c]->getCount();
+        for (int role = 0; role < 2; ++role) accounts[role].reserve(expected);
+        times.reserve(expected);
+        rowRefs.reserve(expected);
+        rowChannels.reserve(expected);
+
+        // Account ids from an open-addressing table kept at most half full
+        auto intern = [&](const char* data, size_t length) {
+            if (idNames.size() * 2 >= slots.size()) {
+                vector<uint32_t> grown(slots.size() * 2, NO_ID);
+                for (uint32_t id = 0; id < idNames.size(); ++id) {
+                    size_t slot = hashBytes(idNames[id].data(), idNames[id].size()) & (grown.size() - 1);
+                    while (grown[slot] != NO_ID) slot = (slot + 1) & (grown.size() - 1);
+                    grown[slot] = id;
+                }
+                slots.swap(grown);
+            }
+            size_t mask = slots.size() - 1;
+            for (size_t slot = hashBytes(data, length) & mask;; slot = (slot + 1) & mask) {
+                uint32_t id = slots[slot];
+                if (id == NO_ID) {
+                    slots[slot] = (uint32_t)idNames.size();
+                    idNames.emplace_back(data, length);
+                    return slots[slot];
+                }
+                if (idNames[id].size() == length && memcmp(idNames[id].data(), data, length) == 0) {
+                    return id;
+                }
+            }
+        };
+        vector<RowRef> channelRefs;
+        for (int c = 0; c < 4; ++c) {
+            built[c] = lists[c];
+            generations[c] = lists[c]->rowGeneration();
+            channelRefs.clear();
+            marks[c] = lists[c]->rowsSince(AppendMark(), channelRefs);
+            for (RowRef ref : channelRefs) {
+                const Record& t = lists[c]->at(ref);
+                int64_t time;
+                if (!parseTimestamp(t.timestamp.data(), t.timestamp.size(), time)) {
+                    time = numeric_limits<int64_t>::min();   // unparsed rows sort first
+                }
+                times.push_back(make_pair(time, (uint32_t)rowRefs.size()));
+                rowRefs.push_back(ref);
+                rowChannels.push_back((uint8_t)c);
+                accounts[SENT].push_back(intern(t.sender_account.data(), t.sender_account.size()));
+                accounts[RECEIVED].push_back(intern(t.receiver_account.data(), t.receiver_account.size()));
+            }
+            counts[c] = (int)channelRefs.size();
+        }
+
+        // Row numbers in time order; ties keep the order rows were added in
+        size_t rows = rowRefs.size();
+        sort(times.begin(), times.end());
+        vector<uint32_t> byTime(rows);
+        refs.resize(rows);
+        channels.resize(rows);
+        rowTimes.resize(rows);
+        size_t firstParsed = 0;
+        while (firstParsed < rows && times[firstParsed].first == numeric_limits<int64_t>::min()) firstParsed++;
+        baseTime = firstParsed < rows ? times[firstParsed].first : 0;
+        unparsedRows = firstParsed;
+        appendedRows = 0;
+        for (size_t i = 0; i < rows; ++i) {
+            byTime[i] = times[i].second;
+            refs[i] = rowRefs[byTime[i]];
+            channels[i] = rowChannels[byTime[i]];
+            rowTimes[i] = i < firstParsed ? 0 : (uint32_t)min(times[i].first - baseTime, (int64_t)0xFFFFFFFEu);
+        }
+        vector<pair<int64_t, uint32_t> >().swap(times);
+
+        // Account ids ranked by name
+        size_t accountCount = idNames.size();
+        vector<uint32_t> order(accountCount), rank(accountCount);
+        for (size_t i = 0; i < accountCount; ++i) order[i] = (uint32_t)i;
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return idNames[a] < idNames[b]; });
+        names.clear();
+        nameOffsets.assign(1, 0);
+        nameOffsets.reserve(accountCount + 1);
+        for (size_t i = 0; i < accountCount; ++i) {
+            rank[order[i]] = (uint32_t)i;
+            names += idNames[order[i]];
+            nameOffsets.push_back((uint32_t)names.size());
+        }
+
+        // Counting sort per role; walking rows in time order leaves each
+        // account's slice chronological
+        for (int role = 0; role < 2; ++role) {
+            vector<uint32_t>& offset = offsets[role];
+            offset.assign(accountCount + 1, 0);
+            for (uint32_t id : accounts[role]) offset[rank[id] + 1]++;
+            for (size_t i = 0; i < accountCount; ++i) offset[i + 1] += offset[i];
+            vector<uint32_t> next(offset.begin(), offset.end() - 1);
+            positions[role].resize(rows);
+            for (size_t i = 0; i < rows; ++i) {
+                positions[role][next[rank[accounts[role][byTime[i]]]]++] = (uint32_t)i;
+            }
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        buildMilliseconds = elapsed.count();
+    }
+
+    // A copy of base with the rows appended to the lists since it was
+    // built. Old rows keep their relative order and the new ones are merged
+    // in by time, as are new account names, so every array is copied once
+    // instead of rebuilt: no old timestamp is parsed or account looked up
+    // again. base must be extendable() to these lists.
+    void extend(const AccountIndex& base, List* const lists[4]) {
+        typedef typename List::Record Record;
+        auto start = chrono::high_resolution_clock::now();
+        struct Added {
+            int64_t time;
+            RowRef ref;
+            uint8_t channel;
+            string accounts[2];
+        };
+        vector<Added> added;
+        vector<RowRef> channelRefs;
+        for (int c = 0; c < 4; ++c) {
+            built[c] = lists[c];
+            generations[c] = base.generations[c];
+            channelRefs.clear();
+            marks[c] = lists[c]->rowsSince(base.marks[c], channelRefs);
+            counts[c] = base.counts[c] + (int)channelRefs.size();
+            for (RowRef ref : channelRefs) {
+                const Record& t = lists[c]->at(ref);
+                Added row;
+                if (!parseTimestamp(t.timestamp.data(), t.timestamp.size(), row.time)) {
+                    row.time = numeric_limits<int64_t>::min();
+                }
+                row.ref = ref;
+                row.channel = (uint8_t)c;
+                row.accounts[SENT] = string(t.sender_account);
+                row.accounts[RECEIVED] = string(t.receiver_account);
+                added.push_back(move(row));
+            }
+        }
+        stable_sort(added.begin(), added.end(), [](const Added& a, const Added& b) { return a.time < b.time; });
+
+        // Merge the rows. Equal times keep the order build() gives them: by
+        // channel, then in the order they were added, so old rows first.
+        size_t oldRows = base.refs.size(), rows = oldRows + added.size();
+        vector<uint32_t> oldRow(oldRows), addedRow(added.size());
+        unparsedRows = base.unparsedRows;
+        while (unparsedRows - base.unparsedRows < added.size() &&
+               added[unparsedRows - base.unparsedRows].time == numeric_limits<int64_t>::min()) {
+            unparsedRows++;
+        }
+        baseTime = base.baseTime;
+        if (unparsedRows < rows && (base.unparsedRows == oldRows ||
+                                    (unparsedRows - base.unparsedRows < added.size() &&
+                                     added[unparsedRows - base.unparsedRows].time < base.baseTime))) {
+            baseTime = added[unparsedRows - base.unparsedRows].time;
+        }
+        refs.resize(rows);
+        channels.resize(rows);
+        rowTimes.resize(rows);
+        for (size_t r = 0, i = 0, j = 0; r < rows; ++r) {
+            int64_t time;
+            if (j == added.size() ||
+                (i < oldRows && (base.timeOf(i) < added[j].time ||
+                                 (base.timeOf(i) == added[j].time && base.channels[i] <= added[j].channel)))) {
+                oldRow[i] = (uint32_t)r;
+                refs[r] = base.refs[i];
+                channels[r] = base.channels[i];
+                time = base.timeOf(i++);
+            } else {
+                addedRow[j] = (uint32_t)r;
+                refs[r] = added[j].ref;
+                channels[r] = added[j].channel;
+                time = added[j++].time;
+            }
+            rowTimes[r] = r < unparsedRows ? 0 : (uint32_t)min(time - baseTime, (int64_t)0xFFFFFFFEu);
+        }
+
+        // Names the new rows bring, merged into the sorted names
+        vector<string> fresh;
+        uint32_t number;
+        for (const Added& row : added) {
+            for (int role = 0; role < 2; ++role) {
+                if (!base.locate(row.accounts[role], number)) fresh.push_back(row.accounts[role]);
+            }
+        }
+        sort(fresh.begin(), fresh.end());
+        fresh.erase(unique(fresh.begin(), fresh.end()), fresh.end());
+        size_t oldAccounts = base.accountCount(), accountCount = oldAccounts + fresh.size();
+        vector<int64_t> oldAccount(accountCount, -1);   // new account number -> base's, -1 if new
+        names.clear();
+        names.reserve(base.names.size() + fresh.size() * 12);
+        nameOffsets.assign(1, 0);
+        nameOffsets.reserve(accountCount + 1);
+        for (size_t a = 0, b = 0; a + b < accountCount;) {
+            if (b == fresh.size() || (a < oldAccounts && nameBefore(base.name((uint32_t)a), fresh[b]))) {
+                oldAccount[a + b] = (int64_t)a;
+                StringRef old = base.name((uint32_t)a++);
+                names.append(old.data(), old.size());
+            } else {
+                names += fresh[b++];
+            }
+            nameOffsets.push_back((uint32_t)names.size());
+        }
+
+        // Per role: each account's old slice, renumbered, merged with its
+        // new rows
+        for (int role = 0; role < 2; ++role) {
+            vector<pair<uint32_t, uint32_t> > byAccount(added.size());   // (account, row) in time order
+            for (size_t j = 0; j < added.size(); ++j) {
+                locate(added[j].accounts[role], number);
+                byAccount[j] = make_pair(number, addedRow[j]);
+            }
+            stable_sort(byAccount.begin(), byAccount.end(),
+                        [](const pair<uint32_t, uint32_t>& a, const pair<uint32_t, uint32_t>& b) {
+                            return a.first < b.first;
+                        });
+            const vector<uint32_t>& oldOffsets = base.offsets[role];
+            const vector<uint32_t>& oldPositions = base.positions[role];
+            vector<uint32_t>& offset = offsets[role];
+            vector<uint32_t>& position = positions[role];
+            offset.assign(accountCount + 1, 0);
+            position.resize(rows);
+            size_t k = 0, out = 0;
+            for (size_t a = 0; a < accountCount; ++a) {
+                const uint32_t* p = nullptr;
+                const uint32_t* end = nullptr;
+                if (oldAccount[a] >= 0) {
+                    p = oldPositions.data() + oldOffsets[oldAccount[a]];
+                    end = oldPositions.data() + oldOffsets[oldAccount[a] + 1];
+                }
+                while (p != end || (k < byAccount.size() && byAccount[k].first == a)) {
+                    if (p != end && (k == byAccount.size() || byAccount[k].first != a || oldRow[*p] < byAccount[k].second)) {
+                        position[out++] = oldRow[*p++];
+                    } else {
+                        position[out++] = byAccount[k++].second;
+                    }
+                }
+                offset[a + 1] = (uint32_t)out;
+            }
+        }
+        appendedRows = added.size();
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        buildMilliseconds = elapsed.count();
+    }
+
+    // False once rows were added or the lists were rebuilt since build()
+    bool current(List* const lists[4]) const {
+        for (int c = 0; c < 4; ++c) {
+            if (built[c] != lists[c] || counts[c] != lists[c]->getCount() ||
+                generations[c] != lists[c]->rowGeneration()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // True if the lists only grew since build(), so extend() can catch up
+    bool extendable(List* const lists[4]) const {
+        for (int c = 0; c < 4; ++c) {
+            if (built[c] != lists[c] || counts[c] > lists[c]->getCount() ||
+                generations[c] != lists[c]->rowGeneration()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    StringRef name(uint32_t account) const {
+        return StringRef(names.data() + nameOffsets[account], nameOffsets[account + 1] - nameOffsets[account]);
+    }
+
+    // Accounts are numbered in name order
+    bool locate(const string& account, uint32_t& number) const {
+        size_t low = 0, high = nameOffsets.size() - 1;
+        while (low < high) {
+            size_t mid = (low + high) / 2;
+            StringRef candidate = name((uint32_t)mid);
+            int order = memcmp(candidate.data(), account.data(), min(candidate.size(), account.size()));
+            if (order < 0 || (order == 0 && candidate.size() < account.size())) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        number = (uint32_t)low;
+        return low < nameOffsets.size() - 1 && name(number) == account;
+    }
+
+    Slice find(const string& account) const {
+        Slice slice;
+        uint32_t number;
+        bool found = locate(account, number);
+        for (int role = 0; role < 2; ++role) {
+            const uint32_t* base = positions[role].data();
+            slice.begin[role] = found ? base + offsets[role][number] : base;
+            slice.end[role] = found ? base + offsets[role][number + 1] : base;
+        }
+        return slice;
+    }
+
+    // The CSR arrays themselves, for structures built on top of the index
+    const vector<uint32_t>& roleOffsets(int role) const { return offsets[role]; }
+    const vector<uint32_t>& rolePositions(int role) const { return positions[role]; }
+
+    RowRef ref(uint32_t position) const { return refs[position]; }
+    int channel(uint32_t position) const { return channels[position]; }
+    uint32_t rowTime(uint32_t position) const { return rowTimes[position]; }   // seconds after startTime()
+    int64_t startTime() const { return baseTime; }
+    size_t accountCount() const { return nameOffsets.size() - 1; }
+    size_t rowCount() const { return refs.size(); }
+    size_t appendedCount() const { return appendedRows; }   // 0 unless made by extend()
+    double buildTime() const { return buildMilliseconds; }
+
+    size_t memoryBytes() const {
+        size_t bytes = sizeof(*this) + names.capacity() + nameOffsets.capacity() * sizeof(uint32_t) +
+                       refs.capacity() * sizeof(RowRef) + channels.capacity() + rowTimes.capacity() * sizeof(uint32_t);
+        for (int role = 0; role < 2; ++role) {
+            bytes += (offsets[role].capacity() + positions[role].capacity()) * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+};
+
+// The account index over these lists, brought up to date first if it is
+// missing or stale: extended with appended rows, or rebuilt after a sort or
+// reload. rebuilt tells the caller either happened. List rows referenced by
+// the index stay valid while the caller holds an EpochGuard taken before
+// the call.
+template <typename List>
+shared_ptr<const AccountIndex<List> > accountIndex(List* const lists[4], bool& rebuilt) {
+    static mutex lock;
+    static shared_ptr<const AccountIndex<List> > index;
+    lock_guard<mutex> hold(lock);
+    rebuilt = !index || !index->current(lists);
+    if (rebuilt) {
+        shared_ptr<AccountIndex<List> > fresh = make_shared<AccountIndex<List> >();
+        if (index && index->extendable(lists)) {
+            fresh->extend(*index, lists);
+        } else {
+            index.reset();   // frees the old arrays before the new ones are built
+            fresh->build(lists);
+        }
+        index = fresh;
+    }
+    return index;
+}
+
+// Row positions of an account, sent and received merged into one
+// chronological list; a transfer to oneself appears once.
+template <typename List>
+vector<uint32_t> accountRows(const AccountIndex<List>& index, const string& account, size_t& sent, size_t& received) {
+    typedef AccountIndex<List> Index;
+    typename Index::Slice slice = index.find(account);
+    sent = slice.size(Index::SENT);
+    received = slice.size(Index::RECEIVED);
+    vector<uint32_t> rows(sent + received);
+    auto last = set_union(slice.begin[Index::SENT], slice.end[Index::SENT], slice.begin[Index::RECEIVED],
+                          slice.end[Index::RECEIVED], rows.begin());
+    rows.erase(last, rows.end());
+    return rows;
+}
+
+// Prints the latest limit transactions of an account across all channels,
+// oldest first, with the time the lookup took.
+template <typename List>
+void printAccountHistory(List* const lists[4], const string& account, size_t limit, const string& implementation) {
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    EpochGuard guard;
+    bool rebuilt;
+    shared_ptr<const AccountIndex<List> > index = accountIndex(lists, rebuilt);
+    if (rebuilt) {
+        cout << "Successfully " << (index->appendedCount() ? "updated" : "built") << " account index: "
+             << index->accountCount() << " accounts, " << index->rowCount() << " rows";
+        if (index->appendedCount()) {
+            cout << " (" << index->appendedCount() << " new)";
+        }
+        cout << " in " << fixed << setprecision(1) << index->buildTime() << " ms, " << toMB(index->memoryBytes())
+             << " MB" << endl;
+    }
+
+    size_t sent, received;
+    vector<uint32_t> rows;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        LatencyTimer latency(implementation, "account lookup");
+        rows = accountRows(*index, account, sent, received);
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    if (rows.empty()) {
+        cout << "No transactions found for account " << account << "." << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        return;
+    }
+
+    cout << "\nAccount " << account << ": " << sent << " sent, " << received << " received (lookup "
+         << fixed << setprecision(3) << elapsed.count() << " ms)" << endl;
+    size_t first = rows.size() > limit ? rows.size() - limit : 0;
+    if (first > 0) {
+        cout << "... " << first << " earlier transactions" << endl;
+    }
+    cout << left << setw(21) << "Timestamp" << setw(10) << "Role" << setw(16) << "Transaction ID" << setw(16)
+         << "Counterparty" << right << setw(12) << "Amount" << "  " << left << setw(15) << "Channel" << setw(12)
+         << "Type" << "Fraud" << endl;
+    cout << setprecision(2);
+    for (size_t i = first; i < rows.size(); ++i) {
+        const auto& t = lists[index->channel(rows[i])]->at(index->ref(rows[i]));
+        bool isSender = t.sender_account == account, isReceiver = t.receiver_account == account;
+        string role = isSender && isReceiver ? "Self" : (isSender ? "Sent" : "Received");
+        string counterparty = isSender ? string(t.receiver_account) : string(t.sender_account);
+        cout << left << setw(21) << string(t.timestamp) << setw(10) << role << setw(16) << string(t.transaction_id)
+             << setw(16) << counterparty << right << setw(12) << t.amount << "  " << left << setw(15)
+             << names[index->channel(rows[i])] << setw(12) << string(t.transaction_type) << t.is_fraud << endl;
+    }
+    cout << right;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+template <typename List>
+void accountHistoryMenu(List* lists[4], const string& implementation) {
+    string account, limitText;
+    cout << "Enter account ID: ";
+    getline(cin, account);
+    if (account.empty()) {
+        cout << "No account entered." << endl;
+        return;
+    }
+    cout << "Transactions to show (default 20): ";
+    getline(cin, limitText);
+    int limit = limitText.empty() ? 20 : atoi(limitText.c_str());
+    if (limit <= 0) {
+        cout << "Invalid transaction count." << endl;
+        return;
+    }
+    printAccountHistory(lists, account, limit, implementation);
+}
+
+// Transaction Graph
+//
+// Accounts as vertices and transactions as edges from sender to receiver,
+// laid out on top of the account index: an account's out-edges are its
+// sent slice, so the offsets are shared and each edge only adds its
+// receiver, its time (seconds after the earliest row) and its amount, 12
+// bytes in all. An account's edges are in time order, so the ones leaving
+// inside a time range are found by binary search.
+template <typename List>
+class TransactionGraph {
+public:
+    typedef AccountIndex<List> Index;
+    enum : uint32_t { NONE = 0xFFFFFFFFu };   // no account, edge or time
+
+    // An account reached by expand()
+    struct Reached {
+        uint32_t account;
+        uint32_t hops;      // fewest hops it was reached in
+        uint32_t arrival;   // time of edge, the last edge of the earliest path found
+        uint32_t edge;
+    };
+
+    typedef vector<uint32_t> Cycle;   // edge numbers in path order
+
+private:
+    static const size_t PARALLEL_FRONTIER = 1024;   // smaller BFS levels run on the calling thread
+    static const size_t BUILD_CHUNK = 65536;
+
+    shared_ptr<const Index> index;
+    vector<uint32_t> targets;
+    vector<uint32_t> times;   // seconds after the index's start time
+    vector<float> amounts;
+    double buildMilliseconds;
+
+    const vector<uint32_t>& offsets() const { return index->roleOffsets(Index::SENT); }
+
+    // The edges of account leaving at from..until, as [first, last)
+    void usable(uint32_t account, uint32_t from, uint32_t until, uint32_t& first, uint32_t& last) const {
+        const uint32_t* begin = times.data() + offsets()[account];
+        const uint32_t* end = times.data() + offsets()[account + 1];
+        const uint32_t* low = lower_bound(begin, end, from);
+        first = (uint32_t)(low - times.data());
+        last = (uint32_t)(upper_bound(low, end, until) - times.data());
+    }
+
+    static uint32_t later(uint32_t time, uint32_t seconds) {
+        return seconds == 0 || time > NONE - seconds ? NONE : time + seconds;
+    }
+
+    // Cycle counts by length, and the earliest keep cycles found: a heap
+    // whose top is the latest kept, by first edge time and then edges
+    struct CycleSink {
+        vector<size_t> byLength;
+        size_t keep;
+        vector<Cycle> cycles;
+    };
+
+    bool earlierCycle(const Cycle& a, const Cycle& b) const {
+        return times[a[0]] != times[b[0]] ? times[a[0]] < times[b[0]] : a < b;
+    }
+
+    void keepCycle(const vector<uint32_t>& path, uint32_t last, CycleSink& sink) const {
+        auto earlier = [this](const Cycle& a, const Cycle& b) { return earlierCycle(a, b); };
+        Cycle cycle(path);
+        cycle.push_back(last);
+        if (sink.cycles.size() < sink.keep) {
+            sink.cycles.push_back(move(cycle));
+            push_heap(sink.cycles.begin(), sink.cycles.end(), earlier);
+        } else if (sink.keep > 0 && earlierCycle(cycle, sink.cycles.front())) {
+            pop_heap(sink.cycles.begin(), sink.cycles.end(), earlier);
+            sink.cycles.back() = move(cycle);
+            push_heap(sink.cycles.begin(), sink.cycles.end(), earlier);
+        }
+    }
+
+    // Depth-first extension of path (edges leaving start and ending at
+    // vertex) with edges no earlier than from and no later than deadline
+    void extend(uint32_t start, uint32_t vertex, uint32_t from, uint32_t deadline, int edgesLeft,
+                vector<uint32_t>& path, vector<uint32_t>& visited, CycleSink& sink) const {
+        uint32_t first, last;
+        usable(vertex, from, deadline, first, last);
+        for (uint32_t e = first; e < last; ++e) {
+            uint32_t next = targets[e];
+            if (next == start) {
+                sink.byLength[path.size() + 1]++;
+                keepCycle(path, e, sink);
+            } else if (edgesLeft > 1 && find(visited.begin(), visited.end(), next) == visited.end()) {
+                path.push_back(e);
+                visited.push_back(next);
+                extend(start, next, times[e], deadline, edgesLeft - 1, path, visited, sink);
+                path.pop_back();
+                visited.pop_back();
+            }
+        }
+    }
+
+    void cyclesFrom(uint32_t start, int maxLength, uint32_t window, CycleSink& sink) const {
+        vector<uint32_t> path, visited;
+        for (uint32_t e = offsets()[start]; e < offsets()[start + 1]; ++e) {
+            if (targets[e] == start) continue;   // a transfer to oneself is not a round trip
+            path.assign(1, e);
+            visited.assign(1, targets[e]);
+            extend(start, targets[e], times[e], later(times[e], window), maxLength - 1, path, visited, sink);
+        }
+    }
+
+    static int threadCount() { return (int)max(1u, thread::hardware_concurrency()); }
+
+public:
+    TransactionGraph() : buildMilliseconds(0) {}
+
+    // Takes receivers and times from the index and reads amounts from the
+    // rows, in chunks filled in parallel
+    void build(const shared_ptr<const Index>& accounts, List* const lists[4]) {
+        auto start = chrono::high_resolution_clock::now();
+        index = accounts;
+        const vector<uint32_t>& sent = accounts->rolePositions(Index::SENT);
+        const vector<uint32_t>& receivedOffsets = accounts->roleOffsets(Index::RECEIVED);
+        const vector<uint32_t>& received = accounts->rolePositions(Index::RECEIVED);
+        size_t edges = sent.size();
+        vector<uint32_t> receiver(edges);
+        for (uint32_t a = 0; a < accounts->accountCount(); ++a) {
+            for (uint32_t i = receivedOffsets[a]; i < receivedOffsets[a + 1]; ++i) {
+                receiver[received[i]] = a;
+            }
+        }
+
+        targets.resize(edges);
+        times.resize(edges);
+        amounts.resize(edges);
+        auto fill = [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                uint32_t p = sent[e];
+                targets[e] = receiver[p];
+                times[e] = accounts->rowTime(p);
+                amounts[e] = (float)lists[accounts->channel(p)]->at(accounts->ref(p)).amount;
+            }
+        };
+        int chunks = (int)min((size_t)threadCount(), max((size_t)1, edges / BUILD_CHUNK));
+        vector<thread> workers;
+        for (int c = 1; c < chunks; ++c) {
+            workers.emplace_back(fill, edges * c / chunks, edges * (c + 1) / chunks);
+        }
+        fill(0, edges / chunks);
+        for (thread& worker : workers) {
+            worker.join();
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        buildMilliseconds = elapsed.count();
+    }
+
+    bool builtOn(const Index& accounts) const { return index.get() == &accounts; }
+
+    // Accounts reachable from source in at most maxHops transactions. With
+    // ordered, each hop after the first leaves no earlier than the previous
+    // one arrived and, if maxGap is not 0, at most maxGap seconds later;
+    // arrival is then the earliest possible. Without a gap the earliest
+    // arrival at an account allows every departure a later one would, so
+    // only it is expanded. With a gap a later arrival opens a later window,
+    // so each distinct (account, arrival) is expanded once instead, and
+    // previous maps each edge to the one before it on a path found, as the
+    // earliest arrival at its sender may not be that edge's. Runs level by
+    // level, expanding large levels on all cores. perHop[h] is the number
+    // of accounts first reached in h hops.
+    vector<Reached> expand(uint32_t source, int maxHops, bool ordered, uint32_t maxGap, vector<size_t>& perHop,
+                           size_t& scanned, unordered_map<uint32_t, uint32_t>& previous) const {
+        size_t n = index->accountCount();
+        bool everyArrival = ordered && maxGap != 0;
+        unordered_set<uint64_t> expanded;   // (account, arrival) pairs queued so far, with everyArrival
+        // Earliest arrival found so far in the high half, the edge it came
+        // over in the low half, so one atomic minimum keeps them together
+        unique_ptr<atomic<uint64_t>[]> best(new atomic<uint64_t>[n]);
+        unique_ptr<atomic<uint32_t>[]> queued(new atomic<uint32_t>[n]);
+        vector<uint32_t> hops(n, NONE);
+        for (size_t v = 0; v < n; ++v) {
+            best[v].store(~(uint64_t)0, memory_order_relaxed);
+            queued[v].store(0, memory_order_relaxed);
+        }
+        hops[source] = 0;
+        perHop.assign(1, 1);
+        scanned = 0;
+        previous.clear();
+
+        // With everyArrival, the edge each frontier entry was reached by
+        vector<uint32_t> frontier(1, source), arrivals(1, 0), cameBy(1, NONE);
+        for (uint32_t level = 1; (int)level <= maxHops && !frontier.empty(); ++level) {
+            auto expandRange = [&](size_t begin, size_t end, vector<uint32_t>& next, vector<uint32_t>& before,
+                                   size_t& edges) {
+                for (size_t i = begin; i < end; ++i) {
+                    uint32_t from = ordered ? arrivals[i] : 0, first, last;
+                    usable(frontier[i], from, ordered && level > 1 ? later(from, maxGap) : NONE, first, last);
+                    edges += last - first;
+                    for (uint32_t e = first; e < last; ++e) {
+                        uint32_t v = targets[e];
+                        if (v == source || (!ordered && hops[v] != NONE)) continue;
+                        uint64_t candidate = (uint64_t)(ordered ? times[e] : 0) << 32 | e;
+                        uint64_t current = best[v].load(memory_order_relaxed);
+                        while (candidate < current &&
+                               !best[v].compare_exchange_weak(current, candidate, memory_order_relaxed)) {
+                        }
+                        if (everyArrival) {
+                            next.push_back(e);   // deduplicated by (account, arrival) below
+                            before.push_back(cameBy[i]);
+                        } else if (candidate < current && queued[v].exchange(level, memory_order_relaxed) != level) {
+                            next.push_back(v);
+                        }
+                    }
+                }
+            };
+
+            int parts = frontier.size() < PARALLEL_FRONTIER ? 1 : threadCount();
+            vector<vector<uint32_t> > nexts(parts), befores(parts);
+            vector<size_t> edges(parts, 0);
+            vector<thread> workers;
+            for (int p = 1; p < parts; ++p) {
+                workers.emplace_back(expandRange, frontier.size() * p / parts, frontier.size() * (p + 1) / parts,
+                                     ref(nexts[p]), ref(befores[p]), ref(edges[p]));
+            }
+            expandRange(0, frontier.size() / parts, nexts[0], befores[0], edges[0]);
+            for (thread& worker : workers) {
+                worker.join();
+            }
+
+            frontier.clear();
+            arrivals.clear();
+            cameBy.clear();
+            perHop.push_back(0);
+            for (int p = 0; p < parts; ++p) {
+                scanned += edges[p];
+                for (size_t k = 0; k < nexts[p].size(); ++k) {
+                    uint32_t x = nexts[p][k];
+                    uint32_t v = everyArrival ? targets[x] : x;
+                    uint32_t arrival = everyArrival ? times[x] : (uint32_t)(best[v].load(memory_order_relaxed) >> 32);
+                    if (everyArrival) {
+                        previous.insert(make_pair(x, befores[p][k]));
+                        if (!expanded.insert((uint64_t)v << 32 | arrival).second) continue;
+                        cameBy.push_back(x);
+                    }
+                    if (hops[v] == NONE) {
+                        hops[v] = level;
+                        perHop[level]++;
+                    }
+                    frontier.push_back(v);
+                    arrivals.push_back(arrival);
+                }
+            }
+        }
+
+        vector<Reached> reached;
+        for (size_t v = 0; v < n; ++v) {
+            if (hops[v] == NONE || v == source) continue;
+            uint32_t edge = (uint32_t)best[v].load(memory_order_relaxed);
+            Reached r = {(uint32_t)v, hops[v], times[edge], edge};
+            reached.push_back(r);
+        }
+        sort(reached.begin(), reached.end(), [](const Reached& a, const Reached& b) {
+            return a.hops != b.hops ? a.hops < b.hops : (a.arrival != b.arrival ? a.arrival < b.arrival : a.account < b.account);
+        });
+        return reached;
+    }
+
+    // Round trips of 2 to maxLength transactions that leave start and come
+    // back to it, each leaving no earlier than the previous one and the
+    // last within window seconds of the first, with no account visited
+    // twice. With start NONE, every account is a start, spread over all
+    // cores. byLength counts them by transactions; cycles keeps the
+    // earliest keep of them.
+    void findCycles(uint32_t start, int maxLength, uint32_t window, size_t keep, vector<size_t>& byLength,
+                    vector<Cycle>& cycles) const {
+        CycleSink total = {vector<size_t>(maxLength + 1, 0), keep, vector<Cycle>()};
+        if (start != NONE) {
+            cyclesFrom(start, maxLength, window, total);
+        } else {
+            uint32_t n = (uint32_t)index->accountCount();
+            atomic<uint32_t> nextStart(0);
+            int parts = threadCount();
+            vector<CycleSink> sinks(parts, total);
+            auto scan = [&](int part) {
+                uint32_t first;
+                while ((first = nextStart.fetch_add(64)) < n) {
+                    for (uint32_t s = first; s < min(n, first + 64); ++s) {
+                        cyclesFrom(s, maxLength, window, sinks[part]);
+                    }
+                }
+            };
+            vector<thread> workers;
+            for (int p = 1; p < parts; ++p) {
+                workers.emplace_back(scan, p);
+            }
+            scan(0);
+            for (thread& worker : workers) {
+                worker.join();
+            }
+            for (CycleSink& sink : sinks) {
+                for (int l = 0; l <= maxLength; ++l) total.byLength[l] += sink.byLength[l];
+                total.cycles.insert(total.cycles.end(), sink.cycles.begin(), sink.cycles.end());
+            }
+        }
+        sort(total.cycles.begin(), total.cycles.end(),
+             [this](const Cycle& a, const Cycle& b) { return earlierCycle(a, b); });
+        if (total.cycles.size() > keep) total.cycles.resize(keep);
+        cycles.swap(total.cycles);
+        byLength.swap(total.byLength);
+    }
+
+    uint32_t source(uint32_t edge) const {
+        return (uint32_t)(upper_bound(offsets().begin(), offsets().end(), edge) - offsets().begin() - 1);
+    }
+    uint32_t target(uint32_t edge) const { return targets[edge]; }
+    float amount(uint32_t edge) const { return amounts[edge]; }
+    int64_t time(uint32_t edge) const { return index->startTime() + times[edge]; }
+    int64_t timeAt(uint32_t graphTime) const { return index->startTime() + graphTime; }
+    const Index& accounts() const { return *index; }
+    size_t edgeCount() const { return targets.size(); }
+    double buildTime() const { return buildMilliseconds; }
+
+    // The graph's own arrays; the offsets belong to the account index
+    size_t memoryBytes() const {
+        return sizeof(*this) + targets.capacity() * sizeof(uint32_t) + times.capacity() * sizeof(uint32_t) +
+               amounts.capacity() * sizeof(float);
+    }
+};
+
+// The graph over these lists, rebuilt with the account index when that is
+// stale. Same rules as accountIndex().
+template <typename List>
+shared_ptr<const TransactionGraph<List> > transactionGraph(List* const lists[4], bool& rebuilt) {
+    static mutex lock;
+    static shared_ptr<const TransactionGraph<List> > graph;
+    bool indexRebuilt;
+    shared_ptr<const AccountIndex<List> > index = accountIndex(lists, indexRebuilt);
+    lock_guard<mutex> hold(lock);
+    rebuilt = !graph || !graph->builtOn(*index);
+    if (rebuilt) {
+        graph.reset();
+        shared_ptr<TransactionGraph<List> > fresh = make_shared<TransactionGraph<List> >();
+        fresh->build(index, lists);
+        graph = fresh;
+    }
+    return graph;
+}
+
+template <typename List>
+void printGraphBuild(const TransactionGraph<List>& graph) {
+    const AccountIndex<List>& index = graph.accounts();
+    cout << "Successfully built transaction graph: " << index.accountCount() << " accounts, " << graph.edgeCount()
+         << " edges in " << fixed << setprecision(1) << graph.buildTime() << " ms (account index "
+         << index.buildTime() << " ms), " << toMB(graph.memoryBytes() + index.memoryBytes()) << " MB" << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// "ACC1 -> ACC2 -> ACC3" for a path of edges
+template <typename List>
+string graphPath(const TransactionGraph<List>& graph, const vector<uint32_t>& edges) {
+    string path = edges.empty() ? "" : string(graph.accounts().name(graph.source(edges[0])));
+    for (uint32_t e : edges) {
+        path += " -> " + string(graph.accounts().name(graph.target(e)));
+    }
+    return path;
+}
+
+// Prints the accounts money from account can reach in up to hops
+// transactions, with the number first reached at each hop and the earliest
+// path to the first limit of them.
+template <typename List>
+void printMoneyFlow(List* const lists[4], const string& account, int hops, bool ordered, uint32_t maxGap,
+                    const string& implementation, size_t limit = 20) {
+    typedef TransactionGraph<List> Graph;
+    EpochGuard guard;
+    bool rebuilt;
+    shared_ptr<const Graph> graph = transactionGraph(lists, rebuilt);
+    if (rebuilt) {
+        printGraphBuild(*graph);
+    }
+    uint32_t source;
+    if (!graph->accounts().locate(account, source)) {
+        cout << "No transactions found for account " << account << "." << endl;
+        return;
+    }
+
+    vector<size_t> perHop;
+    size_t scanned;
+    unordered_map<uint32_t, uint32_t> previous;
+    vector<typename Graph::Reached> reached;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        LatencyTimer latency(implementation, "graph expand");
+        reached = graph->expand(source, hops, ordered, maxGap, perHop, scanned, previous);
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+
+    cout << "\nMoney flow from " << account << ", up to " << hops << " hops, "
+         << (ordered ? "time-ordered" : "in any order");
+    if (ordered && maxGap > 0) cout << " with at most " << maxGap << " s between hops";
+    cout << ": " << reached.size() << " accounts reached, " << scanned << " edges scanned in " << fixed
+         << setprecision(3) << elapsed.count() << " ms" << endl;
+    for (size_t h = 1; h < perHop.size(); ++h) {
+        cout << "  hop " << h << ": " << perHop[h] << " new accounts" << endl;
+    }
+    if (!reached.empty()) {
+        vector<uint32_t> via(graph->accounts().accountCount(), Graph::NONE);
+        for (const typename Graph::Reached& r : reached) via[r.account] = r.edge;
+        cout << left << setw(16) << "Account" << setw(6) << "Hops" << setw(21)
+             << (ordered ? "Earliest arrival" : "Reached by") << "Path" << endl;
+        for (size_t i = 0; i < reached.size() && i < limit; ++i) {
+            vector<uint32_t> path(1, reached[i].edge);
+            for (uint32_t v = graph->source(path.back()); v != source && path.size() <= (size_t)hops + 1;
+                 v = graph->source(path.back())) {
+                auto before = previous.find(path.back());
+                path.push_back(before != previous.end() ? before->second : via[v]);
+            }
+            reverse(path.begin(), path.end());
+            cout << setw(16) << string(graph->accounts().name(reached[i].account)) << setw(6) << reached[i].hops
+                 << setw(21) << formatTimestamp(graph->timeAt(reached[i].arrival)) << graphPath(*graph, path) << endl;
+        }
+        if (reached.size() > limit) {
+            cout << "... " << (reached.size() - limit) << " more accounts" << endl;
+        }
+        cout << right;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Prints time-ordered round trips through account, or through any account
+// when account is "all", with counts by length and the earliest limit.
+template <typename List>
+void printCycles(List* const lists[4], const string& account, int maxLength, uint32_t window,
+                 const string& implementation, size_t limit = 20) {
+    typedef TransactionGraph<List> Graph;
+    EpochGuard guard;
+    bool rebuilt;
+    shared_ptr<const Graph> graph = transactionGraph(lists, rebuilt);
+    if (rebuilt) {
+        printGraphBuild(*graph);
+    }
+    uint32_t start = Graph::NONE;
+    if (account != "all" && !graph->accounts().locate(account, start)) {
+        cout << "No transactions found for account " << account << "." << endl;
+        return;
+    }
+
+    vector<typename Graph::Cycle> cycles;
+    vector<size_t> byLength;
+    auto started = chrono::high_resolution_clock::now();
+    {
+        LatencyTimer latency(implementation, start == Graph::NONE ? "graph cycle scan" : "graph cycles");
+        graph->findCycles(start, maxLength, window, limit, byLength, cycles);
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - started;
+    size_t found = 0;
+    for (size_t count : byLength) found += count;
+
+    cout << "\nRound trips " << (start == Graph::NONE ? "through any account" : "through " + account) << ", 2 to "
+         << maxLength << " transactions within " << window << " s: " << found << " found in " << fixed
+         << setprecision(3) << elapsed.count() << " ms" << endl;
+    for (size_t length = 2; length < byLength.size(); ++length) {
+        cout << "  " << length << " transactions: " << byLength[length] << endl;
+    }
+    cout << setprecision(2);
+    for (size_t i = 0; i < cycles.size() && i < limit; ++i) {
+        const typename Graph::Cycle& c = cycles[i];
+        cout << formatTimestamp(graph->time(c[0])) << " to " << formatTimestamp(graph->time(c.back())) << "  "
+             << graphPath(*graph, c) << "  (";
+        for (size_t e = 0; e < c.size(); ++e) {
+            cout << (e ? ", " : "") << graph->amount(c[e]);
+        }
+        cout << ")" << endl;
+    }
+    if (found > limit) {
+        cout << "... " << (found - limit) << " more" << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Parses "[HOPS] [GAP|any]" and "[LENGTH] [WINDOW]" numbers
+inline bool parseGraphNumber(const string& text, long low, long high, const char* what, long& value) {
+    char* end = nullptr;
+    long parsed = strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed < low || parsed > high) {
+        cout << what << " must be between " << low << " and " << high << "." << endl;
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+template <typename List>
+void transactionGraphMenu(List* lists[4], const string& implementation) {
+    string text, account;
+    long choice = 0;
+    cout << "1. Money flow from an account" << endl;
+    cout << "2. Round trips through an account" << endl;
+    cout << "3. Round trips through any account" << endl;
+    cout << "Enter choice: ";
+    getline(cin, text);
+    if (!parseGraphNumber(text, 1, 3, "Choice", choice)) {
+        return;
+    }
+    if (choice != 3) {
+        cout << "Enter account ID: ";
+        getline(cin, account);
+        if (account.empty()) {
+            cout << "No account entered." << endl;
+            return;
+        }
+    }
+    if (choice == 1) {
+        long hops = 3, gap = 0;
+        cout << "Maximum hops (default 3): ";
+        getline(cin, text);
+        if (!text.empty() && !parseGraphNumber(text, 1, 32, "Hops", hops)) return;
+        cout << "Follow time order? (y/n): ";
+        getline(cin, text);
+        bool ordered = text.empty() || text[0] == 'y' || text[0] == 'Y';
+        if (ordered) {
+            cout << "Maximum seconds between hops (0 for no limit): ";
+            getline(cin, text);
+            if (!text.empty() && !parseGraphNumber(text, 0, numeric_limits<int32_t>::max(), "Gap", gap)) return;
+        }
+        printMoneyFlow(lists, account, (int)hops, ordered, (uint32_t)gap, implementation);
+    } else {
+        long length = 4, window = 7 * 86400;
+        cout << "Maximum transactions per round trip (default 4): ";
+        getline(cin, text);
+        if (!text.empty() && !parseGraphNumber(text, 2, 8, "Length", length)) return;
+        cout << "Window in seconds (default 604800, one week): ";
+        getline(cin, text);
+        if (!text.empty() && !parseGraphNumber(text, 1, numeric_limits<int32_t>::max(), "Window", window)) return;
+        printCycles(lists, choice == 3 ? "all" : account, (int)length, (uint32_t)window, implementation);
+    }
+}
+
+// Fraud Rule Reports
+
+// Lists the rules with their hits and how many of those hit rows are
+// marked as fraud in the data
+void printFraudRules() {
+    vector<FraudRule> rules = fraudRules().list();
+    if (rules.empty()) {
+        cout << "No fraud rules defined." << endl;
+        return;
+    }
+    cout << "\nFraud rules (" << rules.size() << " active, " << fraudRules().rowsEvaluated()
+         << " rows evaluated):" << endl;
+    cout << left << setw(4) << "#" << setw(22) << "Rule" << right << setw(12) << "Hits" << setw(12) << "Fraud"
+         << setw(11) << "Precision" << "  " << left << "Conditions" << endl;
+    cout << fixed << setprecision(1);
+    for (size_t r = 0; r < rules.size(); ++r) {
+        uint64_t hits = rules[r].counters->hits.load(memory_order_relaxed);
+        uint64_t fraud = rules[r].counters->fraudHits.load(memory_order_relaxed);
+        cout << left << setw(4) << r + 1 << setw(22) << rules[r].name << right << setw(12) << hits << setw(12)
+             << fraud << setw(10) << (hits ? 100.0 * fraud / hits : 0.0) << "%  " << left << rules[r].text << endl;
+    }
+    cout << right;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Runs the current rules over every loaded row again, replacing the tags
+// and the counts. Rows are tagged in place, which is only done here and
+// only under the store lock, so it never races an ingest batch.
+template <typename List>
+void retagFraudRules(List* const lists[4], mutex* storeLock) {
+    typedef typename List::Record Record;
+    StoreGuard store(storeLock);
+    EpochGuard guard;
+    fraudRules().resetCounts();
+    shared_ptr<const FraudRuleProgram> rules = fraudRules().program();
+
+    size_t rows = 0, flagged = 0;
+    auto start = chrono::high_resolution_clock::now();
+    for (int c = 0; c < 4; ++c) {
+        lists[c]->forEach([&](const Record& t) {
+            Record& row = const_cast<Record&>(t);
+            if (rules) {
+                flagged += rules->apply(row) != 0;
+            } else {
+                row.rule_hits = 0;
+            }
+            rows++;
+        });
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    if (!rules) {
+        cout << "Successfully cleared fraud rule tags on " << rows << " transactions." << endl;
+        return;
+    }
+    fraudRules().addEvaluated(rows);
+    cout << "Successfully evaluated " << rules->ruleCount() << " rules (" << rules->conditionCount()
+         << " conditions) over " << rows << " transactions: " << flagged << " flagged in " << fixed
+         << setprecision(3) << elapsed.count() << " ms (" << setprecision(1)
+         << (rows ? elapsed.count() * 1e6 / rows : 0.0) << " ns per row)." << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+}
+
+// Prints the first limit rows tagged by the named rule
+template <typename List>
+void printFlaggedTransactions(List* const lists[4], const string& name, size_t limit) {
+    typedef typename List::Record Record;
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    vector<FraudRule> rules = fraudRules().list();
+    size_t r = 0;
+    while (r < rules.size() && rules[r].name != name) r++;
+    if (r == rules.size()) {
+        cout << "No fraud rule named " << name << "." << endl;
+        return;
+    }
+
+    EpochGuard guard;
+    uint32_t bit = 1u << r;
+    size_t matched = 0;
+    cout << "\nRule " << name << ": " << rules[r].text << endl;
+    cout << left << setw(21) << "Timestamp" << setw(16) << "Transaction ID" << setw(16) << "Sender" << setw(16)
+         << "Receiver" << right << setw(12) << "Amount" << "  " << left << setw(15) << "Channel" << setw(12)
+         << "Type" << "Fraud" << endl;
+    cout << fixed << setprecision(2);
+    for (int c = 0; c < 4; ++c) {
+        lists[c]->forEach([&](const Record& t) {
+            if (!(t.rule_hits & bit)) return;
+            if (matched++ < limit) {
+                cout << left << setw(21) << t.timestamp << setw(16) << t.transaction_id << setw(16)
+                     << t.sender_account << setw(16) << t.receiver_account << right << setw(12) << t.amount
+                     << "  " << left << setw(15) << names[c] << setw(12) << t.transaction_type << t.is_fraud << endl;
+            }
+        });
+    }
+    cout << right;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    cout << matched << " transactions flagged by rule " << name
+         << (matched > limit ? " (first " + to_string(limit) + " shown)." : ".") << endl;
+}
+
+template <typename List>
+void fraudRuleMenu(List* lists[4], mutex* storeLock) {
+    string text;
+    cout << "1. Show rules and hit counts" << endl;
+    cout << "2. Add or replace a rule" << endl;
+    cout << "3. Load rules from a file" << endl;
+    cout << "4. Remove a rule" << endl;
+    cout << "5. Show flagged transactions" << endl;
+    cout << "6. Re-evaluate loaded transactions" << endl;
+    cout << "Enter choice: ";
+    getline(cin, text);
+    int choice = atoi(text.c_str());
+
+    switch (choice) {
+        case 1:
+            printFraudRules();
+            break;
+        case 2: {
+            string error;
+            cout << "Enter rule (NAME: CONDITION [and CONDITION ...]," << endl;
+            cout << "  e.g. remote_mobile: amount>5000 and geo_anomaly_score>0.8 and device_used=mobile): ";
+            getline(cin, text);
+            if (!fraudRules().addRule(text, error)) {
+                cout << "Invalid rule: " << error << endl;
+                break;
+            }
+            cout << "Successfully added rule " << text.substr(0, text.find(':')) << "." << endl;
+            retagFraudRules(lists, storeLock);
+            break;
+        }
+        case 3: {
+            size_t added;
+            cout << "Enter rules filename: ";
+            getline(cin, text);
+            bool ok = fraudRules().loadFile(text, added);
+            if (ok) {
+                cout << "Successfully loaded " << added << " fraud rules from " << text << "." << endl;
+            }
+            if (added > 0) {
+                retagFraudRules(lists, storeLock);
+            }
+            break;
+        }
+        case 4:
+            cout << "Enter rule name: ";
+            getline(cin, text);
+            if (!fraudRules().removeRule(text)) {
+                cout << "No fraud rule named " << text << "." << endl;
+                break;
+            }
+            cout << "Successfully removed rule " << text << "." << endl;
+            retagFraudRules(lists, storeLock);
+            break;
+        case 5: {
+            string limitText;
+            cout << "Enter rule name: ";
+            getline(cin, text);
+            cout << "Transactions to show (default 20): ";
+            getline(cin, limitText);
+            int limit = limitText.empty() ? 20 : atoi(limitText.c_str());
+            if (limit <= 0) {
+                cout << "Invalid transaction count." << endl;
+                break;
+            }
+            printFlaggedTransactions(lists, text, limit);
+            break;
+        }
+        case 6:
+            retagFraudRules(lists, storeLock);
+            break;
+        default:
+            cout << "Invalid choice." << endl;
+            break;
+    }
+}
+
+// Query Server
+//
+// A long-running process that loads the data once and answers queries from
+// many clients, over a line protocol or HTTP/1.1. In the line protocol a
+// request such as "filter amount>=500 type=purchase limit=5" gets back one
+// JSON line; the HTTP endpoints take the same predicates as URL parameters.
+// Each worker thread runs its own epoll loop on the shared listening socket
+// (EPOLLEXCLUSIVE wakes one worker per new connection) and owns the
+// connections it accepts. The loaded lists are only read, so workers scan
+// them through forEach under an EpochGuard and never take the store lock.
+
+// A parsed count, filter, aggregate or export request
+struct QuerySpec {
+    vector<QueryPredicate> predicates;
+    int limit;       // rows to return, -1 for all
+    int by;          // aggregate group field
+    bool scan[4];    // channels that can match
+
+    explicit QuerySpec(int defaultLimit = 10) : limit(defaultLimit), by(Q_CHANNEL) {
+        scan[0] = scan[1] = scan[2] = scan[3] = true;
+    }
+};
+
+inline const char* queryChannelName(int c) {
+    static const char* names[4] = {"ACH", "card", "UPI", "wire_transfer"};
+    return names[c];
+}
+
+bool parseQuerySpec(const string& op, const vector<string>& tokens, size_t first, QuerySpec& spec, string& error) {
+    bool rows = op == "filter" || op == "search" || op == "export";
+    for (size_t i = first; i < tokens.size(); ++i) {
+        const string& token = tokens[i];
+        if (rows && token.compare(0, 6, "limit=") == 0) {
+            string value = token.substr(6);
+            char* end = nullptr;
+            long n = strtol(value.c_str(), &end, 10);
+            if (value == "all") {
+                spec.limit = -1;
+            } else if (value.empty() || *end != '\0' || n < 0) {
+                error = "limit must be a count or 'all'";
+                return false;
+            } else {
+                spec.limit = (int)min(n, (long)numeric_limits<int>::max());
+            }
+        } else if (op == "aggregate" && token.compare(0, 3, "by=") == 0) {
+            spec.by = queryFieldIndex(token.substr(3));
+            if (!isGroupField(spec.by)) {
+                error = "cannot group by '" + token.substr(3) + "'";
+                return false;
+            }
+        } else {
+            QueryPredicate p;
+            if (!parseQueryPredicate(token, p, error)) {
+                return false;
+            }
+            spec.predicates.push_back(p);
+        }
+    }
+
+    // Rows are routed by payment channel, so channel=X skips the other lists
+    for (const QueryPredicate& p : spec.predicates) {
+        if (p.field == Q_CHANNEL && p.op == Q_EQ) {
+            int only = channelIndex(p.text);
+            for (int c = 0; c < 4; ++c) {
+                spec.scan[c] = spec.scan[c] && c == only;
+            }
+        }
+    }
+    return true;
+}
+
+// The writers below produce the fields that follow {"ok":true,"op":"..."
+// in a response, for both server protocols.
+template <typename List>
+void writeQueryCount(List* const lists[4], const QuerySpec& spec, ResponseWriter& out) {
+    typedef typename List::Record Record;
+    long counts[4] = {0, 0, 0, 0};
+    long total = 0;
+    for (int c = 0; c < 4; ++c) {
+        if (!spec.scan[c]) continue;
+        if (spec.predicates.empty()) {
+            counts[c] = lists[c]->getCount();
+        } else {
+            lists[c]->forEach([&](const Record& t) { counts[c] += matchesQuery(t, spec.predicates); });
+        }
+        total += counts[c];
+    }
+    out << "\"counts\":{";
+    for (int c = 0; c < 4; ++c) {
+        out << (c ? ",\"" : "\"") << queryChannelName(c) << "\":" << counts[c];
+    }
+    out << "},\"total\":" << total;
+}
+
+template <typename List>
+void writeQueryAggregate(List* const lists[4], const QuerySpec& spec, ResponseWriter& out) {
+    // channel=X is already applied through spec.scan; dropping it lets a
+    // snapshot group-by stay on dictionary codes
+    vector<QueryPredicate> predicates;
+    for (const QueryPredicate& p : spec.predicates) {
+        if (p.field != Q_CHANNEL || p.op != Q_EQ) predicates.push_back(p);
+    }
+    GroupByResult result;
+    groupBy(lists, spec.scan, spec.by, predicates, result);
+    out << "\"by\":\"" << queryFieldNames[spec.by] << "\",\"groups\":[";
+    for (size_t i = 0; i < result.groups.size(); ++i) {
+        GroupAccumulator g = result.groups[i].total();
+        out << (i ? ",{\"key\":" : "{\"key\":");
+        writeJSONString(out, result.groups[i].key);
+        out << ",\"count\":" << g.count << ",\"sum\":" << g.sum << ",\"avg\":" << g.mean()
+            << ",\"min\":" << g.minimum << ",\"max\":" << g.maximum << ",\"fraud_rate\":" << g.fraudRate() << "}";
+    }
+    out << "],\"matched\":" << result.rows;
+}
+
+// A JSON rows array with match counts, or one NDJSON line per row. Checks
+// in with the writer after every row so a streaming writer can spill.
+template <typename List>
+void writeQueryRows(List* const lists[4], const QuerySpec& spec, ResponseWriter& out, bool ndjson) {
+    typedef typename List::Record Record;
+    long matched = 0, returned = 0;
+    if (!ndjson) {
+        out << "\"rows\":[";
+    }
+    for (int c = 0; c < 4; ++c) {
+        if (!spec.scan[c]) continue;
+        lists[c]->forEach([&](const Record& t) {
+            if (out.hasFailed() || !matchesQuery(t, spec.predicates)) {
+                return;
+            }
+            matched++;
+            if (spec.limit >= 0 && returned >= spec.limit) {
+                return;
+            }
+            if (!ndjson && returned > 0) {
+                out << ',';
+            }
+            writeTransactionJSON(out, t);
+            if (ndjson) {
+                out << '\n';
+            }
+            returned++;
+            out.checkpoint();
+        });
+    }
+    if (!ndjson) {
+        out << "],\"matched\":" << matched << ",\"returned\":" << returned;
+    }
+}
+
+// An account request: the account as a bare word or id=, and limit=N
+bool parseAccountRequest(const vector<string>& tokens, size_t first, string& account, int& limit, string& error) {
+    for (size_t i = first; i < tokens.size(); ++i) {
+        const string& token = tokens[i];
+        if (token.compare(0, 6, "limit=") == 0) {
+            char* end = nullptr;
+            long n = strtol(token.c_str() + 6, &end, 10);
+            if (token.size() == 6 || *end != '\0' || n < 0) {
+                error = "limit must be a count";
+                return false;
+            }
+            limit = (int)min(n, (long)numeric_limits<int>::max());
+        } else if (account.empty()) {
+            account = token.compare(0, 3, "id=") == 0 ? token.substr(3) : token;
+        } else {
+            error = "unexpected '" + token + "' after the account";
+            return false;
+        }
+    }
+    if (account.empty()) {
+        error = "account needs an account ID";
+        return false;
+    }
+    return true;
+}
+
+// The latest limit rows of an account, oldest first, from the account index
+template <typename List>
+void writeAccountHistory(List* const lists[4], const string& account, int limit, ResponseWriter& out) {
+    EpochGuard guard;
+    bool rebuilt;
+    shared_ptr<const AccountIndex<List> > index = accountIndex(lists, rebuilt);
+    size_t sent, received;
+    vector<uint32_t> rows = accountRows(*index, account, sent, received);
+    size_t first = rows.size() > (size_t)limit ? rows.size() - limit : 0;
+    out << "\"account\":";
+    writeJSONString(out, account);
+    out << ",\"sent\":" << (long)sent << ",\"received\":" << (long)received << ",\"rows\":[";
+    for (size_t i = first; i < rows.size(); ++i) {
+        if (i > first) out << ',';
+        writeTransactionJSON(out, lists[index->channel(rows[i])]->at(index->ref(rows[i])));
+    }
+    out << "],\"returned\":" << (long)(rows.size() - first);
+}
+
+#ifdef TDMS_HAVE_EPOLL
+static volatile sig_atomic_t queryServerStopping = 0;
+
+void stopQueryServer(int) {
+    queryServerStopping = 1;
+}
+
+struct QueryConnection {
+    int fd;
+    string input;
+    string output;
+    size_t written;
+    uint32_t events;   // what epoll is watching for
+    bool closing;
+    // A streamed response in progress. Appends the next chunk to output
+    // each time the socket drains; returns false once it has appended the
+    // last one. Later pipelined requests wait until it is done.
+    function<bool(string&)> stream;
+
+    explicit QueryConnection(int socket) : fd(socket), written(0), events(EPOLLIN), closing(false) {}
+};
+
+struct HttpRequest {
+    string method, path, query;
+    bool keepAlive;
+    size_t contentLength;
+};
+
+enum QueryProtocol { PROTOCOL_LINE, PROTOCOL_HTTP };
+
+string urlDecode(const string& text) {
+    string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '+') {
+            decoded.push_back(' ');
+        } else if (text[i] == '%' && i + 2 < text.size() && isxdigit((unsigned char)text[i + 1]) &&
+                   isxdigit((unsigned char)text[i + 2])) {
+            decoded.push_back((char)strtol(text.substr(i + 1, 2).c_str(), nullptr, 16));
+            i += 2;
+        } else {
+            decoded.push_back(text[i]);
+        }
+    }
+    return decoded;
+}
+
+// Turns a URL query string into request tokens. NAME=VALUE is an equality
+// predicate, where=EXPR adds any predicate (e.g. where=amount%3E%3D500),
+// field/min/max is an inclusive range, and limit and by pass through.
+bool httpQueryTokens(const string& query, vector<string>& tokens, string& error) {
+    string rangeField, low, high;
+    size_t start = 0;
+    while (start < query.size()) {
+        size_t end = query.find('&', start);
+        if (end == string::npos) end = query.size();
+        string pair = query.substr(start, end - start);
+        start = end + 1;
+        if (pair.empty()) continue;
+        size_t eq = pair.find('=');
+        string name = urlDecode(pair.substr(0, eq));
+        string value = eq == string::npos ? "" : urlDecode(pair.substr(eq + 1));
+        if (name == "where") {
+            tokens.push_back(value);
+        } else if (name == "field") {
+            rangeField = value;
+        } else if (name == "min") {
+            low = value;
+        } else if (name == "max") {
+            high = value;
+        } else {
+            tokens.push_back(name + "=" + value);
+        }
+    }
+    if (rangeField.empty() != (low.empty() && high.empty())) {
+        error = "a range needs field= together with min= and/or max=";
+        return false;
+    }
+    if (!low.empty()) tokens.push_back(rangeField + ">=" + low);
+    if (!high.empty()) tokens.push_back(rangeField + "<=" + high);
+    return true;
+}
+
+bool parseHttpRequest(const string& input, size_t start, size_t headerEnd, HttpRequest& request) {
+    size_t lineEnd = input.find("\r\n", start);
+    istringstream requestLine(input.substr(start, lineEnd - start));
+    string target, version;
+    requestLine >> request.method >> target >> version;
+    if (request.method.empty() || target.empty() || version.compare(0, 5, "HTTP/") != 0) {
+        return false;
+    }
+    size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    request.query = question == string::npos ? "" : target.substr(question + 1);
+    request.keepAlive = version == "HTTP/1.1";
+    request.contentLength = 0;
+
+    for (size_t line = lineEnd + 2; line < headerEnd;) {
+        size_t end = input.find("\r\n", line);
+        size_t colon = input.find(':', line);
+        if (colon != string::npos && colon < end) {
+            string name = input.substr(line, colon - line);
+            string value = input.substr(colon + 1, end - colon - 1);
+            transform(name.begin(), name.end(), name.begin(), ::tolower);
+            transform(value.begin(), value.end(), value.begin(), ::tolower);
+            if (name == "connection") {
+                if (value.find("close") != string::npos) request.keepAlive = false;
+                if (value.find("keep-alive") != string::npos) request.keepAlive = true;
+            } else if (name == "content-length") {
+                request.contentLength = strtoul(value.c_str(), nullptr, 10);
+            }
+        }
+        line = end + 2;
+    }
+    return true;
+}
+
+inline const char* httpReason(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 503: return "Service Unavailable";
+        default: return "Request Header Fields Too Large";
+    }
+}
+
+template <typename List>
+class QueryServer {
+private:
+    typedef typename List::Record Record;
+    typedef typename List::RowRef RowRef;
+    static const size_t MAX_REQUEST = 64 * 1024;
+    static const size_t STREAM_CHUNK = 256 * 1024;
+    static const int STREAM_ROWS = 1000;   // HTTP results larger than this are streamed
+    static const int STREAM_BURST = 4;     // chunks a stream sends before the worker moves on
+    static const long MAX_STREAMS = 16;    // streamed responses in progress, across all workers
+
+    List* lists[4];
+    QueryProtocol protocol;
+    string implementation;
+    string address;
+    string socketPath;   // unlinked on shutdown
+    int listenFd;
+    int workers;
+    vector<thread> threads;
+    chrono::steady_clock::time_point started;
+    atomic<long> requests;
+    atomic<long> openConnections;
+    atomic<long> totalConnections;
+    atomic<long> activeStreams;
+    map<string, LatencyHistogram*> latency;   // looked up once, not per request
+
+    static long elapsedMicros(chrono::steady_clock::time_point start) {
+        return (long)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+    void recordLatency(const string& op, chrono::steady_clock::time_point start) {
+        auto histogram = latency.find(op);
+        if (histogram != latency.end()) {
+            auto elapsed = chrono::steady_clock::now() - start;
+            histogram->second->record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    void writeError(ResponseWriter& out, const string& error) {
+        out << "{\"ok\":false,\"error\":";
+        writeJSONString(out, error);
+        out << "}\n";
+    }
+
+    void writeStats(ResponseWriter& out) {
+        long rows = 0;
+        for (int c = 0; c < 4; ++c) rows += lists[c]->getCount();
+        chrono::duration<double> uptime = chrono::steady_clock::now() - started;
+        out << "\"backend\":\"" << implementation << "\",\"transactions\":" << rows << ",\"workers\":" << workers
+            << ",\"connections\":" << openConnections.load() << ",\"total_connections\":" << totalConnections.load()
+            << ",\"requests\":" << requests.load() << ",\"streams\":" << activeStreams.load()
+            << ",\"uptime_seconds\":" << uptime.count();
+    }
+
+    void writeQueryBody(const string& op, const QuerySpec& spec, ResponseWriter& out) {
+        if (op == "count") {
+            writeQueryCount(lists, spec, out);
+        } else if (op == "aggregate") {
+            writeQueryAggregate(lists, spec, out);
+        } else {
+            writeQueryRows(lists, spec, out, false);
+        }
+    }
+
+    // Line protocol: one request line in, one JSON line out
+    void executeLine(const string& line, QueryConnection& conn) {
+        auto start = chrono::steady_clock::now();
+        istringstream in(line);
+        vector<string> tokens;
+        string token;
+        while (in >> token) {
+            tokens.push_back(token);
+        }
+        string op = tokens.empty() ? "" : tokens[0];
+        ResponseWriter out(conn.output);
+        QuerySpec spec;
+        string error;
+        requests.fetch_add(1, memory_order_relaxed);
+
+        if (op == "ping") {
+            out << "{\"ok\":true,\"op\":\"ping\"";
+        } else if (op == "count" || op == "filter" || op == "search" || op == "aggregate") {
+            if (parseQuerySpec(op, tokens, 1, spec, error)) {
+                resolveValueSets(lists, spec.predicates);
+                out << "{\"ok\":true,\"op\":\"" << op << "\",";
+                writeQueryBody(op, spec, out);
+            }
+        } else if (op == "account") {
+            string account;
+            int limit = 20;
+            if (parseAccountRequest(tokens, 1, account, limit, error)) {
+                out << "{\"ok\":true,\"op\":\"account\",";
+                writeAccountHistory(lists, account, limit, out);
+            }
+        } else if (op == "stats") {
+            out << "{\"ok\":true,\"op\":\"stats\",";
+            writeStats(out);
+        } else if (op == "quit") {
+            conn.closing = true;
+            out << "{\"ok\":true,\"op\":\"quit\"";
+        } else {
+            error = op.empty() ? "empty request" : "unknown request '" + op + "'";
+        }
+
+        if (!error.empty()) {
+            writeError(out, error);
+            return;
+        }
+        recordLatency(op, start);
+        out << ",\"micros\":" << elapsedMicros(start) << "}\n";
+    }
+
+    // Writes the status line and headers into the connection's output. The
+    // body is then written straight after them, and endHttp fills in the
+    // Content-Length left blank here (padded with spaces, which HTTP allows
+    // after a header value). Returns where the length goes.
+    size_t beginHttp(QueryConnection& conn, int status, bool keepAlive) {
+        ResponseWriter out(conn.output);
+        out << "HTTP/1.1 " << status << ' ' << httpReason(status)
+            << "\r\nContent-Type: application/json\r\nConnection: " << (keepAlive ? "keep-alive" : "close")
+            << "\r\nContent-Length: ";
+        size_t length = conn.output.size();
+        conn.output.append(20, ' ');
+        conn.output.append("\r\n\r\n");
+        if (!keepAlive) {
+            conn.closing = true;
+        }
+        return length;
+    }
+
+    void endHttp(QueryConnection& conn, size_t length) {
+        size_t body = conn.output.size() - (length + 24);
+        char digits[24];
+        int n = snprintf(digits, sizeof(digits), "%zu", body);
+        conn.output.replace(length, n, digits, n);
+    }
+
+    void httpError(QueryConnection& conn, int status, const string& error, bool keepAlive) {
+        size_t length = beginHttp(conn, status, keepAlive);
+        ResponseWriter body(conn.output);
+        writeError(body, error);
+        endHttp(conn, length);
+    }
+
+    // A streamed /filter or /export. The matching rows are found in one
+    // pass up front, then formatted a chunk of about STREAM_CHUNK bytes at
+    // a time whenever the socket drains, so a large result never sits in
+    // memory as a whole and a slow client only holds up itself. Rows are
+    // never retired (only the arrays that index them), so the refs stay
+    // valid between chunks without holding an EpochGuard.
+    struct RowStream {
+        QueryServer* server;
+        vector<RowRef> refs[4];
+        long matched;
+        long returned;
+        int channel;
+        size_t next;
+        bool ndjson;
+        bool started;
+        string endpoint;
+        chrono::steady_clock::time_point start;
+
+        RowStream(QueryServer* owner, const string& name, chrono::steady_clock::time_point begun)
+            : server(owner), matched(0), returned(0), channel(0), next(0), ndjson(name == "export"),
+              started(false), endpoint(name), start(begun) {
+            server->activeStreams.fetch_add(1);
+        }
+        ~RowStream() { server->activeStreams.fetch_sub(1); }
+
+        void collect(const QuerySpec& spec) {
+            long taken = 0;
+            for (int c = 0; c < 4; ++c) {
+                if (!spec.scan[c]) continue;
+                server->lists[c]->forEachRef([&](RowRef ref, const Record& t) {
+                    if (!matchesQuery(t, spec.predicates)) {
+                        return;
+                    }
+                    matched++;
+                    if (spec.limit < 0 || taken < spec.limit) {
+                        refs[c].push_back(ref);
+                        taken++;
+                    }
+                });
+            }
+        }
+
+        // Appends the next HTTP chunk to out. The chunk size is written as
+        // eight hex digits once the chunk is formatted, so rows go straight
+        // into the connection's output.
+        bool produce(string& out) {
+            size_t header = out.size();
+            out.append("00000000\r\n");
+            ResponseWriter writer(out);
+            if (!started && !ndjson) {
+                writer << "{\"ok\":true,\"op\":\"" << endpoint << "\",\"rows\":[";
+            }
+            started = true;
+            while (channel < 4 && out.size() - header < STREAM_CHUNK) {
+                if (next == refs[channel].size()) {
+                    channel++;
+                    next = 0;
+                    continue;
+                }
+                if (!ndjson && returned > 0) {
+                    writer << ',';
+                }
+                writeTransactionJSON(writer, server->lists[channel]->at(refs[channel][next++]));
+                if (ndjson) {
+                    writer << '\n';
+                }
+                returned++;
+            }
+            bool more = channel < 4;
+            if (!more && !ndjson) {
+                writer << "],\"matched\":" << matched << ",\"returned\":" << returned
+                       << ",\"micros\":" << elapsedMicros(start) << "}\n";
+            }
+            size_t size = out.size() - header - 10;
+            if (size == 0) {
+                out.resize(header);   // an empty chunk would end the response
+            } else {
+                char digits[24];
+                snprintf(digits, sizeof(digits), "%08zx", size);
+                out.replace(header, 8, digits, 8);
+                out.append("\r\n");
+            }
+            if (!more) {
+                out.append("0\r\n\r\n");
+                server->recordLatency(endpoint, start);
+            }
+            return more;
+        }
+    };
+
+    // Answers one HTTP request into the connection's output, or starts
+    // streaming it
+    void answerHttp(const HttpRequest& request, QueryConnection& conn) {
+        auto start = chrono::steady_clock::now();
+        requests.fetch_add(1, memory_order_relaxed);
+        string endpoint = request.path.size() > 1 ? request.path.substr(1) : "";
+        string op = endpoint == "search" ? "filter" : (endpoint == "groupby" ? "aggregate" : endpoint);
+        if (op != "count" && op != "filter" && op != "aggregate" && op != "export" && op != "account" &&
+            op != "stats") {
+            httpError(conn, 404, "unknown endpoint '" + request.path + "'", request.keepAlive);
+            return;
+        }
+        if (request.method != "GET") {
+            httpError(conn, 405, "only GET is supported", request.keepAlive);
+            return;
+        }
+
+        vector<string> tokens;
+        QuerySpec spec(op == "export" ? -1 : 100);
+        string account, error;
+        int limit = 20;
+        if (op == "account") {
+            if (!httpQueryTokens(request.query, tokens, error) ||
+                !parseAccountRequest(tokens, 0, account, limit, error)) {
+                httpError(conn, 400, error, request.keepAlive);
+                return;
+            }
+        } else if (op != "stats") {
+            if (!httpQueryTokens(request.query, tokens, error) || !parseQuerySpec(op, tokens, 0, spec, error)) {
+                httpError(conn, 400, error, request.keepAlive);
+                return;
+            }
+            resolveValueSets(lists, spec.predicates);
+        }
+
+        if (op == "export" || (op == "filter" && (spec.limit < 0 || spec.limit > STREAM_ROWS))) {
+            if (activeStreams.load() >= MAX_STREAMS) {
+                httpError(conn, 503, "too many streamed responses in progress, retry later", request.keepAlive);
+                return;
+            }
+            shared_ptr<RowStream> rows = make_shared<RowStream>(this, endpoint, start);
+            rows->collect(spec);
+            conn.output += string("HTTP/1.1 200 OK\r\nContent-Type: ") +
+                           (rows->ndjson ? "application/x-ndjson" : "application/json") +
+                           "\r\nTransfer-Encoding: chunked\r\nConnection: " +
+                           (request.keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+            conn.stream = [rows](string& out) { return rows->produce(out); };
+            if (!request.keepAlive) {
+                conn.closing = true;
+            }
+            return;
+        }
+
+        size_t length = beginHttp(conn, 200, request.keepAlive);
+        ResponseWriter body(conn.output);
+        if (op == "stats") {
+            body << "{\"ok\":true,\"op\":\"stats\",";
+            writeStats(body);
+        } else if (op == "account") {
+            body << "{\"ok\":true,\"op\":\"account\",";
+            writeAccountHistory(lists, account, limit, body);
+        } else {
+            body << "{\"ok\":true,\"op\":\"" << endpoint << "\",";
+            writeQueryBody(op, spec, body);
+        }
+        recordLatency(endpoint, start);
+        body << ",\"micros\":" << elapsedMicros(start) << "}\n";
+        endHttp(conn, length);
+    }
+
+    // Answers complete requests until one starts a stream
+    void handleHttp(QueryConnection& conn) {
+        size_t start = 0;
+        while (!conn.closing && !conn.stream) {
+            size_t headerEnd = conn.input.find("\r\n\r\n", start);
+            if (headerEnd == string::npos) {
+                if (conn.input.size() - start > MAX_REQUEST) {
+                    httpError(conn, 431, "request headers too large", false);
+                }
+                break;
+            }
+            HttpRequest request;
+            if (!parseHttpRequest(conn.input, start, headerEnd, request)) {
+                httpError(conn, 400, "malformed request", false);
+                break;
+            }
+            if (request.contentLength > MAX_REQUEST) {
+                httpError(conn, 413, "request body too large", false);
+                break;
+            }
+            size_t end = headerEnd + 4 + request.contentLength;   // bodies are ignored
+            if (end > conn.input.size()) {
+                break;
+            }
+            start = end;
+            answerHttp(request, conn);
+        }
+        conn.input.erase(0, start);
+    }
+
+    // Reads what the socket has and answers every complete request.
+    // Returns false if the connection failed.
+    bool readRequests(QueryConnection& conn) {
+        char buffer[16384];
+        bool peerClosed = false;
+        while (true) {
+            if (conn.stream && conn.input.size() > MAX_REQUEST) {
+                break;   // the rest stays in the socket until the stream is done
+            }
+            ssize_t got = read(conn.fd, buffer, sizeof(buffer));
+            if (got > 0) {
+                conn.input.append(buffer, got);
+                continue;
+            }
+            if (got == 0) {
+                peerClosed = true;
+                break;
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+
+        if (protocol == PROTOCOL_HTTP) {
+            handleHttp(conn);
+        } else {
+            size_t start = 0, newline;
+            while (!conn.closing && (newline = conn.input.find('\n', start)) != string::npos) {
+                size_t end = (newline > start && conn.input[newline - 1] == '\r') ? newline - 1 : newline;
+                executeLine(conn.input.substr(start, end - start), conn);
+                start = newline + 1;
+            }
+            conn.input.erase(0, start);
+            if (conn.input.size() > MAX_REQUEST) {
+                conn.output += "{\"ok\":false,\"error\":\"request too long\"}\n";
+                conn.closing = true;
+            }
+        }
+        if (peerClosed) {
+            conn.closing = true;
+        }
+        return true;
+    }
+
+    // Writes pending output, asking for EPOLLOUT only while the socket is
+    // full or a stream has more to send. A stream gets at most STREAM_BURST
+    // chunks per call, so one fast reader cannot monopolise the worker.
+    // Returns false once the connection should be closed.
+    bool flush(QueryConnection& conn, int epollFd) {
+        int chunks = 0;
+        while (true) {
+            while (conn.written < conn.output.size()) {
+                ssize_t sent = send(conn.fd, conn.output.data() + conn.written, conn.output.size() - conn.written,
+                                    MSG_NOSIGNAL);
+                if (sent > 0) {
+                    conn.written += sent;
+                } else if (sent < 0 && errno == EINTR) {
+                    continue;
+                } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    break;
+                } else {
+                    return false;
+                }
+            }
+            if (conn.written < conn.output.size()) {
+                break;
+            }
+            conn.output.clear();
+            conn.written = 0;
+            if (conn.stream) {
+                if (chunks++ == STREAM_BURST) {
+                    break;
+                }
+                if (!conn.stream(conn.output)) {
+                    conn.stream = nullptr;
+                    handleHttp(conn);   // pipelined requests held back by the stream
+                }
+            } else if (conn.closing) {
+                return false;
+            } else {
+                break;
+            }
+        }
+        // While a stream runs, requests behind it are not read, so a client
+        // that keeps pipelining cannot grow input without bound
+        bool pending = conn.written < conn.output.size() || conn.stream;
+        uint32_t events = conn.stream ? EPOLLOUT : (pending ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+        if (events != conn.events) {
+            epoll_event ev;
+            ev.events = events;
+            ev.data.ptr = &conn;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+            conn.events = events;
+        }
+        return true;
+    }
+
+    void acceptConnections(int epollFd, map<int, unique_ptr<QueryConnection> >& connections) {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                return;   // EAGAIN: another worker took it, or the backlog is empty
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // fails harmlessly on Unix sockets
+            QueryConnection* conn = new QueryConnection(fd);
+            connections[fd].reset(conn);
+            epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.ptr = conn;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+            openConnections.fetch_add(1, memory_order_relaxed);
+            totalConnections.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    void workerLoop() {
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            cout << "Failed to create epoll instance: " << strerror(errno) << endl;
+            return;
+        }
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.ptr = nullptr;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+
+        map<int, unique_ptr<QueryConnection> > connections;
+        epoll_event events[64];
+        while (!queryServerStopping) {
+            int n = epoll_wait(epollFd, events, 64, 200);   // wakes up to notice Ctrl+C
+            for (int i = 0; i < n; ++i) {
+                if (events[i].data.ptr == nullptr) {
+                    acceptConnections(epollFd, connections);
+                    continue;
+                }
+                QueryConnection* conn = static_cast<QueryConnection*>(events[i].data.ptr);
+                if (!readRequests(*conn) || !flush(*conn, epollFd)) {
+                    epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+                    close(conn->fd);
+                    connections.erase(conn->fd);
+                    openConnections.fetch_sub(1, memory_order_relaxed);
+                }
+            }
+        }
+
+        for (auto& entry : connections) {
+            close(entry.first);
+        }
+        openConnections.fetch_sub((long)connections.size(), memory_order_relaxed);
+        close(epollFd);
+    }
+
+public:
+    QueryServer(List* source[4], const string& implementationName, QueryProtocol serverProtocol)
+        : protocol(serverProtocol), implementation(implementationName), listenFd(-1), workers(0),
+          requests(0), openConnections(0), totalConnections(0), activeStreams(0) {
+        for (int c = 0; c < 4; ++c) {
+            lists[c] = source[c];
+        }
+        static const char* lineOps[] = {"ping", "count", "filter", "search", "aggregate", "account", "stats"};
+        static const char* httpOps[] = {"count", "search", "filter", "groupby", "export", "account", "stats"};
+        const char* const* ops = protocol == PROTOCOL_HTTP ? httpOps : lineOps;
+        size_t opCount = protocol == PROTOCOL_HTTP ? sizeof(httpOps) / sizeof(httpOps[0])
+                                                   : sizeof(lineOps) / sizeof(lineOps[0]);
+        for (size_t i = 0; i < opCount; ++i) {
+            latency[ops[i]] = &latencyRegistry().get(implementation,
+                                                     string(protocol == PROTOCOL_HTTP ? "http " : "server ") + ops[i]);
+        }
+    }
+
+    ~QueryServer() {
+        if (listenFd >= 0) {
+            close(listenFd);
+        }
+        if (!socketPath.empty()) {
+            unlink(socketPath.c_str());
+        }
+    }
+
+    // A bare port number listens on 127.0.0.1; anything else is a Unix
+    // socket path.
+    bool listenOn(const string& where) {
+        address = where;
+        bool isPort = !where.empty() && where.find_first_not_of("0123456789") == string::npos;
+        if (isPort) {
+            int port = atoi(where.c_str());
+            if (port <= 0 || port > 65535) {
+                cout << "Invalid port: " << where << endl;
+                return false;
+            }
+            listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listenFd < 0) {
+                cout << "Failed to create socket: " << strerror(errno) << endl;
+                return false;
+            }
+            int one = 1;
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            sockaddr_in addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons((uint16_t)port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+                cout << "Failed to bind 127.0.0.1:" << port << ": " << strerror(errno) << endl;
+                return false;
+            }
+            address = "127.0.0.1:" + where;
+        } else {
+            sockaddr_un addr;
+            memset(&addr, 0, sizeof(addr));
+            if (where.empty() || where.size() >= sizeof(addr.sun_path)) {
+                cout << "Invalid socket path: " << where << endl;
+                return false;
+            }
+            // Replace a socket left behind by an earlier run, but never a regular file
+            struct stat st;
+            if (stat(where.c_str(), &st) == 0) {
+                if (!S_ISSOCK(st.st_mode)) {
+                    cout << "Refusing to replace non-socket file: " << where << endl;
+                    return false;
+                }
+                unlink(where.c_str());
+            }
+            listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listenFd < 0) {
+                cout << "Failed to create socket: " << strerror(errno) << endl;
+                return false;
+            }
+            addr.sun_family = AF_UNIX;
+            memcpy(addr.sun_path, where.c_str(), where.size());
+            if (::bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+                cout << "Failed to bind " << where << ": " << strerror(errno) << endl;
+                return false;
+            }
+            socketPath = where;
+        }
+        if (listen(listenFd, SOMAXCONN) != 0) {
+            cout << "Failed to listen on " << address << ": " << strerror(errno) << endl;
+            return false;
+        }
+        return true;
+    }
+
+    void start(int workerCount) {
+        workers = max(1, min(workerCount, EpochManager::MAX_READERS / 4));
+        started = chrono::steady_clock::now();
+        long rows = 0;
+        for (int c = 0; c < 4; ++c) rows += lists[c]->getCount();
+        cout << "Serving " << rows << " transactions (" << implementation << " Implementation) "
+             << (protocol == PROTOCOL_HTTP ? "over HTTP " : "") << "on " << address << " with " << workers
+             << " worker(s)." << endl;
+        for (int w = 0; w < workers; ++w) {
+            threads.emplace_back(&QueryServer::workerLoop, this);
+        }
+    }
+
+    // Returns once stopQueryServer has run and the workers have finished
+    void wait() {
+        for (thread& t : threads) {
+            t.join();
+        }
+        chrono::duration<double> uptime = chrono::steady_clock::now() - started;
+        cout << (protocol == PROTOCOL_HTTP ? "HTTP server" : "Server") << " stopped: " << requests.load()
+             << " requests from " << totalConnections.load() << " connections in " << fixed << setprecision(1)
+             << uptime.count() << " seconds." << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+};
+#endif
+
+// Serves already loaded lists on a line-protocol address, an HTTP address
+// or both, until SIGINT or SIGTERM
+template <typename List>
+int serveQueries(List* lists[4], const string& lineAddress, const string& httpAddress, int workers,
+                 const string& implementation) {
+#ifdef TDMS_HAVE_EPOLL
+    QueryServer<List> lineServer(lists, implementation, PROTOCOL_LINE);
+    QueryServer<List> httpServer(lists, implementation, PROTOCOL_HTTP);
+    if ((!lineAddress.empty() && !lineServer.listenOn(lineAddress)) ||
+        (!httpAddress.empty() && !httpServer.listenOn(httpAddress))) {
+        return 1;
+    }
+    // Account lookups are the most frequent request, so the index is built
+    // before the first client rather than by it
+    {
+        EpochGuard guard;
+        bool rebuilt;
+        shared_ptr<const AccountIndex<List> > index = accountIndex(lists, rebuilt);
+        cout << "Account index: " << index->accountCount() << " accounts, " << index->rowCount() << " rows in "
+             << fixed << setprecision(1) << index->buildTime() << " ms" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+    queryServerStopping = 0;
+    signal(SIGINT, stopQueryServer);
+    signal(SIGTERM, stopQueryServer);
+    if (!lineAddress.empty()) lineServer.start(workers);
+    if (!httpAddress.empty()) httpServer.start(workers);
+    cout << "Press Ctrl+C to stop." << endl;
+    if (!lineAddress.empty()) lineServer.wait();
+    if (!httpAddress.empty()) httpServer.wait();
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    latencyRegistry().print();
+    return 0;
+#else
+    (void)lists; (void)lineAddress; (void)httpAddress; (void)workers; (void)implementation;
+    cout << "The query server needs epoll and is only available on Linux." << endl;
+    return 1;
+#endif
+}
+
+// Command-line / Batch Mode
+//
+// Runs a fixed list of operations without any prompts, e.g.
+//   project3 --backend array --input data.csv --sort location
+//            --search type=purchase --export out.ndjson
+// Operations run in the order given; --batch FILE reads more of them
+// from a file, one per line ("search location=Tokyo"), '#' for comments.
+// Every operation is timed, and a summary follows the last one.
+struct BatchOperation {
+    string name;
+    string argument;
+};
+
+void printCommandLineUsage() {
+    cout << "Usage: project3 [--perf] --backend linked|array|snapshot --input FILE [operations]\n"
+         << "       project3 [--perf] --benchmark FILE [repetitions]\n"
+         << "Operations (run in order):\n"
+         << "  --channel ach|card|upi|wire|all   channels used by later operations (default all)\n"
+         << "  --count                           transactions per channel\n"
+         << "  --display N                       first N transactions of each channel\n"
+         << "  --sort location                   merge sort by location\n"
+         << "  --search FIELD=VALUE              linear search (type, location or fraud)\n"
+         << "  --search FIELD^=PREFIX            prefix search of location, merchant or type, over\n"
+         << "                                    the distinct values rather than the rows\n"
+         << "  --search FIELD*=TEXT              substring search of the same fields\n"
+         << "  --binary-search FIELD=VALUE       binary search (type or location)\n"
+         << "  --export FILE                     .ndjson, .tdc (archive) or .snap for all channels,\n"
+         << "                                    .json for a single selected channel\n"
+         << "  --groupby FIELD                   count, sum, mean, min, max and fraud rate per value\n"
+         << "                                    of a text field, per channel and in total\n"
+         << "  --windows \"SECONDS [ACCOUNT]\"     hourly and per-minute windows, sliding windows of\n"
+         << "                                    SECONDS per channel and for ACCOUNT (or the busiest)\n"
+         << "  --quantiles METRIC                p50/p95/p99 of amount, spending_deviation or\n"
+         << "                                    geo_anomaly per channel and location\n"
+         << "  --distinct \"BY [exact]\"           distinct senders, IPs and devices per channel, location\n"
+         << "                                    or day (HyperLogLog); exact adds set-based checks\n"
+         << "  --account \"ID [N]\"                latest N (default 20) transactions sent or received\n"
+         << "                                    by account ID, from the account index\n"
+         << "  --flow \"ID [HOPS] [GAP|any]\"     accounts reached from ID in up to HOPS (default 3)\n"
+         << "                                    time-ordered transactions, at most GAP seconds apart\n"
+         << "  --cycles \"ID|all [LEN] [WINDOW]\"  round trips of up to LEN (default 4) transactions\n"
+         << "                                    within WINDOW seconds (default 604800)\n"
+         << "  --rule-hits                       hits per fraud rule, and how many were marked fraud\n"
+         << "  --top \"FIELD [K] [asc] [PRED...]\" K (default 10) rows with the largest (asc: smallest)\n"
+         << "                                    numeric FIELD, optionally filtered, without sorting\n"
+         << "  --memory                          memory report\n"
+         << "  --latency                         query latency histograms\n"
+         << "  --batch FILE                      operations from FILE, one per line without '--'\n"
+         << "  --serve SOCKET|PORT               after the operations, answer queries on a Unix socket\n"
+         << "                                    or on 127.0.0.1:PORT until interrupted\n"
+         << "  --http SOCKET|PORT                the same over HTTP/1.1 (/count, /search, /filter,\n"
+         << "                                    /groupby, /export, /account, /stats); may be used\n"
+         << "                                    with --serve\n"
+         << "Options:\n"
+         << "  --rules FILE                      fraud rules evaluated on every imported row, one per\n"
+         << "                                    line: NAME: CONDITION [and CONDITION ...]\n"
+         << "  --workers N                       server event-loop threads (default: one per core)\n"
+         << "  --quiet                           print only timings, not operation output\n";
+}
+
+// The conditions of a batch search, one per word; a word without an
+// operator continues the previous value, as in location=New York
+inline vector<string> searchConditions(const string& text) {
+    vector<string> conditions;
+    istringstream words(text);
+    string word;
+    while (words >> word) {
+        if (word.find_first_of("=!<>") == string::npos && !conditions.empty()) {
+            conditions.back() += " " + word;
+        } else {
+            conditions.push_back(word);
+        }
+    }
+    return conditions;
+}
+
+// Prints the rows of each selected channel that match every condition,
+// the first limit of them (default 10) in the list's display format.
+// Prefix and substring conditions are first resolved to the values they
+// match, so they combine with any other predicate.
+template <typename List>
+bool printSearchRows(List* const lists[4], const bool selected[4], const vector<string>& conditions,
+                     const string& implementation) {
+    typedef typename List::RowRef RowRef;
+    typedef typename List::Record Record;
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    QuerySpec spec;
+    string error, description;
+    if (!parseQuerySpec("search", conditions, 0, spec, error)) {
+        cout << "Invalid search: " << error << endl;
+        return false;
+    }
+    resolveValueSets(lists, spec.predicates);
+    for (const string& condition : conditions) {
+        if (condition.compare(0, 6, "limit=") != 0) description += (description.empty() ? "" : " and ") + condition;
+    }
+
+    EpochGuard guard;
+    for (int c = 0; c < 4; ++c) {
+        if (!selected[c]) continue;
+        vector<RowRef> shown;
+        long found = 0;
+        auto start = chrono::high_resolution_clock::now();
+        if (spec.scan[c]) {
+            LatencyTimer latency(implementation, "predicate search");
+            lists[c]->forEachRef([&](RowRef ref, const Record& t) {
+                if (!matchesQuery(t, spec.predicates)) return;
+                if (spec.limit < 0 || found < spec.limit) shown.push_back(ref);
+                found++;
+            });
+        }
+        chrono::duration<double> elapsed = chrono::high_resolution_clock::now() - start;
+
+        cout << names[c] << ":" << endl;
+        cout << "\nSearch Results for " << description << ":" << endl;
+        for (size_t i = 0; i < shown.size(); ++i) {
+            List::displayTransaction(lists[c]->at(shown[i]), (int)(i + 1));
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        if ((long)shown.size() < found) {
+            cout << "Displaying " << shown.size() << " of " << found << " matches." << endl;
+        }
+        cout << "Found " << found << " matches in " << elapsed.count() << " seconds" << endl;
+    }
+    return true;
+}
+
+bool readBatchFile(const string& filename, vector<BatchOperation>& operations) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cout << "Failed to open batch file: " << filename << endl;
+        return false;
+    }
+    string line;
+    while (getline(file, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') {
+            continue;
+        }
+        line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+        size_t space = line.find_first_of(" \t");
+        BatchOperation op;
+        op.name = line.substr(0, space);
+        if (space != string::npos) {
+            op.argument = line.substr(line.find_first_not_of(" \t", space));
+        }
+        operations.push_back(op);
+    }
+    return true;
+}
+
+inline bool endsWith(const string& text, const string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Runs one operation against the selected channels. Returns false on a
+// bad operation or a failed export.
+template <typename List>
+bool runBatchOperation(const BatchOperation& op, List* lists[4], bool selected[4],
+                       const string& implementation, const string& loadedFile) {
+    static const char* names[4] = {"ACH", "Card", "UPI", "Wire Transfer"};
+    string field, value;
+    size_t equals = op.argument.find('=');
+    if (equals != string::npos) {
+        field = op.argument.substr(0, equals);
+        value = op.argument.substr(equals + 1);
+    }
+
+    if (op.name == "channel") {
+        string channel = op.argument;
+        transform(channel.begin(), channel.end(), channel.begin(), ::tolower);
+        const char* keys[4] = {"ach", "card", "upi", "wire"};
+        bool known = channel == "all";
+        for (int c = 0; c < 4; ++c) {
+            selected[c] = channel == "all" || channel == keys[c];
+            known = known || channel == keys[c];
+        }
+        if (!known) {
+            cout << "Unknown channel: " << op.argument << endl;
+        }
+        return known;
+    } else if (op.name == "count") {
+        for (int c = 0; c < 4; ++c) {
+            if (selected[c]) cout << "- " << names[c] << ": " << lists[c]->getCount() << endl;
+        }
+    } else if (op.name == "display") {
+        int limit = atoi(op.argument.c_str());
+        for (int c = 0; c < 4; ++c) {
+            if (selected[c]) lists[c]->displayTransactions(limit > 0 ? limit : 10);
+        }
+    } else if (op.name == "sort") {
+        if (op.argument != "location") {
+            cout << "Only sorting by location is supported." << endl;
+            return false;
+        }
+        for (int c = 0; c < 4; ++c) {
+            if (selected[c]) lists[c]->sortByLocation();
+        }
+        epochManager().reclaim();
+    } else if (op.name == "search" && searchConditions(op.argument).size() > 1) {
+        return printSearchRows(lists, selected, searchConditions(op.argument), implementation);
+    } else if (op.name == "search" && equals != string::npos && equals > 0 &&
+               (field.back() == '^' || field.back() == '*')) {
+        bool substring = field.back() == '*';
+        field.erase(field.size() - 1);
+        if (textSearchField(field) < 0) {
+            cout << "Expected location, merchant or type before " << (substring ? "*=" : "^=")
+                 << ", got: " << op.argument << endl;
+            return false;
+        }
+        for (int c = 0; c < 4; ++c) {
+            if (!selected[c]) continue;
+            cout << names[c] << ":" << endl;
+            textSearch(*lists[c], field, value, substring, implementation);
+        }
+    } else if (op.name == "search" || op.name == "binary-search") {
+        bool binary = op.name == "binary-search";
+        if (equals == string::npos || (field != "type" && field != "location" && (binary || field != "fraud"))) {
+            cout << "Expected " << (binary ? "type=VALUE or location=VALUE" : "type=, location= or fraud=VALUE")
+                 << ", got: " << op.argument << endl;
+            return false;
+        }
+        for (int c = 0; c < 4; ++c) {
+            if (!selected[c]) continue;
+            cout << names[c] << ":";
+            if (binary) {
+                lists[c]->binarySearch(value, field);
+            } else {
+                lists[c]->linearSearch(value, field);
+            }
+        }
+    } else if (op.name == "export") {
+        const string& filename = op.argument;
+        if (filename.empty()) {
+            cout << "Export needs a filename." << endl;
+            return false;
+        }
+        if (endsWith(filename, ".ndjson")) {
+            return exportNDJSON(filename, *lists[0], *lists[1], *lists[2], *lists[3]);
+        } else if (endsWith(filename, ".tdc")) {
+            return exportColumnar(filename, *lists[0], *lists[1], *lists[2], *lists[3]);
+        } else if (endsWith(filename, ".snap")) {
+            if (filename == loadedFile) {
+                cout << "Cannot overwrite the snapshot that is currently loaded." << endl;
+                return false;
+            }
+            return saveSnapshot(filename, *lists[0], *lists[1], *lists[2], *lists[3]);
+        }
+        int only = -1;
+        for (int c = 0; c < 4; ++c) {
+            if (selected[c]) only = (only == -1) ? c : -2;
+        }
+        if (only < 0) {
+            cout << "JSON array export covers one channel; select one with --channel, "
+                 << "or export .ndjson, .tdc or .snap for all channels." << endl;
+            return false;
+        }
+        return lists[only]->exportToJSON(filename);
+    } else if (op.name == "groupby") {
+        int field = queryFieldIndex(op.argument);
+        if (!isGroupField(field)) {
+            cout << "Cannot group by '" << op.argument << "'." << endl;
+            return false;
+        }
+        GroupByResult result;
+        groupBy(lists, selected, field, vector<QueryPredicate>(), result);
+        printGroupBy(result, true);
+    } else if (op.name == "windows") {
+        istringstream words(op.argument);
+        string length, account;
+        int64_t seconds = 3600;
+        words >> length >> account;
+        if (!length.empty() && !parseWindowSeconds(length, seconds)) {
+            return false;
+        }
+        printTimeWindows(lists, seconds, account);
+    } else if (op.name == "quantiles") {
+        int metric = sketchMetricIndex(op.argument);
+        if (metric < 0) {
+            cout << "Unknown metric '" << op.argument << "'; use amount, spending_deviation or geo_anomaly." << endl;
+            return false;
+        }
+        printQuantiles(lists, metric, true);
+    } else if (op.name == "distinct") {
+        istringstream words(op.argument);
+        string by, mode;
+        words >> by >> mode;
+        if (by.empty()) {
+            by = "channel";
+        }
+        if ((by != "channel" && by != "location" && by != "day") || (!mode.empty() && mode != "exact")) {
+            cout << "Expected channel, location or day, optionally followed by 'exact', got: " << op.argument << endl;
+            return false;
+        }
+        printDistinctCounts(lists, by, mode == "exact");
+    } else if (op.name == "account") {
+        istringstream words(op.argument);
+        string account, limitText;
+        words >> account >> limitText;
+        int limit = limitText.empty() ? 20 : atoi(limitText.c_str());
+        if (account.empty() || limit <= 0) {
+            cout << "Expected an account ID, optionally followed by a count, got: " << op.argument << endl;
+            return false;
+        }
+        printAccountHistory(lists, account, limit, implementation);
+    } else if (op.name == "flow" || op.name == "cycles") {
+        bool flow = op.name == "flow";
+        istringstream words(op.argument);
+        string account, first, second;
+        words >> account >> first >> second;
+        long bound = flow ? 3 : 4, seconds = flow ? 0 : 7 * 86400;
+        bool ordered = !flow || second != "any";
+        if (account.empty()) {
+            cout << "Expected an account ID" << (flow ? "" : " or 'all'") << ", got: " << op.argument << endl;
+            return false;
+        }
+        if ((!first.empty() && !parseGraphNumber(first, flow ? 1 : 2, flow ? 32 : 8, flow ? "Hops" : "Length", bound)) ||
+            (!second.empty() && ordered &&
+             !parseGraphNumber(second, flow ? 0 : 1, numeric_limits<int32_t>::max(), flow ? "Gap" : "Window", seconds))) {
+            return false;
+        }
+        if (flow) {
+            printMoneyFlow(lists, account, (int)bound, ordered, (uint32_t)seconds, implementation);
+        } else {
+            printCycles(lists, account, (int)bound, (uint32_t)seconds, implementation);
+        }
+    } else if (op.name == "memory") {
+        printMemoryReport(*lists[0], *lists[1], *lists[2], *lists[3], implementation);
+    } else if (op.name == "latency") {
+        latencyRegistry().print();
+    } else if (op.name == "rule-hits") {
+        printFraudRules();
+    } else if (op.name == "top") {
+        TopKQuery query;
+        string error;
+        if (!parseTopKRequest(op.argument, query, error)) {
+            cout << "Invalid top-K query: " << error << endl;
+            return false;
+        }
+        resolveValueSets(lists, query.predicates);
+        printTopK(lists, selected, query, implementation);
+    } else {
+        cout << "Unknown operation: " << op.name << endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename List>
+int runBatch(List* lists[4], const vector<BatchOperation>& operations, double loadMs,
+             const string& implementation, const string& loadedFile, bool quiet) {
+    bool selected[4] = {true, true, true, true};
+    vector<double> timings;
+    int failures = 0;
+
+    for (size_t i = 0; i < operations.size(); ++i) {
+        const BatchOperation& op = operations[i];
+        bool ok;
+        auto start = chrono::high_resolution_clock::now();
+        {
+            unique_ptr<SilenceOutput> quietOutput(quiet ? new SilenceOutput() : nullptr);
+            ok = runBatchOperation(op, lists, selected, implementation, loadedFile);
+        }
+        chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+        timings.push_back(elapsed.count());
+        cout << "[" << (i + 1) << "/" << operations.size() << "] " << op.name
+             << (op.argument.empty() ? "" : " " + op.argument) << ": " << fixed << setprecision(3)
+             << elapsed.count() << " ms" << (ok ? "" : " (failed)") << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        if (!ok) {
+            failures++;
+        }
+    }
+
+    cout << "\nBatch Summary (" << implementation << " Implementation):" << endl;
+    cout << fixed << setprecision(3);
+    cout << left << setw(40) << "load" << right << setw(14) << loadMs << " ms" << endl;
+    double total = loadMs;
+    for (size_t i = 0; i < operations.size(); ++i) {
+        string label = operations[i].name + (operations[i].argument.empty() ? "" : " " + operations[i].argument);
+        cout << left << setw(40) << label.substr(0, 39) << right << setw(14) << timings[i] << " ms" << endl;
+        total += timings[i];
+    }
+    cout << left << setw(40) << "total" << right << setw(14) << total << " ms" << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    if (failures > 0) {
+        cout << failures << " operation(s) failed." << endl;
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+template <typename List, typename Loader>
+int runCommandLineBackend(Loader load, const vector<BatchOperation>& operations,
+                          const string& implementation, const string& input, bool quiet,
+                          const string& serveAddress, const string& httpAddress, int workers) {
+    List ach, card, upi, wire;
+    List* lists[4] = {&ach, &card, &upi, &wire};
+    bool ok;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        unique_ptr<SilenceOutput> quietOutput(quiet ? new SilenceOutput() : nullptr);
+        ok = load(ach, card, upi, wire);
+    }
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now() - start;
+    if (!ok) {
+        cout << "Failed to load " << input << endl;
+        return 1;
+    }
+    cout << "Loaded " << (ach.getCount() + card.getCount() + upi.getCount() + wire.getCount())
+         << " transactions from " << input << " in " << fixed << setprecision(3) << elapsed.count() << " ms" << endl;
+    cout.unsetf(ios::fixed);
+    cout << setprecision(6);
+    if (serveAddress.empty() && httpAddress.empty()) {
+        return runBatch(lists, operations, elapsed.count(), implementation, input, quiet);
+    }
+    if (!operations.empty() && runBatch(lists, operations, elapsed.count(), implementation, input, quiet) != 0) {
+        return 1;
+    }
+    return serveQueries(lists, serveAddress, httpAddress, workers, implementation);
+}
+
+// Parses flags and runs the batch. Returns the process exit code.
+int runCommandLine(int argc, char* argv[]) {
+    string backend, input, serveAddress, httpAddress;
+    int workers = (int)max(1u, thread::hardware_concurrency());
+    bool quiet = false;
+    vector<BatchOperation> operations;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printCommandLineUsage();
+            return 0;
+        } else if (arg == "--quiet") {
+            quiet = true;
+            continue;
+        } else if (arg == "--count" || arg == "--memory" || arg == "--latency" || arg == "--rule-hits") {
+            operations.push_back({arg.substr(2), ""});
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+            cout << (arg.compare(0, 2, "--") != 0 ? "Unexpected argument: " : "Missing value for ") << arg << endl;
+            printCommandLineUsage();
+            return 2;
+        }
+        string value = argv[++i];
+        if (arg == "--backend") {
+            backend = value;
+        } else if (arg == "--input") {
+            input = value;
+        } else if (arg == "--serve") {
+            serveAddress = value;
+        } else if (arg == "--http") {
+            httpAddress = value;
+        } else if (arg == "--workers") {
+            workers = atoi(value.c_str());
+            if (workers <= 0) {
+                cout << "Invalid worker count: " << value << endl;
+                return 2;
+            }
+        } else if (arg == "--batch") {
+            if (!readBatchFile(value, operations)) {
+                return 2;
+            }
+        } else if (arg == "--rules") {
+            size_t added;
+            if (!fraudRules().loadFile(value, added)) {
+                return 2;
+            }
+        } else if (arg == "--channel" || arg == "--display" || arg == "--sort" || arg == "--search" ||
+                   arg == "--binary-search" || arg == "--export" || arg == "--groupby" ||
+                   arg == "--windows" || arg == "--quantiles" ||
+                   arg == "--distinct" || arg == "--account" || arg == "--flow" || arg == "--cycles" ||
+                   arg == "--top") {
+            operations.push_back({arg.substr(2), value});
+        } else {
+            cout << "Unknown option: " << arg << endl;
+            printCommandLineUsage();
+            return 2;
+        }
+    }
+
+    if (input.empty()) {
+        cout << "Missing --input FILE." << endl;
+        printCommandLineUsage();
+        return 2;
+    }
+
+    if (backend == "linked" || backend == "linkedlist" || backend == "linked-list") {
+        return runCommandLineBackend<TransactionList>(
+            [&](TransactionList& a, TransactionList& c, TransactionList& u, TransactionList& w) {
+                return importData(input, a, c, u, w);
+            }, operations, "Linked List", input, quiet, serveAddress, httpAddress, workers);
+    } else if (backend == "array" || backend.empty()) {
+        return runCommandLineBackend<ArrayTransactionList>(
+            [&](ArrayTransactionList& a, ArrayTransactionList& c, ArrayTransactionList& u, ArrayTransactionList& w) {
+                return importData(input, a, c, u, w);
+            }, operations, "Array", input, quiet, serveAddress, httpAddress, workers);
+    } else if (backend == "snapshot") {
+        if (fraudRules().program()) {
+            cout << "Fraud rules only run on Linked List and Array imports; snapshots are read-only." << endl;
+        }
+        SnapshotFile snapshot;
+        return runCommandLineBackend<SnapshotTransactionList>(
+            [&](SnapshotTransactionList& a, SnapshotTransactionList& c, SnapshotTransactionList& u,
+                SnapshotTransactionList& w) {
+                return loadSnapshot(input, snapshot, a, c, u, w);
+            }, operations, "Snapshot", input, quiet, serveAddress, httpAddress, workers);
+    }
+    cout << "Unknown backend: " << backend << " (use linked, array or snapshot)" << endl;
+    return 2;
+}
+
+// benchmark.cpp includes this file with TDMS_NO_MAIN defined
+#ifndef TDMS_NO_MAIN
+int main(int argc, char* argv[]) {
+    // --perf turns on hardware counter reporting (same as TDMS_PERF=1)
+    if (argc >= 2 && string(argv[1]) == "--perf") {
+        setPerfEnabled(true);
+        argv[1] = argv[0];
+        argc--;
+        argv++;
+    }
+    if (perfEnabled()) {
+        readPerfCounters();   // opens the counters now so any warning is visible
+    }
+
+    // TDMS_RULES=FILE loads fraud rules that every import then evaluates
+    const char* rulesFile = getenv("TDMS_RULES");
+    if (rulesFile && *rulesFile) {
+        size_t added;
+        if (!fraudRules().loadFile(rulesFile, added)) {
+            return 1;
+        }
+        cout << "Successfully loaded " << added << " fraud rules from " << rulesFile << "." << endl;
+    }
+
+    // Non-interactive benchmark: project3 [--perf] --benchmark <data file> [repetitions]
+    if (argc >= 3 && string(argv[1]) == "--benchmark") {
+        int repetitions = argc >= 4 ? atoi(argv[3]) : 5;
+        if (repetitions <= 0) {
+            cout << "Invalid repetition count." << endl;
+            return 1;
+        }
+        return compareEfficiency(argv[2], repetitions) ? 0 : 1;
+    }
+
+    // Any other flags select the non-interactive batch mode
+    if (argc >= 2) {
+        return runCommandLine(argc, argv);
+    }
+
+    TransactionList ll_achList, ll_cardList, ll_upiList, ll_wireList;
+    ArrayTransactionList arr_achList, arr_cardList, arr_upiList, arr_wireList;
+    SnapshotFile snapshot;
+    SnapshotTransactionList snap_achList, snap_cardList, snap_upiList, snap_wireList;
+    mutex storeMutex;
+    IngestQueue<TransactionList> ll_queue(ll_achList, ll_cardList, ll_upiList, ll_wireList, storeMutex);
+    IngestQueue<ArrayTransactionList> arr_queue(arr_achList, arr_cardList, arr_upiList, arr_wireList, storeMutex);
+    vector<unique_ptr<LiveTail<TransactionList> > > ll_tails;
+    vector<unique_ptr<LiveTail<ArrayTransactionList> > > arr_tails;
+    
+    int implementationChoice;
+    string filename;
+    
+    cout << "Choose implementation:" << endl;
+    cout << "1. Linked List" << endl;
+    cout << "2. Array" << endl;
+    cout << "3. Snapshot (load a saved binary snapshot)" << endl;
+    cout << "Enter choice: ";
+    cin >> implementationChoice;
+    clearInputBuffer();
+    
+    if (implementationChoice < 1 || implementationChoice > 3) {
+        cout << "Invalid choice. Exiting program." << endl;
+        return 1;
+    }
+    
+    cout << (implementationChoice == 3 ? "Enter snapshot filename: " : "Enter data filename (CSV, JSON/NDJSON or archive): ");
+    getline(cin, filename);
+    
+    bool importSuccess = false;
+    if (implementationChoice == 1) {
+        importSuccess = importData(filename, ll_achList, ll_cardList, ll_upiList, ll_wireList);
+    } else if (implementationChoice == 2) {
+        importSuccess = importData(filename, arr_achList, arr_cardList, arr_upiList, arr_wireList);
+    } else {
+        importSuccess = loadSnapshot(filename, snapshot, snap_achList, snap_cardList, snap_upiList, snap_wireList);
+    }
+    
+    if (!importSuccess) {
+        return 1;
+    }
+    
+    int choice;
+    do {
+        cout << "\n=== MAIN MENU ===" << endl;
+        if (ll_queue.isRunning()) {
+            cout << liveStatusLine(ll_tails, ll_queue) << endl;
+        } else if (arr_queue.isRunning()) {
+            cout << liveStatusLine(arr_tails, arr_queue) << endl;
+        }
+        cout << "1. ACH Transactions" << endl;
+        cout << "2. Card Transactions" << endl;
+        cout << "3. UPI Transactions" << endl;
+        cout << "4. Wire Transfer Transactions" << endl;
+        cout << "5. Performance Comparison" << endl;
+        cout << "6. Save Snapshot" << endl;
+        cout << "7. Export Columnar Archive" << endl;
+        cout << "8. Query Columnar Archive" << endl;
+        cout << "9. JSON vs CSV Import Benchmark" << endl;
+        cout << "10. Live Tail Ingestion" << endl;
+        cout << "11. Ingest Queue Benchmark" << endl;
+        cout << "12. Concurrent Read Benchmark" << endl;
+        cout << "13. Memory Report" << endl;
+        cout << "14. Query Latency Histograms" << endl;
+        cout << "15. Group-By Aggregation" << endl;
+        cout << "16. Time Windows" << endl;
+        cout << "17. Quantiles" << endl;
+        cout << "18. Distinct Counts" << endl;
+        cout << "19. Account History" << endl;
+        cout << "20. Transaction Graph" << endl;
+        cout << "21. Fraud Rules" << endl;
+        cout << "22. Top-K Transactions" << endl;
+        cout << "23. Exit" << endl;
+        cout << "Enter choice: ";
+        cin >> choice;
+        clearInputBuffer();
+
+        switch (choice) {
+            case 1:
+                if (implementationChoice == 1) {
+                    channelMenu(ll_achList, "ACH", "Linked List", &storeMutex);
+                } else if (implementationChoice == 2) {
+                    channelMenu(arr_achList, "ACH", "Array", &storeMutex);
+                } else {
+                    channelMenu(snap_achList, "ACH", "Snapshot");
+                }
+                break;
+            case 2:
+                if (implementationChoice == 1) {
+                    channelMenu(ll_cardList, "Card", "Linked List", &storeMutex);
+                } else if (implementationChoice == 2) {
+                    channelMenu(arr_cardList, "Card", "Array", &storeMutex);
+                } else {
+                    channelMenu(snap_cardList, "Card", "Snapshot");
+                }
+                break;
+            case 3:
+                if (implementationChoice == 1) {
+                    channelMenu(ll_upiList, "UPI", "Linked List", &storeMutex);
+                } else if (implementationChoice == 2) {
+                    channelMenu(arr_upiList, "UPI", "Array", &storeMutex);
+                } else {
+                    channelMenu(snap_upiList, "UPI", "Snapshot");
+                }
+                break;
+            case 4:
+                if (implementationChoice == 1) {
+                    channelMenu(ll_wireList, "Wire Transfer", "Linked List", &storeMutex);
+                } else if (implementationChoice == 2) {
+                    channelMenu(arr_wireList, "Wire Transfer", "Array", &storeMutex);
+                } else {
+                    channelMenu(snap_wireList, "Wire Transfer", "Snapshot");
+                }
+                break;
+            case 5: {
+                string dataFile = filename;
+                if (implementationChoice == 3) {
+                    cout << "Enter data filename to benchmark (CSV, JSON/NDJSON or archive): ";
+                    getline(cin, dataFile);
+                }
+                string repsText;
+                cout << "Enter timed repetitions per operation (default 5): ";
+                getline(cin, repsText);
+                int repetitions = repsText.empty() ? 5 : atoi(repsText.c_str());
+                if (repetitions <= 0) {
+                    cout << "Invalid repetition count." << endl;
+                    break;
+                }
+                compareEfficiency(dataFile, repetitions);
+                break;
+            }
+            case 6: {
+                string snapshotName;
+                cout << "Enter snapshot filename (e.g., transactions.snap): ";
+                getline(cin, snapshotName);
+                if (implementationChoice == 1) {
+                    saveSnapshot(snapshotName, ll_achList, ll_cardList, ll_upiList, ll_wireList);
+                } else if (implementationChoice == 2) {
+                    saveSnapshot(snapshotName, arr_achList, arr_cardList, arr_upiList, arr_wireList);
+                } else if (snapshotName == filename) {
+                    cout << "Cannot overwrite the snapshot that is currently loaded." << endl;
+                } else {
+                    saveSnapshot(snapshotName, snap_achList, snap_cardList, snap_upiList, snap_wireList);
+                }
+                break;
+            }
+            case 7: {
+                string archiveName;
+                cout << "Enter archive filename (e.g., transactions.tdc): ";
+                getline(cin, archiveName);
+                if (implementationChoice == 1) {
+                    exportColumnar(archiveName, ll_achList, ll_cardList, ll_upiList, ll_wireList);
+                } else if (implementationChoice == 2) {
+                    exportColumnar(archiveName, arr_achList, arr_cardList, arr_upiList, arr_wireList);
+                } else {
+                    exportColumnar(archiveName, snap_achList, snap_cardList, snap_upiList, snap_wireList);
+                }
+                break;
+            }
+            case 8:
+                queryColumnarMenu();
+                break;
+            case 9: {
+                string csvFile, jsonFile;
+                cout << "Enter CSV filename to benchmark: ";
+                getline(cin, csvFile);
+                cout << "Enter NDJSON filename to generate (e.g., transactions.ndjson): ";
+                getline(cin, jsonFile);
+                benchmarkJSONImport(csvFile, jsonFile);
+                break;
+            }
+            case 10:
+                if (implementationChoice == 1) {
+                    liveTailMenu(ll_tails, ll_queue, filename);
+                } else if (implementationChoice == 2) {
+                    liveTailMenu(arr_tails, arr_queue, filename);
+                } else {
+                    cout << "Live tail needs the Linked List or Array implementation (snapshots are read-only)." << endl;
+                }
+                break;
+            case 11: {
+                string countText;
+                cout << "Enter number of records per run (e.g., 200000): ";
+                getline(cin, countText);
+                int records = countText.empty() ? 200000 : atoi(countText.c_str());
+                if (records <= 0) {
+                    cout << "Invalid record count." << endl;
+                    break;
+                }
+                benchmarkIngestQueue(records);
+                break;
+            }
+            case 12: {
+                string countText;
+                cout << "Enter number of records per run (e.g., 200000): ";
+                getline(cin, countText);
+                int records = countText.empty() ? 200000 : atoi(countText.c_str());
+                if (records <= 0) {
+                    cout << "Invalid record count." << endl;
+                    break;
+                }
+                benchmarkConcurrentReads(records);
+                break;
+            }
+            case 13:
+                if (implementationChoice == 1) {
+                    printMemoryReport(ll_achList, ll_cardList, ll_upiList, ll_wireList, "Linked List");
+                } else if (implementationChoice == 2) {
+                    printMemoryReport(arr_achList, arr_cardList, arr_upiList, arr_wireList, "Array");
+                } else {
+                    printMemoryReport(snap_achList, snap_cardList, snap_upiList, snap_wireList, "Snapshot");
+                }
+                break;
+            case 14: {
+                latencyRegistry().print();
+                string answer;
+                cout << "Reset the histograms? (y/n): ";
+                getline(cin, answer);
+                if (!answer.empty() && (answer[0] == 'y' || answer[0] == 'Y')) {
+                    latencyRegistry().reset();
+                    cout << "Successfully reset query latency histograms." << endl;
+                }
+                break;
+            }
+            case 15:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    groupByMenu(lists);
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    groupByMenu(lists);
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    groupByMenu(lists);
+                }
+                break;
+            case 16:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    timeWindowMenu(lists);
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    timeWindowMenu(lists);
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    timeWindowMenu(lists);
+                }
+                break;
+            case 17:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    quantileMenu(lists);
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    quantileMenu(lists);
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    quantileMenu(lists);
+                }
+                break;
+            case 18:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    distinctCountMenu(lists);
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    distinctCountMenu(lists);
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    distinctCountMenu(lists);
+                }
+                break;
+            case 19:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    accountHistoryMenu(lists, "Linked List");
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    accountHistoryMenu(lists, "Array");
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    accountHistoryMenu(lists, "Snapshot");
+                }
+                break;
+            case 20:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    transactionGraphMenu(lists, "Linked List");
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    transactionGraphMenu(lists, "Array");
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    transactionGraphMenu(lists, "Snapshot");
+                }
+                break;
+            case 21:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    fraudRuleMenu(lists, &storeMutex);
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    fraudRuleMenu(lists, &storeMutex);
+                } else {
+                    cout << "Fraud rules need the Linked List or Array implementation (snapshots are read-only)." << endl;
+                }
+                break;
+            case 22:
+                if (implementationChoice == 1) {
+                    TransactionList* lists[4] = {&ll_achList, &ll_cardList, &ll_upiList, &ll_wireList};
+                    topKMenu(lists, "Linked List");
+                } else if (implementationChoice == 2) {
+                    ArrayTransactionList* lists[4] = {&arr_achList, &arr_cardList, &arr_upiList, &arr_wireList};
+                    topKMenu(lists, "Array");
+                } else {
+                    SnapshotTransactionList* lists[4] = {&snap_achList, &snap_cardList, &snap_upiList, &snap_wireList};
+                    topKMenu(lists, "Snapshot");
+                }
+                break;
+            case 23:
+                cout << "Exiting program." << endl;
+                break;
+            default:
+                cout << "Invalid choice." << endl;
+                break;
+        }
+    } while (choice != 23);
+
+    return 0;
+}
+#endif
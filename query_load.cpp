@@ -0,0 +1,274 @@
+// Load generator for the query server
+//
+// Opens a number of connections to a server started with
+// "project3 --input FILE --serve SOCKET|PORT" and keeps each one busy with
+// requests for a fixed time (closed loop: a connection sends its next
+// request as soon as a response arrives, with up to --pipeline requests
+// in flight). Reports throughput and the latency distribution as seen by
+// the client.
+//
+// Build: g++ -std=c++11 -O2 -pthread -o query_load query_load.cpp
+// Usage: ./query_load --socket /tmp/tdms.sock --connections 16 --duration 10
+//            --query "count" --query "filter location=Tokyo limit=5"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <iomanip>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct LoadOptions {
+    string socketPath;
+    int port;
+    int connections;
+    double duration;
+    double warmup;
+    int pipeline;
+    vector<string> queries;
+
+    LoadOptions() : port(0), connections(8), duration(10), warmup(1), pipeline(1) {}
+};
+
+struct ConnectionStats {
+    vector<double> latencies;   // microseconds, measured requests only
+    long errors;
+    long failedResponses;       // {"ok":false,...}
+    long bytes;
+    bool connected;
+    int connectError;
+
+    ConnectionStats() : errors(0), failedResponses(0), bytes(0), connected(false), connectError(0) {}
+};
+
+void printUsage() {
+    cout << "Usage: query_load (--socket PATH | --port N) [options]\n"
+         << "  --connections N   concurrent connections, one thread each (default 8)\n"
+         << "  --duration S      measured seconds (default 10)\n"
+         << "  --warmup S        unmeasured seconds before that (default 1)\n"
+         << "  --pipeline N      requests in flight per connection (default 1)\n"
+         << "  --query TEXT      request line; repeat to cycle through several (default \"count\")\n";
+}
+
+int connectToServer(const LoadOptions& options) {
+    int fd;
+    if (!options.socketPath.empty()) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        if (options.socketPath.size() >= sizeof(addr.sun_path)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, options.socketPath.c_str(), options.socketPath.size());
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)options.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+void runConnection(const LoadOptions& options, int id, chrono::steady_clock::time_point measureFrom,
+                   chrono::steady_clock::time_point stopAt, ConnectionStats& stats) {
+    typedef chrono::steady_clock Clock;
+    int fd = connectToServer(options);
+    if (fd < 0) {
+        stats.errors++;
+        stats.connectError = errno;
+        return;
+    }
+    stats.connected = true;
+
+    size_t next = id % options.queries.size();   // stagger the query mix across connections
+    deque<Clock::time_point> inFlight;
+    string buffer;
+    char chunk[65536];
+    bool ok = true;
+
+    while (ok) {
+        Clock::time_point now = Clock::now();
+        while (now < stopAt && (int)inFlight.size() < options.pipeline) {
+            if (!sendAll(fd, options.queries[next] + "\n")) {
+                ok = false;
+                break;
+            }
+            next = (next + 1) % options.queries.size();
+            inFlight.push_back(Clock::now());
+        }
+        if (!ok || inFlight.empty()) {
+            break;
+        }
+
+        size_t newline;
+        while ((newline = buffer.find('\n')) == string::npos) {
+            ssize_t got = recv(fd, chunk, sizeof(chunk), 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) {
+                ok = false;
+                break;
+            }
+            buffer.append(chunk, got);
+        }
+        if (!ok) {
+            break;
+        }
+
+        Clock::time_point done = Clock::now();
+        Clock::time_point sentAt = inFlight.front();
+        inFlight.pop_front();
+        if (sentAt >= measureFrom) {
+            stats.latencies.push_back(chrono::duration<double, micro>(done - sentAt).count());
+            stats.bytes += newline + 1;
+            if (buffer.compare(0, 11, "{\"ok\":false") == 0) {
+                stats.failedResponses++;
+            }
+        }
+        buffer.erase(0, newline + 1);
+    }
+    if (!ok) {
+        stats.errors++;
+    }
+    close(fd);
+}
+
+inline double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[min(index, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            cout << "Missing value for " << arg << endl;
+            printUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (arg == "--socket") {
+            options.socketPath = value;
+        } else if (arg == "--port") {
+            options.port = atoi(value.c_str());
+        } else if (arg == "--connections") {
+            options.connections = atoi(value.c_str());
+        } else if (arg == "--duration") {
+            options.duration = atof(value.c_str());
+        } else if (arg == "--warmup") {
+            options.warmup = atof(value.c_str());
+        } else if (arg == "--pipeline") {
+            options.pipeline = atoi(value.c_str());
+        } else if (arg == "--query") {
+            options.queries.push_back(value);
+        } else {
+            cout << "Unknown option: " << arg << endl;
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.queries.empty()) {
+        options.queries.push_back("count");
+    }
+    if ((options.socketPath.empty() && (options.port <= 0 || options.port > 65535)) ||
+        options.connections <= 0 || options.duration <= 0 || options.warmup < 0 || options.pipeline <= 0) {
+        cout << "Invalid load options." << endl;
+        printUsage();
+        return 1;
+    }
+
+    cout << "Running " << options.connections << " connection(s) x pipeline " << options.pipeline << " for "
+         << options.duration << " s (+" << options.warmup << " s warm-up) against "
+         << (options.socketPath.empty() ? "127.0.0.1:" + to_string(options.port) : options.socketPath) << endl;
+
+    typedef chrono::steady_clock Clock;
+    Clock::time_point begin = Clock::now();
+    Clock::time_point measureFrom = begin + chrono::duration_cast<Clock::duration>(chrono::duration<double>(options.warmup));
+    Clock::time_point stopAt = measureFrom + chrono::duration_cast<Clock::duration>(chrono::duration<double>(options.duration));
+
+    vector<ConnectionStats> stats(options.connections);
+    vector<thread> threads;
+    for (int c = 0; c < options.connections; ++c) {
+        threads.emplace_back(runConnection, cref(options), c, measureFrom, stopAt, ref(stats[c]));
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    chrono::duration<double> measured = min(Clock::now(), stopAt) - measureFrom;
+
+    vector<double> latencies;
+    long errors = 0, failedResponses = 0, bytes = 0;
+    int connected = 0;
+    for (const ConnectionStats& s : stats) {
+        latencies.insert(latencies.end(), s.latencies.begin(), s.latencies.end());
+        errors += s.errors;
+        failedResponses += s.failedResponses;
+        bytes += s.bytes;
+        connected += s.connected;
+    }
+    if (connected == 0) {
+        cout << "Could not connect to the server: " << strerror(stats[0].connectError) << endl;
+        return 1;
+    }
+    sort(latencies.begin(), latencies.end());
+    double seconds = max(measured.count(), 1e-9);
+
+    cout << fixed << setprecision(1);
+    cout << "\nRequests:      " << latencies.size() << " (" << failedResponses << " error responses, "
+         << errors << " connection errors)" << endl;
+    cout << "Throughput:    " << latencies.size() / seconds << " requests/s, "
+         << bytes / seconds / (1024.0 * 1024.0) << " MB/s of responses" << endl;
+    cout << setprecision(3);
+    cout << "Latency (ms):  p50 " << percentile(latencies, 50) / 1000.0
+         << "  p90 " << percentile(latencies, 90) / 1000.0
+         << "  p99 " << percentile(latencies, 99) / 1000.0
+         << "  p99.9 " << percentile(latencies, 99.9) / 1000.0
+         << "  max " << (latencies.empty() ? 0.0 : latencies.back() / 1000.0) << endl;
+    return (errors > 0 || failedResponses > 0) ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+// Regression tests for results that can go wrong without crashing:
+// estimator accuracy, incremental indexes, graph searches and predicates
+//
+// Build: g++ -std=c++11 -O2 -pthread -o tdms_tests tests.cpp
+// Usage: ./tdms_tests
+// Prints one line per check and exits with 1 if any check failed.
+
+#define TDMS_NO_MAIN
+#include "project3.cpp"
+
+static int failures = 0;
+
+static void check(bool ok, const string& what) {
+    cout << (ok ? "PASS  " : "FAIL  ") << what << endl;
+    failures += !ok;
+}
+
+// Between 2.5m and 5m distinct values the classic estimator has already
+// left linear counting while the raw estimate is still biased upwards.
+// Averaged over 32 trials the bias must stay below 0.5%; the standard
+// error at precision 14 is 0.8%, so 32 trials leave 0.14% of noise.
+static void testHyperLogLogMidRange() {
+    const int precision = 14;
+    const double m = (double)(1 << precision);
+    const int trials = 32;
+    for (double multiple : {2.5, 3.0, 3.5, 4.0, 5.0}) {
+        long n = (long)(multiple * m);
+        double sumError = 0, worst = 0;
+        for (int trial = 0; trial < trials; ++trial) {
+            HyperLogLog sketch(precision);
+            for (long i = 0; i < n; ++i) {
+                string key = "T" + to_string(trial) + "-ACC" + to_string(i);
+                sketch.add(hashBytes(key.data(), key.size()));
+            }
+            double error = sketch.estimate() / n - 1;
+            sumError += error;
+            worst = max(worst, fabs(error));
+        }
+        ostringstream what;
+        what << fixed << setprecision(2) << "HyperLogLog p=14 at " << multiple << "m (" << n
+             << " values): mean error " << 100 * sumError / trials << "%, worst " << 100 * worst << "%";
+        check(fabs(sumError / trials) < 0.005 && worst < 0.04, what.str());
+    }
+}
+
+// Small and sparse sketches, and a merge of two halves
+static void testHyperLogLogSmall() {
+    HyperLogLog empty(12);
+    check(empty.estimate() == 0, "HyperLogLog of nothing is 0");
+
+    HyperLogLog few(12), left(12), right(12);
+    for (int i = 0; i < 1000; ++i) {
+        string key = "ACC" + to_string(i);
+        uint64_t hash = hashBytes(key.data(), key.size());
+        few.add(hash);
+        (i % 2 ? left : right).add(hash);
+    }
+    left.merge(right);
+    check(fabs(few.estimate() / 1000 - 1) < 0.05, "HyperLogLog p=12 of 1000 values within 5%");
+    check(left.estimate() == few.estimate(), "HyperLogLog merge of two halves equals the whole");
+}
+
+// Rows for the list backends: n transactions between a pool of accounts,
+// at times that repeat, with every 50th timestamp unparseable
+template <typename Record>
+static vector<Record*> makeRows(int n, int accounts, int firstId, int64_t firstTime, unsigned seed) {
+    vector<Record*> rows;
+    for (int i = 0; i < n; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        Record* t = new Record();
+        t->transaction_id = "T" + to_string(firstId + i);
+        t->timestamp = i % 50 == 49 ? "not a time" : formatTimestamp(firstTime + (seed >> 8) % 5000);
+        t->sender_account = "ACC" + to_string((seed >> 4) % accounts);
+        t->receiver_account = "ACC" + to_string((seed >> 12) % accounts);
+        t->amount = i;
+        rows.push_back(t);
+    }
+    return rows;
+}
+
+// An index extended with appended rows must equal one built from scratch
+template <typename List>
+static void testAccountIndexExtend(const string& backend) {
+    typedef typename List::Record Record;
+    List storage[4];
+    List* lists[4] = {&storage[0], &storage[1], &storage[2], &storage[3]};
+    for (int c = 0; c < 4; ++c) {
+        storage[c].addBatch(makeRows<Record>(500, 300, c * 10000, 1700000000, c + 1));
+    }
+    EpochGuard guard;
+    bool rebuilt;
+    accountIndex(lists, rebuilt);
+    for (int c = 0; c < 4; c += 2) {
+        // Earlier, equal and later times, and accounts the index has not seen
+        storage[c].addBatch(makeRows<Record>(200, 600, c * 10000 + 500, 1699998000, c + 7));
+    }
+    shared_ptr<const AccountIndex<List> > extended = accountIndex(lists, rebuilt);
+    AccountIndex<List> fresh;
+    fresh.build(lists);
+
+    bool same = extended->appendedCount() == 400 && extended->rowCount() == fresh.rowCount() &&
+                extended->accountCount() == fresh.accountCount() && extended->startTime() == fresh.startTime();
+    for (uint32_t a = 0; same && a < fresh.accountCount(); ++a) {
+        same = extended->name(a) == fresh.name(a);
+    }
+    for (uint32_t r = 0; same && r < fresh.rowCount(); ++r) {
+        same = extended->ref(r) == fresh.ref(r) && extended->channel(r) == fresh.channel(r) &&
+               extended->rowTime(r) == fresh.rowTime(r);
+    }
+    for (int role = 0; same && role < 2; ++role) {
+        same = extended->roleOffsets(role) == fresh.roleOffsets(role) &&
+               extended->rolePositions(role) == fresh.rolePositions(role);
+    }
+    check(same, backend + " account index extended with 400 rows equals a fresh build");
+}
+
+// A transaction between two accounts at a time given as seconds
+static ArrayTransaction* transfer(const string& from, const string& to, int64_t time) {
+    static int id = 0;
+    ArrayTransaction* t = new ArrayTransaction();
+    t->transaction_id = "G" + to_string(++id);
+    t->timestamp = formatTimestamp(time);
+    t->sender_account = from;
+    t->receiver_account = to;
+    t->amount = 100;
+    return t;
+}
+
+static uint32_t accountNumber(const AccountIndex<ArrayTransactionList>& index, const string& name) {
+    uint32_t number;
+    return index.locate(name, number) ? number : TransactionGraph<ArrayTransactionList>::NONE;
+}
+
+// With a gap, the earliest arrival at an account is not the only useful
+// one: S reaches A at 00:00:00 and again via X at 00:15:50, and only the
+// later arrival leaves time for A -> T at 00:16:40 within 100 seconds.
+static void testFlowWithGap() {
+    const int64_t midnight = 1700006400;
+    ArrayTransactionList storage[4];
+    ArrayTransactionList* lists[4] = {&storage[0], &storage[1], &storage[2], &storage[3]};
+    storage[0].addBatch({transfer("S", "A", midnight), transfer("S", "X", midnight + 900),
+                         transfer("X", "A", midnight + 950), transfer("A", "T", midnight + 1000)});
+    EpochGuard guard;
+    bool rebuilt;
+    shared_ptr<const TransactionGraph<ArrayTransactionList> > graph = transactionGraph(lists, rebuilt);
+    const AccountIndex<ArrayTransactionList>& index = graph->accounts();
+    vector<size_t> perHop;
+    size_t scanned;
+    unordered_map<uint32_t, uint32_t> previous;
+    bool reachedT = false;
+    uint32_t hopsToT = 0;
+    string path;
+    for (const auto& r : graph->expand(accountNumber(index, "S"), 3, true, 100, perHop, scanned, previous)) {
+        if (r.account == accountNumber(index, "T")) {
+            reachedT = true;
+            hopsToT = r.hops;
+            for (uint32_t e = r.edge; e != TransactionGraph<ArrayTransactionList>::NONE; e = previous[e]) {
+                path = string(index.name(graph->source(e))) + " " + path;
+            }
+        }
+    }
+    check(reachedT && hopsToT == 3, "flow from S with a 100 s gap reaches T in 3 hops through the later arrival at A");
+    check(path == "S X A ", "the path shown to T is S -> X -> A -> T, which keeps within the gap");
+
+    reachedT = false;
+    for (const auto& r : graph->expand(accountNumber(index, "S"), 3, true, 30, perHop, scanned, previous)) {
+        reachedT = reachedT || r.account == accountNumber(index, "T");
+    }
+    check(!reachedT, "flow from S with a 30 s gap does not reach T");
+}
+
+// The cycles kept are the earliest, whichever account the search reaches
+// first: A1 sorts before B1 and C1 but its round trip is the latest
+static void testEarliestCycles() {
+    ArrayTransactionList storage[4];
+    ArrayTransactionList* lists[4] = {&storage[0], &storage[1], &storage[2], &storage[3]};
+    storage[1].addBatch({transfer("A1", "A2", 1700090000), transfer("A2", "A1", 1700090060),
+                         transfer("B1", "B2", 1700000000), transfer("B2", "B1", 1700000060),
+                         transfer("C1", "C2", 1700050000), transfer("C2", "C1", 1700050060)});
+    EpochGuard guard;
+    bool rebuilt;
+    shared_ptr<const TransactionGraph<ArrayTransactionList> > graph = transactionGraph(lists, rebuilt);
+    vector<size_t> byLength;
+    vector<TransactionGraph<ArrayTransactionList>::Cycle> cycles;
+    graph->findCycles(TransactionGraph<ArrayTransactionList>::NONE, 4, 3600, 2, byLength, cycles);
+    bool earliest = byLength[2] == 3 && cycles.size() == 2 && graph->time(cycles[0][0]) == 1700000000 &&
+                    graph->time(cycles[1][0]) == 1700050000;
+    check(earliest, "the 2 cycles kept out of 3 are the earliest ones");
+}
+
+// Prefix and substring conditions resolved to value sets must select the
+// same rows as testing each row's value, and combine with other predicates
+static void testValueSetPredicates() {
+    const char* locations[] = {"New York", "New Delhi", "Newark", "Tokyo", "Toronto", "Dubai"};
+    const char* types[] = {"transfer", "purchase", "withdrawal"};
+    ArrayTransactionList storage[4];
+    ArrayTransactionList* lists[4] = {&storage[0], &storage[1], &storage[2], &storage[3]};
+    for (int c = 0; c < 4; ++c) {
+        vector<ArrayTransaction*> rows = makeRows<ArrayTransaction>(600, 100, c * 1000, 1700000000, c + 3);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            rows[i]->location = locations[(i * 7 + c) % 6];
+            rows[i]->transaction_type = types[(i * 5 + c) % 3];
+        }
+        storage[c].addBatch(rows);
+    }
+
+    QueryPredicate prefix, contains, type, amount;
+    string error;
+    check(!parseQueryPredicate("amount^=1", amount, error), "^= on a numeric field is rejected");
+    bool parsed = parseQueryPredicate("location^=New", prefix, error) &&
+                  parseQueryPredicate("location*=to", contains, error) &&
+                  parseQueryPredicate("type=transfer", type, error) && parseQueryPredicate("amount<300", amount, error);
+    check(parsed && prefix.op == Q_PREFIX && contains.op == Q_CONTAINS && prefix.text == "New",
+          "location^=New and location*=to parse as set predicates");
+
+    vector<QueryPredicate> direct = {prefix, type, amount};
+    vector<QueryPredicate> resolved = direct;
+    vector<QueryPredicate> substring = {contains};
+    resolveValueSets(lists, resolved);
+    resolveValueSets(lists, substring);
+    check(resolved[0].values && *resolved[0].values == vector<string>({"New Delhi", "New York", "Newark"}),
+          "location^=New resolves to New Delhi, New York and Newark");
+    check(substring[0].values && *substring[0].values == vector<string>({"Toronto"}),
+          "location*=to resolves to Toronto only");
+
+    EpochGuard guard;
+    long expected = 0, viaSet = 0, viaText = 0;
+    for (int c = 0; c < 4; ++c) {
+        storage[c].forEach([&](const ArrayTransaction& t) {
+            expected += t.location.compare(0, 3, "New") == 0 && t.transaction_type == "transfer" && t.amount < 300;
+            viaSet += matchesQuery(t, resolved);
+            viaText += matchesQuery(t, direct);
+        });
+    }
+    check(expected > 0 && viaSet == expected && viaText == expected,
+          "location^=New type=transfer amount<300 selects the same " + to_string(expected) +
+              " rows through the value set and through each row's value");
+}
+
+int main() {
+    testHyperLogLogSmall();
+    testHyperLogLogMidRange();
+    testAccountIndexExtend<TransactionList>("Linked list");
+    testAccountIndexExtend<ArrayTransactionList>("Array");
+    testFlowWithGap();
+    testEarliestCycles();
+    testValueSetPredicates();
+    cout << (failures ? to_string(failures) + " check(s) failed" : string("All checks passed")) << endl;
+    return failures ? 1 : 0;
+}